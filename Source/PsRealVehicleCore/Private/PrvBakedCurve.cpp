@@ -0,0 +1,54 @@
+// Copyright 2016 Pushkin Studio. All Rights Reserved.
+
+#include "PrvCore.h"
+
+#include "PrvBakedCurve.h"
+
+FPrvBakedCurve::FPrvBakedCurve()
+	: MinTime(0.f)
+	, MaxTime(0.f)
+	, InvSampleStep(0.f)
+	, MaxError(0.f)
+	, MaxErrorTime(0.f)
+{
+}
+
+void FPrvBakedCurve::Bake(float InMinTime, float InMaxTime, int32 NumSamples, TFunctionRef<float(float)> Evaluator)
+{
+	NumSamples = FMath::Max(2, NumSamples);
+
+	MinTime = InMinTime;
+	MaxTime = FMath::Max(InMinTime, InMaxTime);
+	MaxError = 0.f;
+	MaxErrorTime = MinTime;
+
+	// Degenerate range: curve is a constant
+	if (MaxTime - MinTime < SMALL_NUMBER)
+	{
+		Samples.SetNumUninitialized(1);
+		Samples[0] = Evaluator(MinTime);
+		InvSampleStep = 0.f;
+		return;
+	}
+
+	const float SampleStep = (MaxTime - MinTime) / (NumSamples - 1);
+	InvSampleStep = 1.f / SampleStep;
+
+	Samples.SetNumUninitialized(NumSamples);
+	for (int32 i = 0; i < NumSamples; ++i)
+	{
+		Samples[i] = Evaluator(MinTime + SampleStep * i);
+	}
+
+	// Linear interpolation error is the largest between samples
+	for (int32 i = 0; i < NumSamples - 1; ++i)
+	{
+		const float MidTime = MinTime + SampleStep * (i + 0.5f);
+		const float Error = FMath::Abs(Evaluator(MidTime) - Eval(MidTime));
+		if (Error > MaxError)
+		{
+			MaxError = Error;
+			MaxErrorTime = MidTime;
+		}
+	}
+}
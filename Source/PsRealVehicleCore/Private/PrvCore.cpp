@@ -0,0 +1,21 @@
+// Copyright 2016 Pushkin Studio. All Rights Reserved.
+
+#include "PrvCore.h"
+
+class FPsRealVehicleCore : public IPsRealVehicleCore
+{
+	/** IModuleInterface implementation */
+	virtual void StartupModule() override
+	{
+
+	}
+
+	virtual void ShutdownModule() override
+	{
+
+	}
+};
+
+IMPLEMENT_MODULE( FPsRealVehicleCore, PsRealVehicleCore )
+
+DEFINE_LOG_CATEGORY(LogPrvVehicleCore);
@@ -0,0 +1,245 @@
+// Copyright 2016 Pushkin Studio. All Rights Reserved.
+
+#include "PrvCore.h"
+
+#include "PrvTelemetry.h"
+
+#include "HAL/PlatformFilemanager.h"
+#include "HAL/RunnableThread.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+//////////////////////////////////////////////////////////////////////////
+// FPrvTelemetryWriter
+
+FPrvTelemetryWriter::FPrvTelemetryWriter()
+	: FileHandle(nullptr)
+	, Thread(nullptr)
+	, WakeEvent(nullptr)
+	, RingMask(0)
+	, WriteIndex(0)
+	, ReadIndex(0)
+	, bStopRequested(0)
+	, MaxRecords(0)
+	, NumWritten(0)
+	, NumDropped(0)
+{
+}
+
+FPrvTelemetryWriter::~FPrvTelemetryWriter()
+{
+	Close();
+}
+
+bool FPrvTelemetryWriter::Open(const FString& InFilename, int32 RingCapacity, int64 MaxFileSize)
+{
+	Close();
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	PlatformFile.CreateDirectoryTree(*FPaths::GetPath(InFilename));
+
+	FileHandle = PlatformFile.OpenWrite(*InFilename);
+	if (!FileHandle)
+	{
+		UE_LOG(LogPrvVehicleCore, Warning, TEXT("Can't open telemetry file %s"), *InFilename);
+		return false;
+	}
+
+	FPrvTelemetryHeader Header;
+	Header.RecordSize = sizeof(FPrvTelemetryRecord);
+	Header.MaxWheels = FPrvTelemetryRecord::MaxWheels;
+	FileHandle->Write(reinterpret_cast<const uint8*>(&Header), sizeof(Header));
+
+	Filename = InFilename;
+
+	const int32 Capacity = FMath::RoundUpToPowerOfTwo(FMath::Max(RingCapacity, 2));
+	Ring.SetNumUninitialized(Capacity);
+	RingMask = Capacity - 1;
+
+	WriteIndex = 0;
+	ReadIndex = 0;
+	bStopRequested = 0;
+	NumWritten = 0;
+	NumDropped = 0;
+	MaxRecords = (MaxFileSize > 0) ? FMath::Max<int64>(0, (MaxFileSize - (int64)sizeof(FPrvTelemetryHeader)) / (int64)sizeof(FPrvTelemetryRecord)) : MAX_int64;
+
+	WakeEvent = FPlatformProcess::GetSynchEventFromPool(false);
+	Thread = FRunnableThread::Create(this, TEXT("PrvTelemetryWriter"), 0, TPri_BelowNormal);
+
+	return Thread != nullptr;
+}
+
+void FPrvTelemetryWriter::Close()
+{
+	if (Thread)
+	{
+		// Run() flushes the rest of the ring before exit
+		Stop();
+		Thread->WaitForCompletion();
+		delete Thread;
+		Thread = nullptr;
+	}
+
+	if (WakeEvent)
+	{
+		FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+		WakeEvent = nullptr;
+	}
+
+	if (FileHandle)
+	{
+		delete FileHandle;
+		FileHandle = nullptr;
+
+		UE_LOG(LogPrvVehicleCore, Log, TEXT("Telemetry file %s closed: %lld records written, %d dropped"), *Filename, (long long)NumWritten, NumDropped);
+	}
+
+	Ring.Empty();
+}
+
+bool FPrvTelemetryWriter::Push(const FPrvTelemetryRecord& Record)
+{
+	const int32 CurrentWriteIndex = WriteIndex;
+	const int32 CurrentReadIndex = FPlatformAtomics::InterlockedAdd(&ReadIndex, 0);
+
+	if (!Thread || CurrentWriteIndex - CurrentReadIndex > RingMask)
+	{
+		FPlatformAtomics::InterlockedIncrement(&NumDropped);
+		return false;
+	}
+
+	Ring[CurrentWriteIndex & RingMask] = Record;
+
+	// Record is visible to writer thread before the index
+	FPlatformMisc::MemoryBarrier();
+	WriteIndex = CurrentWriteIndex + 1;
+
+	// Wake writer early when the ring is half full
+	if (CurrentWriteIndex - CurrentReadIndex == (RingMask >> 1))
+	{
+		WakeEvent->Trigger();
+	}
+
+	return true;
+}
+
+uint32 FPrvTelemetryWriter::Run()
+{
+	while (!FPlatformAtomics::InterlockedAdd(&bStopRequested, 0))
+	{
+		WakeEvent->Wait(100);
+		Flush();
+	}
+
+	Flush();
+	return 0;
+}
+
+void FPrvTelemetryWriter::Stop()
+{
+	FPlatformAtomics::InterlockedExchange(&bStopRequested, 1);
+
+	if (WakeEvent)
+	{
+		WakeEvent->Trigger();
+	}
+}
+
+void FPrvTelemetryWriter::Flush()
+{
+	const int32 CurrentWriteIndex = FPlatformAtomics::InterlockedAdd(&WriteIndex, 0);
+	FPlatformMisc::MemoryBarrier();
+
+	int32 CurrentReadIndex = ReadIndex;
+	while (CurrentReadIndex != CurrentWriteIndex)
+	{
+		// Contiguous part of the ring
+		const int32 Start = CurrentReadIndex & RingMask;
+		const int32 Count = FMath::Min(CurrentWriteIndex - CurrentReadIndex, Ring.Num() - Start);
+		const int64 WriteCount = FMath::Min<int64>(Count, MaxRecords - NumWritten);
+
+		if (WriteCount > 0)
+		{
+			FileHandle->Write(reinterpret_cast<const uint8*>(&Ring[Start]), WriteCount * sizeof(FPrvTelemetryRecord));
+			NumWritten += WriteCount;
+		}
+
+		if (WriteCount < Count)
+		{
+			FPlatformAtomics::InterlockedAdd(&NumDropped, Count - (int32)WriteCount);
+		}
+
+		CurrentReadIndex += Count;
+
+		// Slots are free for producer after they're written
+		FPlatformMisc::MemoryBarrier();
+		FPlatformAtomics::InterlockedExchange(&ReadIndex, CurrentReadIndex);
+	}
+
+	FileHandle->Flush();
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// FPrvTelemetryReader
+
+FPrvTelemetryReader::FPrvTelemetryReader()
+	: NumRecords(0)
+{
+}
+
+bool FPrvTelemetryReader::Open(const FString& Filename)
+{
+	Data.Reset();
+	NumRecords = 0;
+
+	if (!FFileHelper::LoadFileToArray(Data, *Filename))
+	{
+		return false;
+	}
+
+	if (Data.Num() < (int32)sizeof(FPrvTelemetryHeader))
+	{
+		UE_LOG(LogPrvVehicleCore, Warning, TEXT("Telemetry file %s has no header"), *Filename);
+		return false;
+	}
+
+	FPrvTelemetryHeader Header;
+	FMemory::Memcpy(&Header, Data.GetData(), sizeof(Header));
+
+	if (Header.Magic != FPrvTelemetryHeader::CurrentMagic || Header.Version != FPrvTelemetryHeader::CurrentVersion ||
+		Header.RecordSize != sizeof(FPrvTelemetryRecord) || Header.MaxWheels != FPrvTelemetryRecord::MaxWheels)
+	{
+		UE_LOG(LogPrvVehicleCore, Warning, TEXT("Telemetry file %s has incompatible format (version %u, record size %u)"), *Filename, Header.Version, Header.RecordSize);
+		Data.Reset();
+		return false;
+	}
+
+	NumRecords = (Data.Num() - sizeof(FPrvTelemetryHeader)) / sizeof(FPrvTelemetryRecord);
+	return true;
+}
+
+void FPrvTelemetryReader::GetVehicleRecords(uint32 VehicleId, TArray<const FPrvTelemetryRecord*>& OutRecords) const
+{
+	OutRecords.Reset();
+
+	for (int32 Index = 0; Index < NumRecords; ++Index)
+	{
+		const FPrvTelemetryRecord& Record = GetRecord(Index);
+		if (Record.VehicleId == VehicleId)
+		{
+			OutRecords.Add(&Record);
+		}
+	}
+}
+
+void FPrvTelemetryReader::GetVehicleIds(TArray<uint32>& OutVehicleIds) const
+{
+	OutVehicleIds.Reset();
+
+	for (int32 Index = 0; Index < NumRecords; ++Index)
+	{
+		OutVehicleIds.AddUnique(GetRecord(Index).VehicleId);
+	}
+}
@@ -0,0 +1,623 @@
+// Copyright 2016 Pushkin Studio. All Rights Reserved.
+
+#include "PrvCore.h"
+
+#include "PrvHeadlessVehicle.h"
+
+
+//////////////////////////////////////////////////////////////////////////
+// Math helpers
+
+FVector FPrvVehicleSimulation::ProjectVectorOnToVector(const FVector& V, const FVector& Target)
+{
+	if (Target.SizeSquared() > SMALL_NUMBER)
+	{
+		return V.ProjectOnTo(Target);
+	}
+
+	return FVector::ZeroVector;
+}
+
+FVector FPrvVehicleSimulation::ProjectVectorOnToPlane(const FVector& V, const FVector& PlaneNormal)
+{
+	return FVector::VectorPlaneProject(V, PlaneNormal);
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Suspension
+
+void FPrvSuspensionCoefficients::Build(const FPrvSuspensionSettings& Settings, float InStiffness, float InCompressionDamping, float InDecompressionDamping, float InMass)
+{
+	Mass = InMass;
+
+	Stiffness = InStiffness * Settings.StiffnessFactor;
+	CompressionDamping = InCompressionDamping * Settings.CompressionDampingFactor;
+	DecompressionDamping = InDecompressionDamping * Settings.DecompressionDampingFactor;
+
+	const float m = FMath::Max(InMass, KINDA_SMALL_NUMBER);
+	CompressionAdaptiveRate = CompressionDamping / (100.f * m);
+	DecompressionAdaptiveRate = DecompressionDamping / (100.f * m);
+
+	// Same values as CalculateSuspensionForce uses
+	const float k = Stiffness / 100.f;
+	CompressionDecay = CompressionDamping / (2.f * m);
+	CompressionFrequency = FMath::Sqrt(FMath::Max(1.f, FMath::Square(CompressionDecay) - (k / m)));
+	DecompressionDecay = DecompressionDamping / (2.f * m);
+	DecompressionFrequency = FMath::Sqrt(FMath::Max(1.f, FMath::Square(DecompressionDecay) - (k / m)));
+
+	DampingCorrectionFactor = Settings.DampingCorrectionFactor;
+
+	CompressionVelocityCorrection.SetNumUninitialized(NumDeltaTimeSamples + 1);
+	DecompressionVelocityCorrection.SetNumUninitialized(NumDeltaTimeSamples + 1);
+
+	for (int32 i = 0; i <= NumDeltaTimeSamples; ++i)
+	{
+		const float SampleDeltaTime = GetMaxTabulatedDeltaTime() * i / NumDeltaTimeSamples;
+		CompressionVelocityCorrection[i] = CalculateVelocityCorrection(CompressionDecay, CompressionFrequency, SampleDeltaTime);
+		DecompressionVelocityCorrection[i] = CalculateVelocityCorrection(DecompressionDecay, DecompressionFrequency, SampleDeltaTime);
+	}
+}
+
+float FPrvSuspensionCoefficients::GetVelocityCorrection(bool bCompression, float DeltaTime) const
+{
+	const TArray<float>& Table = bCompression ? CompressionVelocityCorrection : DecompressionVelocityCorrection;
+
+	if (Table.Num() == 0 || DeltaTime >= GetMaxTabulatedDeltaTime())
+	{
+		return bCompression ? CalculateVelocityCorrection(CompressionDecay, CompressionFrequency, DeltaTime) : CalculateVelocityCorrection(DecompressionDecay, DecompressionFrequency, DeltaTime);
+	}
+
+	const float SamplePosition = FMath::Max(0.f, DeltaTime) * NumDeltaTimeSamples / GetMaxTabulatedDeltaTime();
+	const int32 SampleIndex = FMath::Min(FMath::FloorToInt(SamplePosition), NumDeltaTimeSamples - 1);
+	return FMath::Lerp(Table[SampleIndex], Table[SampleIndex + 1], SamplePosition - SampleIndex);
+}
+
+float FPrvSuspensionCoefficients::CalculateVelocityCorrection(float Decay, float Frequency, float DeltaTime) const
+{
+	const float Phase = Frequency * DeltaTime;
+	if (Phase < SMALL_NUMBER)
+	{
+		return 1.f;
+	}
+
+	// Same as dL_new / dL_old of CalculateSuspensionForce
+	const float Kl = FMath::Exp(-Decay * DeltaTime) * (FMath::Exp(Phase) - FMath::Exp(-Phase)) / (2.f * Phase);
+	return FMath::Pow(Kl, DampingCorrectionFactor);
+}
+
+float FPrvVehicleSimulation::CalculateSuspensionForce(const FPrvSuspensionSettings& Settings, float Length, float Stiffness, float CompressionDamping, float DecompressionDamping,
+	float NewLength, float PreviousLength, float Mass, int32 ActiveWheelsNum, float DeltaTime)
+{
+	const float SpringCompressionRatio = FMath::Clamp((Length - NewLength) / Length, 0.f, 1.f);
+	const float TargetVelocity = 0.f;		// @todo Target velocity can be different for wheeled vehicles
+
+	// Original suspension velocity
+	const float DiscreteSuspensionVelocity = (NewLength - PreviousLength) / DeltaTime;
+
+	// Compression and decompression have different suspension quality
+	float SuspensionDamping = 0.f;
+	const float SuspensionStiffness = Stiffness * Settings.StiffnessFactor;
+
+	if (DiscreteSuspensionVelocity < 0)
+	{
+		SuspensionDamping = CompressionDamping * Settings.CompressionDampingFactor;
+	}
+	else
+	{
+		SuspensionDamping = DecompressionDamping * Settings.DecompressionDampingFactor;
+	}
+
+	// Check we should correct the damping
+	float SuspensionVelocity = DiscreteSuspensionVelocity;
+	if (Settings.bCustomDampingCorrection && FMath::Abs(Settings.DampingCorrectionFactor) > SMALL_NUMBER && FMath::Abs(DiscreteSuspensionVelocity) > SMALL_NUMBER)
+	{
+		// Suspension velocity damping (because it works not discrete for DeltaTime)
+		const float suspVel = DiscreteSuspensionVelocity / 100.f;
+		const float k = SuspensionStiffness / 100.f;
+		const float D = SuspensionDamping / 100.f;
+		const float m = Mass;								// VehicleMass
+		const float b = SuspensionDamping / (2.f * m);		// DampingCoefficient
+		const float a_lin = FMath::Square(b) - (k / m);
+		const float a = FMath::Sqrt(FMath::Max(1.f, a_lin));	// FrictionCoefficient
+		const float A = suspVel / (2.f * a);				// InitialDampingEffect
+		const float B = -A;
+		const float dL_old = suspVel * DeltaTime;
+		const float dL_new = FMath::Exp(-b * DeltaTime) * (A * FMath::Exp(a * DeltaTime) + B * FMath::Exp(-a * DeltaTime));
+		const float Kl = dL_new / dL_old;
+		SuspensionVelocity = suspVel * FMath::Pow(Kl, Settings.DampingCorrectionFactor);
+
+		if (Settings.bDebugDampingCorrection)
+		{
+			if (a_lin < 1.f)
+			{
+				UE_LOG(LogPrvVehicleCore, Error, TEXT("a_lin is too small: %f"), a_lin);
+			}
+
+			UE_LOG(LogPrvVehicleCore, Warning, TEXT("DeltaTime: %f, suspVel: %f, k: %f, m: %f, D: %f, a: %f, b: %f, k/m: %f, A: %f, dL_old: %f, dL_new: %f, suspVelCorrected: %f"),
+				DeltaTime, suspVel, k, m, D, a, b, (k / m), A, dL_old, dL_new, SuspensionVelocity);
+		}
+	}
+
+	// Adaptive damping correction
+	if (Settings.bAdaptiveDampingCorrection)
+	{
+		const float D = SuspensionDamping / 100.f;
+		const float m = Mass;								// VehicleMass
+
+		const float AdaptiveExp = (1 - FMath::Exp((-D) * ActiveWheelsNum / m * DeltaTime));
+		if (FMath::Abs(AdaptiveExp) > SMALL_NUMBER)
+		{
+			const float AdaptiveSuspensionDamping = AdaptiveExp * m / (ActiveWheelsNum * DeltaTime);
+
+			if (Settings.bDebugDampingCorrection)
+			{
+				UE_LOG(LogPrvVehicleCore, Warning, TEXT("SuspensionDamping: %f, AdaptiveSuspensionDamping: %f, ActiveWheelsNum: %d"),
+					SuspensionDamping, (AdaptiveSuspensionDamping * 100.f), ActiveWheelsNum);
+			}
+
+			SuspensionDamping = AdaptiveSuspensionDamping * 100.f;
+		}
+		else if (Settings.bDebugDampingCorrection)
+		{
+			UE_LOG(LogPrvVehicleCore, Warning, TEXT("SuspensionDamping: %f, AdaptiveExp: 0"), SuspensionDamping);
+		}
+	}
+
+	// Apply suspension force
+	float SuspensionForce = (TargetVelocity - SuspensionVelocity) * SuspensionDamping + SpringCompressionRatio * SuspensionStiffness;
+
+	if (SuspensionForce < 0.f)
+	{
+		if (Settings.bClampSuspensionForce)
+		{
+			SuspensionForce = 0.f;
+		}
+		else
+		{
+			UE_LOG(LogPrvVehicleCore, Warning, TEXT("Negative SuspensionForce = %f"), SuspensionForce);
+		}
+	}
+
+	return SuspensionForce;
+}
+
+float FPrvVehicleSimulation::CalculateSuspensionForce(const FPrvSuspensionSettings& Settings, const FPrvSuspensionCoefficients& Coefficients, float Length,
+	float NewLength, float PreviousLength, int32 ActiveWheelsNum, float DeltaTime)
+{
+	const float SpringCompressionRatio = FMath::Clamp((Length - NewLength) / Length, 0.f, 1.f);
+	const float TargetVelocity = 0.f;
+
+	// Original suspension velocity
+	const float DiscreteSuspensionVelocity = (NewLength - PreviousLength) / DeltaTime;
+	const bool bCompression = (DiscreteSuspensionVelocity < 0);
+
+	float SuspensionDamping = bCompression ? Coefficients.CompressionDamping : Coefficients.DecompressionDamping;
+
+	// Check we should correct the damping
+	float SuspensionVelocity = DiscreteSuspensionVelocity;
+	if (Settings.bCustomDampingCorrection && FMath::Abs(Settings.DampingCorrectionFactor) > SMALL_NUMBER && FMath::Abs(DiscreteSuspensionVelocity) > SMALL_NUMBER)
+	{
+		SuspensionVelocity = (DiscreteSuspensionVelocity / 100.f) * Coefficients.GetVelocityCorrection(bCompression, DeltaTime);
+	}
+
+	// Adaptive damping correction
+	if (Settings.bAdaptiveDampingCorrection)
+	{
+		const float AdaptiveRate = bCompression ? Coefficients.CompressionAdaptiveRate : Coefficients.DecompressionAdaptiveRate;
+		SuspensionDamping *= GetAdaptiveDampingScale(AdaptiveRate * ActiveWheelsNum * DeltaTime);
+	}
+
+	// Apply suspension force
+	float SuspensionForce = (TargetVelocity - SuspensionVelocity) * SuspensionDamping + SpringCompressionRatio * Coefficients.Stiffness;
+
+	if (SuspensionForce < 0.f)
+	{
+		if (Settings.bClampSuspensionForce)
+		{
+			SuspensionForce = 0.f;
+		}
+		else
+		{
+			UE_LOG(LogPrvVehicleCore, Warning, TEXT("Negative SuspensionForce = %f"), SuspensionForce);
+		}
+	}
+
+	return SuspensionForce;
+}
+
+float FPrvVehicleSimulation::GetAdaptiveDampingScale(float X)
+{
+	// Exponent is negligible after this point, so the scale is 1/x
+	static const float MaxTabulatedX = 16.f;
+	static const int32 NumSamples = 256;
+
+	struct FAdaptiveDampingTable
+	{
+		float Samples[NumSamples + 1];
+
+		FAdaptiveDampingTable()
+		{
+			Samples[0] = 1.f;
+			for (int32 i = 1; i <= NumSamples; ++i)
+			{
+				const float SampleX = MaxTabulatedX * i / NumSamples;
+				Samples[i] = (1.f - FMath::Exp(-SampleX)) / SampleX;
+			}
+		}
+	};
+
+	static const FAdaptiveDampingTable Table;
+
+	if (X <= 0.f)
+	{
+		return 1.f;
+	}
+	else if (X >= MaxTabulatedX)
+	{
+		return 1.f / X;
+	}
+
+	const float SamplePosition = X * NumSamples / MaxTabulatedX;
+	const int32 SampleIndex = FMath::Min(FMath::FloorToInt(SamplePosition), NumSamples - 1);
+	return FMath::Lerp(Table.Samples[SampleIndex], Table.Samples[SampleIndex + 1], SamplePosition - SampleIndex);
+}
+
+int32 FPrvVehicleSimulation::UpdateSuspension(const FPrvSuspensionSettings& Settings, const TArray<FPrvWheelSetup>& Wheels, TArray<FPrvWheelContact>& Contacts,
+	const FPrvFlatGroundQuery& Ground, FPrvSimpleRigidBody& Body, bool bIsWheeled, int32 ActiveWheelsNum, float DeltaTime)
+{
+	check(Wheels.Num() == Contacts.Num());
+
+	const FTransform BodyTransform = Body.GetTransform();
+	const float Mass = Body.GetMass();
+
+	int32 ActiveFrictionPoints = 0;
+
+	for (int32 WheelIndex = 0; WheelIndex < Wheels.Num(); ++WheelIndex)
+	{
+		const FPrvWheelSetup& Wheel = Wheels[WheelIndex];
+		FPrvWheelContact& Contact = Contacts[WheelIndex];
+
+		const FVector SuspUpVector = BodyTransform.TransformVectorNoScale(Wheel.Rotation.Quaternion().GetUpVector());
+		const FVector SuspWorldLocation = BodyTransform.TransformPosition(Wheel.Location);
+		const FVector SuspTraceEndLocation = SuspWorldLocation - SuspUpVector * (Wheel.Length + Wheel.MaxDrop);
+
+		FPrvGroundContact Hit;
+		if (Ground.TraceWheel(SuspWorldLocation, SuspTraceEndLocation, Wheel.CollisionRadius, Hit))
+		{
+			// Check that collision is under suspension
+			if (BodyTransform.InverseTransformPosition(Hit.ImpactPoint).Z >= Wheel.Location.Z)
+			{
+				// Force maximum compression
+				Hit.ImpactPoint = SuspWorldLocation;
+				Hit.ImpactNormal = SuspUpVector;
+				Hit.Distance = 0.f;
+			}
+
+			// Clamp suspension length because MaxDrop distance is for visuals only (non-effective compression)
+			const float NewSuspensionLength = FMath::Clamp(Hit.Distance, 0.f, Wheel.Length);
+
+			const float SuspensionForce = CalculateSuspensionForce(Settings, Wheel.Length, Wheel.Stiffness, Wheel.CompressionDamping, Wheel.DecompressionDamping,
+				NewSuspensionLength, Contact.PreviousLength, Mass, ActiveWheelsNum, DeltaTime);
+
+			const FVector SuspensionDirection = (bIsWheeled) ? Hit.ImpactNormal : SuspUpVector;
+
+			Contact.SuspensionForce = SuspensionForce * SuspensionDirection;
+			Contact.ImpactPoint = Hit.ImpactPoint;
+			Contact.ImpactNormal = Hit.ImpactNormal;
+			Contact.PreviousLength = NewSuspensionLength;
+			Contact.bTouchedGround = true;
+
+			ActiveFrictionPoints++;
+		}
+		else
+		{
+			// If there is no collision then suspension is relaxed
+			Contact.SuspensionForce = FVector::ZeroVector;
+			Contact.ImpactPoint = FVector::ZeroVector;
+			Contact.ImpactNormal = FVector::UpVector;
+			Contact.PreviousLength = Wheel.Length;
+			Contact.bTouchedGround = false;
+		}
+
+		if (!Contact.SuspensionForce.IsZero())
+		{
+			Body.AddForceAtLocation(Contact.SuspensionForce, SuspWorldLocation);
+		}
+	}
+
+	return ActiveFrictionPoints;
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Friction
+
+float FPrvVehicleSimulation::CalculateFrictionCoefficient(const FVector& DirectionVelocity, const FVector& ForwardVector, const FVector2D& FrictionEllipse)
+{
+	// dot(A,B)
+	const float DirectionDotProduct = FVector::DotProduct(DirectionVelocity.GetSafeNormal(), ForwardVector);
+
+	FVector2D MuVector;
+	// x = r1 * dot(A,B)
+	MuVector.X = FrictionEllipse.X * DirectionDotProduct;
+	// y = r2 * sqrt(1 - dot(A,B)^2 )
+	MuVector.Y = FrictionEllipse.Y * FMath::Sqrt(1.f - FMath::Square(DirectionDotProduct));
+
+	return MuVector.Size();
+}
+
+FPrvWheelFrictionResult FPrvVehicleSimulation::CalculateWheelFriction(const FPrvFrictionSettings& Settings, const FPrvFrictionBodyState& Body, FPrvTrackDrive& Track,
+	const FPrvWheelFrictionInput& Wheel, float DeltaTime)
+{
+	FPrvWheelFrictionResult Result;
+
+	const FVector BodyForwardVector = Body.Rotation.GetForwardVector();
+	const FVector BodyRightVector = Body.Rotation.GetRightVector();
+	const FVector BodyUpVector = Body.Rotation.GetUpVector();
+
+	/////////////////////////////////////////////////////////////////////////
+	// Drive force
+
+	// Calculate wheel load
+	Result.WheelLoad = ProjectVectorOnToVector(Wheel.SuspensionForce, Wheel.WheelCollisionNormal).Size();
+
+	// Calculate wheel velocity relative to track (with simple Kalman filter)
+	Result.WheelCollisionVelocity = (Wheel.WheelPointVelocity + Wheel.PreviousWheelCollisionVelocity) / 2.f;
+
+	// Apply linear friction
+	FVector WheelVelocity = FVector::ZeroVector - Result.WheelCollisionVelocity;
+
+	// Add driving force
+	if (Wheel.bDrivenWheel)
+	{
+		WheelVelocity += (Wheel.WheelDirection * Track.LinearSpeed);
+	}
+
+	Result.RelativeWheelVelocity = ProjectVectorOnToPlane(WheelVelocity, Wheel.WheelCollisionNormal);
+
+	// Get friction coefficients
+	const float MuStatic = CalculateFrictionCoefficient(Result.RelativeWheelVelocity, Wheel.WheelDirection, Settings.StaticFrictionCoefficientEllipse);
+	const float MuKinetic = CalculateFrictionCoefficient(Result.RelativeWheelVelocity, Wheel.WheelDirection, Settings.KineticFrictionCoefficientEllipse);
+
+	// Mass and friction forces
+	const float VehicleMass = Body.Mass;
+	const FVector FrictionXVector = ProjectVectorOnToPlane(BodyForwardVector, Wheel.WheelCollisionNormal).GetSafeNormal();
+	const FVector FrictionYVector = ProjectVectorOnToPlane(BodyRightVector, Wheel.WheelCollisionNormal).GetSafeNormal();
+
+	// Current wheel force contbution
+	FVector WheelBalancedForce = FVector::ZeroVector;
+	if (Body.ActiveFrictionPoints != 0)
+	{
+		const FVector GravityDirection = -FVector::UpVector;
+		const FVector GravityBasedFriction = ProjectVectorOnToPlane(GravityDirection * Body.GravityZ * VehicleMass / Body.ActiveFrictionPoints, BodyUpVector);
+		WheelBalancedForce = Result.RelativeWheelVelocity * VehicleMass / DeltaTime / Body.ActiveFrictionPoints + GravityBasedFriction;
+	}
+
+	// @temp For non-driving wheels X friction is disabled
+	const float LongitudeFrictionFactor = Wheel.bDrivenWheel ? 1.f : 0.f;
+
+	// Full friction forces
+	const FVector FullStaticFrictionForce =
+		ProjectVectorOnToVector(WheelBalancedForce, FrictionXVector) * Settings.StaticFrictionCoefficientEllipse.X * LongitudeFrictionFactor * FMath::Sign(Track.BrakeRatio) +
+		ProjectVectorOnToVector(WheelBalancedForce, FrictionYVector) * Settings.StaticFrictionCoefficientEllipse.Y;
+	const FVector FullKineticFrictionForce =
+		ProjectVectorOnToVector(WheelBalancedForce, FrictionXVector) * Settings.KineticFrictionCoefficientEllipse.X * LongitudeFrictionFactor +
+		ProjectVectorOnToVector(WheelBalancedForce, FrictionYVector) * Settings.KineticFrictionCoefficientEllipse.Y;
+
+	// Drive Force from transmission torque
+	FVector TransmissionDriveForce = ProjectVectorOnToPlane(Track.DriveForce, Wheel.WheelCollisionNormal);
+
+	if (Settings.bScaleForceToActiveFrictionPoints && Body.ActiveDrivenFrictionPoints != 0 && Body.NumWheels != 0)
+	{
+		const float Ratio = static_cast<float>(Body.NumWheels) / static_cast<float>(Body.ActiveDrivenFrictionPoints);
+		TransmissionDriveForce *= Ratio;
+	}
+
+	// Full drive forces
+	const FVector FullStaticDriveForce = TransmissionDriveForce * Settings.StaticFrictionCoefficientEllipse.X * LongitudeFrictionFactor;
+	const FVector FullKineticDriveForce = TransmissionDriveForce * Settings.KineticFrictionCoefficientEllipse.X * LongitudeFrictionFactor;
+
+	// Full forces
+	const FVector FullStaticForce = FullStaticDriveForce + FullStaticFrictionForce;
+	const FVector FullKineticForce = FullKineticDriveForce + FullKineticFrictionForce;
+
+	// We want to apply higher friction if forces are bellow static friction limit
+	Result.bUseKineticFriction = FullStaticDriveForce.Size() >= (Result.WheelLoad * MuStatic);
+	const FVector FullKineticFrictionNormalizedForce = Result.bUseKineticFriction ? FullKineticFrictionForce.GetSafeNormal() : FVector::ZeroVector;
+	Result.ApplicationForce = Result.bUseKineticFriction
+		? FullKineticForce.GetClampedToMaxSize(Result.WheelLoad * MuKinetic)
+		: FullStaticForce.GetClampedToMaxSize(Result.WheelLoad * MuStatic);
+
+	if (Result.bUseKineticFriction == false)
+	{
+		const float WorldPointForwardVectorSpeed = FVector::DotProduct(Wheel.WheelPointVelocity, BodyForwardVector);
+		const float CurrentAngularSpeed = WorldPointForwardVectorSpeed / Settings.SprocketRadius;
+		Track.MinimumWheelAngularSpeed = FMath::Min(Track.MinimumWheelAngularSpeed, CurrentAngularSpeed);
+		Track.AngularSpeed = Track.MinimumWheelAngularSpeed;
+	}
+
+	/////////////////////////////////////////////////////////////////////////
+	// Friction torque
+
+	// Friction should work agains real movement
+	float FrictionDirectionMultiplier = FMath::Sign(Track.AngularSpeed) * FMath::Sign(Track.TorqueTransfer) * ((Body.bReverseGear) ? (-1.f) : 1.f);
+	if (FMath::Abs(FrictionDirectionMultiplier) < SMALL_NUMBER) FrictionDirectionMultiplier = 1.f;
+
+	// How much of friction force would effect transmission
+	const FVector TransmissionFrictionForce = Result.bUseKineticFriction ? ProjectVectorOnToVector(Result.ApplicationForce, FullKineticFrictionNormalizedForce) * (-1.f) * (Settings.TrackMass + Settings.SprocketMass) / VehicleMass * FrictionDirectionMultiplier : FVector::ZeroVector;
+	const FVector WorldFrictionForce = Body.Rotation.UnrotateVector(TransmissionFrictionForce);
+	const float TrackKineticFrictionTorque = ProjectVectorOnToVector(WorldFrictionForce, FVector::ForwardVector).X * Settings.SprocketRadius;
+
+	Track.KineticFrictionTorque += (TrackKineticFrictionTorque * Settings.KineticFrictionTorqueCoefficient);
+
+	/////////////////////////////////////////////////////////////////////////
+	// Rolling friction torque
+
+	// @todo Make this a force instead of torque!
+	const float ReverseVelocitySign = (-1.f) * FMath::Sign(Track.LinearSpeed);
+	const float TrackRollingFrictionTorque = Result.WheelLoad * Settings.RollingFrictionCoefficient * ReverseVelocitySign +
+		Result.WheelLoad * FMath::Pow(Track.LinearSpeed, Settings.LinearSpeedPower) * Settings.RollingVelocityFactor * ReverseVelocitySign;
+
+	// Add torque to track
+	Track.RollingFrictionTorque += TrackRollingFrictionTorque;
+
+	return Result;
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Transmission
+
+float FPrvVehicleSimulation::ApplyBrake(float DeltaTime, float AngularVelocity, float BrakeRatio, float BrakeForce)
+{
+	const float BrakeVelocity = BrakeRatio * BrakeForce * DeltaTime;
+
+	if (FMath::Abs(AngularVelocity) > FMath::Abs(BrakeVelocity))
+	{
+		return (AngularVelocity - (BrakeVelocity * FMath::Sign(AngularVelocity)));
+	}
+
+	return 0.f;
+}
+
+float FPrvVehicleSimulation::CalculateEngineRPM(float GearRatio, float DifferentialRatio, float HullAngularSpeed, float MinEngineRPM, float MaxEngineRPM)
+{
+	const float EngineRPM = PrvOmegaToRPM((GearRatio * DifferentialRatio) * HullAngularSpeed);
+	return FMath::Clamp(EngineRPM, MinEngineRPM, MaxEngineRPM);
+}
+
+float FPrvVehicleSimulation::CalculateDriveTorque(float EngineTorque, float GearRatio, float DifferentialRatio, float TransmissionEfficiency, bool bReverseGear, float ExtraPowerRatio)
+{
+	float DriveTorque = EngineTorque * GearRatio * DifferentialRatio * TransmissionEfficiency;
+	DriveTorque *= (bReverseGear) ? -1.f : 1.f;
+	DriveTorque *= ExtraPowerRatio;
+
+	return DriveTorque;
+}
+
+int32 FPrvVehicleSimulation::ShiftGear(int32 CurrentGear, int32 NumGears, int32 NeutralGear, bool bShiftUp, float ThrottleInput, bool& bOutReverseGear)
+{
+	const int32 PrevGear = CurrentGear;
+	int32 NewGear = CurrentGear;
+
+	if (bShiftUp)
+	{
+		NewGear += 1;
+	}
+	else
+	{
+		NewGear -= 1;
+	}
+
+	NewGear = FMath::Clamp(NewGear, 0, NumGears - 1);
+
+	// Force gears limits on user input
+	if (FMath::IsNearlyZero(ThrottleInput) == false)
+	{
+		bOutReverseGear = (ThrottleInput < 0.f);
+
+		if (bOutReverseGear)
+		{
+			NewGear = FMath::Max(0, FMath::Min(NewGear, NeutralGear - 1));
+		}
+		else
+		{
+			NewGear = FMath::Max(NewGear, NeutralGear);
+		}
+	}
+	else
+	{
+		// Don't switch gear when we want to be neutral
+		if (PrevGear >= NeutralGear)
+		{
+			NewGear = FMath::Max(NewGear, NeutralGear);
+		}
+		else
+		{
+			NewGear = FMath::Min(NewGear, NeutralGear);
+		}
+
+		bOutReverseGear = (NewGear < NeutralGear);
+	}
+
+	return NewGear;
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Headless vehicle environment
+
+bool FPrvFlatGroundQuery::TraceWheel(const FVector& Start, const FVector& End, float Radius, FPrvGroundContact& OutContact) const
+{
+	const float StartHeight = Start.Z - Radius - Height;
+	const float EndHeight = End.Z - Radius - Height;
+
+	// Sweep doesn't reach the plane or moves away from it
+	if (EndHeight > 0.f || StartHeight < EndHeight)
+	{
+		return false;
+	}
+
+	const float Alpha = (StartHeight > 0.f) ? StartHeight / (StartHeight - EndHeight) : 0.f;
+	const FVector WheelCenter = FMath::Lerp(Start, End, Alpha);
+
+	OutContact.ImpactPoint = FVector(WheelCenter.X, WheelCenter.Y, Height);
+	OutContact.ImpactNormal = FVector::UpVector;
+	OutContact.Distance = (WheelCenter - Start).Size();
+
+	return true;
+}
+
+FPrvSimpleRigidBody::FPrvSimpleRigidBody()
+{
+	Transform = FTransform::Identity;
+	LinearVelocity = FVector::ZeroVector;
+	AngularVelocity = FVector::ZeroVector;
+
+	Mass = 30000.f;
+	Inertia = 30000.f * 10000.f;
+	GravityZ = -980.f;
+
+	AccumulatedForce = FVector::ZeroVector;
+	AccumulatedTorque = FVector::ZeroVector;
+}
+
+FTransform FPrvSimpleRigidBody::GetTransform() const
+{
+	return Transform;
+}
+
+float FPrvSimpleRigidBody::GetMass() const
+{
+	return Mass;
+}
+
+FVector FPrvSimpleRigidBody::GetLinearVelocityAtPoint(const FVector& Point) const
+{
+	return LinearVelocity + FVector::CrossProduct(AngularVelocity, Point - Transform.GetLocation());
+}
+
+void FPrvSimpleRigidBody::AddForceAtLocation(const FVector& Force, const FVector& Location)
+{
+	AccumulatedForce += Force;
+	AccumulatedTorque += FVector::CrossProduct(Location - Transform.GetLocation(), Force);
+}
+
+void FPrvSimpleRigidBody::Integrate(float DeltaTime)
+{
+	LinearVelocity += (AccumulatedForce / Mass + FVector(0.f, 0.f, GravityZ)) * DeltaTime;
+	AngularVelocity += AccumulatedTorque / Inertia * DeltaTime;
+
+	Transform.AddToTranslation(LinearVelocity * DeltaTime);
+
+	const float AngularSpeed = AngularVelocity.Size();
+	if (AngularSpeed > SMALL_NUMBER)
+	{
+		const FQuat DeltaRotation(AngularVelocity / AngularSpeed, AngularSpeed * DeltaTime);
+		Transform.SetRotation((DeltaRotation * Transform.GetRotation()).GetNormalized());
+	}
+
+	AccumulatedForce = FVector::ZeroVector;
+	AccumulatedTorque = FVector::ZeroVector;
+}
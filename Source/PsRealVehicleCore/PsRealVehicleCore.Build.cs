@@ -0,0 +1,25 @@
+// Copyright 2016 Pushkin Studio. All Rights Reserved.
+
+using System.IO;
+
+namespace UnrealBuildTool.Rules
+{
+	public class PsRealVehicleCore : ModuleRules
+	{
+		public PsRealVehicleCore(ReadOnlyTargetRules Target) : base(Target)
+		{
+			PrivateIncludePaths.AddRange(
+				new string[] {
+					"PsRealVehicleCore/Private",
+					// ... add other private include paths required here ...
+				});
+
+			// Vehicle model should stay engine-independent: no UObject, no physics engine
+			PublicDependencyModuleNames.AddRange(
+				new string[]
+				{
+					"Core"
+				});
+		}
+	}
+}
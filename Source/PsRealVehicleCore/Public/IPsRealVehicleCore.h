@@ -0,0 +1,38 @@
+// Copyright 2016 Pushkin Studio. All Rights Reserved.
+
+#pragma once
+
+#include "ModuleManager.h"
+
+
+/**
+ * The public interface to this module. Vehicle simulation math that doesn't depend
+ * on UObject or physics engine, so it can be used by headless tools and benchmarks.
+ */
+class IPsRealVehicleCore : public IModuleInterface
+{
+
+public:
+
+	/**
+	 * Singleton-like access to this module's interface.  This is just for convenience!
+	 * Beware of calling this during the shutdown phase, though.  Your module might have been unloaded already.
+	 *
+	 * @return Returns singleton instance, loading the module on demand if needed
+	 */
+	static inline IPsRealVehicleCore& Get()
+	{
+		return FModuleManager::LoadModuleChecked< IPsRealVehicleCore >( "PsRealVehicleCore" );
+	}
+
+	/**
+	 * Checks to see if this module is loaded and ready.  It is only valid to call Get() if IsAvailable() returns true.
+	 *
+	 * @return True if the module is loaded and ready to use
+	 */
+	static inline bool IsAvailable()
+	{
+		return FModuleManager::Get().IsModuleLoaded( "PsRealVehicleCore" );
+	}
+};
+
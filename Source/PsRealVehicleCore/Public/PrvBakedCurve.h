@@ -0,0 +1,62 @@
+// Copyright 2016 Pushkin Studio. All Rights Reserved.
+
+#pragma once
+
+#include "Runtime/Launch/Resources/Version.h"
+
+#if ENGINE_MINOR_VERSION >= 15
+#include "CoreMinimal.h"
+#else
+#include "Core.h"
+#endif
+
+/**
+ * Float curve sampled into uniform table: O(1) lookup with linear interpolation.
+ * Values outside of the baked time range are clamped (same as constant extrapolation).
+ */
+class PSREALVEHICLECORE_API FPrvBakedCurve
+{
+public:
+	FPrvBakedCurve();
+
+	/**
+	 * Sample source curve
+	 * @param NumSamples	Table resolution (at least 2)
+	 * @param Evaluator		Source curve evaluation, also used to measure baking error
+	 */
+	void Bake(float InMinTime, float InMaxTime, int32 NumSamples, TFunctionRef<float(float)> Evaluator);
+
+	/** Get curve value for the time */
+	FORCEINLINE float Eval(float Time) const
+	{
+		if (Samples.Num() < 2)
+		{
+			return Samples.Num() > 0 ? Samples[0] : 0.f;
+		}
+
+		const float SamplePosition = FMath::Clamp((Time - MinTime) * InvSampleStep, 0.f, static_cast<float>(Samples.Num() - 1));
+		const int32 SampleIndex = FMath::Min(FMath::TruncToInt(SamplePosition), Samples.Num() - 2);
+		return FMath::Lerp(Samples[SampleIndex], Samples[SampleIndex + 1], SamplePosition - SampleIndex);
+	}
+
+	bool IsValid() const { return Samples.Num() > 0; }
+	int32 GetNumSamples() const { return Samples.Num(); }
+	float GetMinTime() const { return MinTime; }
+	float GetMaxTime() const { return MaxTime; }
+
+	/** Maximum deviation from the source curve (measured between samples on bake) */
+	float GetMaxError() const { return MaxError; }
+
+	/** Time of the maximum deviation */
+	float GetMaxErrorTime() const { return MaxErrorTime; }
+
+protected:
+	TArray<float> Samples;
+
+	float MinTime;
+	float MaxTime;
+	float InvSampleStep;
+
+	float MaxError;
+	float MaxErrorTime;
+};
@@ -0,0 +1,79 @@
+// Copyright 2016 Pushkin Studio. All Rights Reserved.
+
+#pragma once
+
+#include "PrvVehicleSimulation.h"
+
+/** Ground contact found by wheel query */
+struct FPrvGroundContact
+{
+	FVector ImpactPoint;
+	FVector ImpactNormal;
+
+	/** Distance from the query start to the wheel center */
+	float Distance;
+
+	/** Defaults */
+	FPrvGroundContact()
+	{
+		ImpactPoint = FVector::ZeroVector;
+		ImpactNormal = FVector::UpVector;
+		Distance = 0.f;
+	}
+};
+
+
+//////////////////////////////////////////////////////////////////////////
+// Headless vehicle environment (benchmarks run the core math without world and physics engine)
+
+/**
+ * Infinite horizontal plane
+ */
+class PSREALVEHICLECORE_API FPrvFlatGroundQuery
+{
+public:
+	FPrvFlatGroundQuery(float InHeight = 0.f)
+		: Height(InHeight)
+	{
+	}
+
+	/** Sweep the wheel sphere (or line if Radius is zero) from Start to End */
+	bool TraceWheel(const FVector& Start, const FVector& End, float Radius, FPrvGroundContact& OutContact) const;
+
+	float Height;
+};
+
+/**
+ * Rigid body integrated with semi-implicit Euler (no rotation inertia tensor, good enough for benchmarks)
+ */
+class PSREALVEHICLECORE_API FPrvSimpleRigidBody
+{
+public:
+	FPrvSimpleRigidBody();
+
+	FTransform GetTransform() const;
+	float GetMass() const;
+	FVector GetLinearVelocityAtPoint(const FVector& Point) const;
+
+	void AddForceAtLocation(const FVector& Force, const FVector& Location);
+
+	/** Integrate accumulated forces and gravity */
+	void Integrate(float DeltaTime);
+
+	FTransform Transform;
+	FVector LinearVelocity;
+
+	/** [rad/s] */
+	FVector AngularVelocity;
+
+	float Mass;
+
+	/** Simplified inertia (same for all axes) */
+	float Inertia;
+
+	float GravityZ;
+
+protected:
+	FVector AccumulatedForce;
+	FVector AccumulatedTorque;
+};
@@ -0,0 +1,120 @@
+// Copyright 2016 Pushkin Studio. All Rights Reserved.
+
+#pragma once
+
+#include "Runtime/Launch/Resources/Version.h"
+
+#if ENGINE_MINOR_VERSION >= 15
+#include "CoreMinimal.h"
+#else
+#include "Core.h"
+#endif
+
+#include "Templates/IsTriviallyCopyConstructible.h"
+
+/**
+ * Sequence lock: one writer publishes the value, any number of readers copy it from any thread without locks.
+ * Reader retries while the value is being written, so T should be trivially copyable and small.
+ */
+template<typename T>
+class TPrvSeqLock
+{
+	static_assert(TIsTriviallyCopyConstructible<T>::Value, "TPrvSeqLock value should be trivially copyable");
+
+public:
+	TPrvSeqLock()
+		: Sequence(0)
+	{
+	}
+
+	/** Publish new value (single writer thread) */
+	void Write(const T& NewValue)
+	{
+		// Odd sequence marks the value as being written
+		FPlatformAtomics::InterlockedIncrement(&Sequence);
+
+		Value = NewValue;
+
+		FPlatformAtomics::InterlockedIncrement(&Sequence);
+	}
+
+	/**
+	 * Copy the last published value (any thread)
+	 * @return false if nothing was published yet
+	 */
+	bool Read(T& OutValue) const
+	{
+		for (;;)
+		{
+			const int32 StartSequence = FPlatformAtomics::InterlockedAdd(&Sequence, 0);
+			if (StartSequence & 1)
+			{
+				FPlatformProcess::Yield();
+				continue;
+			}
+
+			OutValue = Value;
+
+			// Value was overwritten while copied: try again
+			if (FPlatformAtomics::InterlockedAdd(&Sequence, 0) == StartSequence)
+			{
+				return StartSequence != 0;
+			}
+		}
+	}
+
+	/** Number of values published */
+	int32 GetNumPublished() const
+	{
+		return FPlatformAtomics::InterlockedAdd(&Sequence, 0) / 2;
+	}
+
+private:
+	mutable volatile int32 Sequence;
+	T Value;
+};
+
+/**
+ * Vehicle state published once per tick for worker thread consumers (animation, audio, AI)
+ */
+struct FPrvVehicleStateSnapshot
+{
+	enum { MaxWheels = 32 };
+
+	int32 NumWheels;
+
+	/** Wheel bone offset (suspension, bone and visual offsets) in component space */
+	FVector WheelOffset[MaxWheels];
+
+	/** [deg] */
+	float RotationAngle[MaxWheels];
+
+	/** [deg] */
+	float SteeringAngle[MaxWheels];
+
+	/** Wheel bone rotation should be animated */
+	bool bAnimateRotation[MaxWheels];
+
+	float EngineRPM;
+
+	/** [cm/s] */
+	float LeftTrackSpeed;
+	float RightTrackSpeed;
+
+	/** Game time the state was published for */
+	float Time;
+
+	/** Vehicle physics is sleeping, wheels don't move */
+	bool bSleeping;
+
+	/** Defaults */
+	FPrvVehicleStateSnapshot()
+	{
+		NumWheels = 0;
+		EngineRPM = 0.f;
+		LeftTrackSpeed = 0.f;
+		RightTrackSpeed = 0.f;
+		Time = 0.f;
+		bSleeping = false;
+	}
+};
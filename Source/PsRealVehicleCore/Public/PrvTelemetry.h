@@ -0,0 +1,196 @@
+// Copyright 2016 Pushkin Studio. All Rights Reserved.
+
+#pragma once
+
+#include "Runtime/Launch/Resources/Version.h"
+
+#if ENGINE_MINOR_VERSION >= 15
+#include "CoreMinimal.h"
+#else
+#include "Core.h"
+#endif
+
+#include "HAL/Runnable.h"
+
+class FRunnableThread;
+class IFileHandle;
+
+/** Session file header */
+struct FPrvTelemetryHeader
+{
+	enum { CurrentMagic = 0x54565250 /* PRVT */ };
+	enum { CurrentVersion = 1 };
+
+	uint32 Magic;
+	uint32 Version;
+
+	/** sizeof(FPrvTelemetryRecord) the file was written with */
+	uint32 RecordSize;
+
+	/** FPrvTelemetryRecord::MaxWheels the file was written with */
+	uint32 MaxWheels;
+
+	/** Defaults */
+	FPrvTelemetryHeader()
+	{
+		Magic = CurrentMagic;
+		Version = CurrentVersion;
+		RecordSize = 0;
+		MaxWheels = 0;
+	}
+};
+
+/**
+ * Fixed-layout vehicle state of one tick (written to file as is)
+ */
+struct FPrvTelemetryRecord
+{
+	enum { MaxWheels = 32 };
+
+	/** Vehicle the record belongs to (unique in the session) */
+	uint32 VehicleId;
+
+	/** Game frame counter */
+	uint32 Frame;
+
+	/** Game time [s] */
+	float Time;
+
+	float DeltaTime;
+
+	/** Raw player input */
+	float RawThrottleInput;
+	float RawSteeringInput;
+
+	/** Input as replicated to server (handbrake | steering | throttle) */
+	uint16 QuantizeInput;
+
+	uint8 bRawHandbrakeInput;
+
+	uint8 NumWheels;
+
+	int32 CurrentGear;
+
+	float EngineRPM;
+
+	/** [cm/s] */
+	float LeftTrackSpeed;
+	float RightTrackSpeed;
+
+	float LeftBrakeRatio;
+	float RightBrakeRatio;
+
+	/** Bit per wheel touching the ground */
+	uint32 WheelContactMask;
+
+	/** Current suspension length [cm] */
+	float WheelLength[MaxWheels];
+
+	/** Load on the wheel [N] */
+	float WheelLoad[MaxWheels];
+
+	/** Defaults */
+	FPrvTelemetryRecord()
+	{
+		FMemory::Memzero(this, sizeof(FPrvTelemetryRecord));
+	}
+
+	bool IsWheelInContact(int32 WheelIndex) const
+	{
+		return (WheelContactMask & (1u << WheelIndex)) != 0;
+	}
+};
+
+/**
+ * Appends telemetry records to session file on background thread.
+ * Game thread only copies the record into the ring buffer: records are dropped if the ring is full or file limit is reached.
+ */
+class PSREALVEHICLECORE_API FPrvTelemetryWriter : public FRunnable
+{
+public:
+	FPrvTelemetryWriter();
+	virtual ~FPrvTelemetryWriter();
+
+	/**
+	 * Create session file and start writer thread
+	 * @param RingCapacity		Records buffered between game and writer threads (rounded up to power of two)
+	 * @param MaxFileSize		File stops growing at this size [bytes] (0 - unlimited)
+	 */
+	bool Open(const FString& InFilename, int32 RingCapacity = 4096, int64 MaxFileSize = 0);
+
+	/** Write buffered records and stop writer thread */
+	void Close();
+
+	bool IsOpen() const { return Thread != nullptr; }
+
+	/** [producer thread] Queue the record, returns false if it was dropped */
+	bool Push(const FPrvTelemetryRecord& Record);
+
+	const FString& GetFilename() const { return Filename; }
+
+	/** Records written to file */
+	int64 GetNumWritten() const { return NumWritten; }
+
+	/** Records dropped because of full ring or file limit */
+	int32 GetNumDropped() const { return NumDropped; }
+
+	//~ Begin FRunnable Interface
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+	//~ End FRunnable Interface
+
+private:
+	/** [writer thread] Write all records queued so far */
+	void Flush();
+
+	FString Filename;
+	IFileHandle* FileHandle;
+	FRunnableThread* Thread;
+	FEvent* WakeEvent;
+
+	/** Single producer, single consumer ring */
+	TArray<FPrvTelemetryRecord> Ring;
+	int32 RingMask;
+
+	/** Next record to be pushed (owned by producer) */
+	volatile int32 WriteIndex;
+
+	/** Next record to be written (owned by writer thread) */
+	volatile int32 ReadIndex;
+
+	volatile int32 bStopRequested;
+
+	int64 MaxRecords;
+	int64 NumWritten;
+	volatile int32 NumDropped;
+};
+
+/**
+ * Reads session file written by FPrvTelemetryWriter (truncated last record of crashed session is ignored)
+ */
+class PSREALVEHICLECORE_API FPrvTelemetryReader
+{
+public:
+	FPrvTelemetryReader();
+
+	/** Load session file, returns false if file is missing or was written with different record layout */
+	bool Open(const FString& Filename);
+
+	int32 GetNumRecords() const { return NumRecords; }
+
+	const FPrvTelemetryRecord& GetRecord(int32 Index) const
+	{
+		check(Index >= 0 && Index < NumRecords);
+		return reinterpret_cast<const FPrvTelemetryRecord*>(Data.GetData() + sizeof(FPrvTelemetryHeader))[Index];
+	}
+
+	/** Collect records of one vehicle in time order */
+	void GetVehicleRecords(uint32 VehicleId, TArray<const FPrvTelemetryRecord*>& OutRecords) const;
+
+	/** Unique vehicle ids of the session */
+	void GetVehicleIds(TArray<uint32>& OutVehicleIds) const;
+
+private:
+	TArray<uint8> Data;
+	int32 NumRecords;
+};
@@ -0,0 +1,389 @@
+// Copyright 2016 Pushkin Studio. All Rights Reserved.
+
+#pragma once
+
+#include "Runtime/Launch/Resources/Version.h"
+
+#if ENGINE_MINOR_VERSION >= 15
+#include "CoreMinimal.h"
+#else
+#include "Core.h"
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+// Some helper functions for converting units
+
+// rad/s to rev per minute
+inline float PrvOmegaToRPM(float Omega)
+{
+	return Omega * 30.f / PI;
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Suspension
+
+/** Suspension tuning shared by all wheels of the vehicle */
+struct FPrvSuspensionSettings
+{
+	float StiffnessFactor;
+	float CompressionDampingFactor;
+	float DecompressionDampingFactor;
+
+	/** Correct suspension velocity for discrete DeltaTime */
+	bool bCustomDampingCorrection;
+	float DampingCorrectionFactor;
+
+	/** Scale damping by the number of active wheels */
+	bool bAdaptiveDampingCorrection;
+
+	/** Don't let suspension pull the vehicle down */
+	bool bClampSuspensionForce;
+
+	/** Log damping intermediate values */
+	bool bDebugDampingCorrection;
+
+	/** Defaults */
+	FPrvSuspensionSettings()
+	{
+		StiffnessFactor = 1.f;
+		CompressionDampingFactor = 1.f;
+		DecompressionDampingFactor = 1.f;
+
+		bCustomDampingCorrection = false;
+		DampingCorrectionFactor = 1.f;
+
+		bAdaptiveDampingCorrection = false;
+		bClampSuspensionForce = true;
+		bDebugDampingCorrection = false;
+	}
+};
+
+/**
+ * Suspension coefficients of the single wheel derived from its config and vehicle tuning.
+ * Discrete damping correction doesn't depend on suspension velocity, so it's tabulated over DeltaTime.
+ */
+struct PSREALVEHICLECORE_API FPrvSuspensionCoefficients
+{
+	/** Spring and damping values scaled by global factors */
+	float Stiffness;
+	float CompressionDamping;
+	float DecompressionDamping;
+
+	/** Damping / (100 * Mass), used by adaptive damping */
+	float CompressionAdaptiveRate;
+	float DecompressionAdaptiveRate;
+
+	/** Vehicle mass the coefficients were built for */
+	float Mass;
+
+	/** Defaults */
+	FPrvSuspensionCoefficients()
+	{
+		Stiffness = 0.f;
+		CompressionDamping = 0.f;
+		DecompressionDamping = 0.f;
+
+		CompressionAdaptiveRate = 0.f;
+		DecompressionAdaptiveRate = 0.f;
+
+		Mass = 0.f;
+
+		CompressionDecay = 0.f;
+		CompressionFrequency = 1.f;
+		DecompressionDecay = 0.f;
+		DecompressionFrequency = 1.f;
+		DampingCorrectionFactor = 0.f;
+	}
+
+	/** Precompute coefficients and damping correction tables */
+	void Build(const FPrvSuspensionSettings& Settings, float InStiffness, float InCompressionDamping, float InDecompressionDamping, float InMass);
+
+	/** Velocity scale of discrete damping correction for the DeltaTime */
+	float GetVelocityCorrection(bool bCompression, float DeltaTime) const;
+
+	/** Tabulated DeltaTime range, larger steps are calculated directly */
+	static const int32 NumDeltaTimeSamples = 64;
+	static float GetMaxTabulatedDeltaTime() { return 0.1f; }
+
+protected:
+	/** Velocity correction Kl^DampingCorrectionFactor, where Kl = exp(-b*dt) * sinh(a*dt) / (a*dt) */
+	float CalculateVelocityCorrection(float Decay, float Frequency, float DeltaTime) const;
+
+	/** Damping oscillator parameters (b and a) */
+	float CompressionDecay;
+	float CompressionFrequency;
+	float DecompressionDecay;
+	float DecompressionFrequency;
+
+	float DampingCorrectionFactor;
+
+	TArray<float> CompressionVelocityCorrection;
+	TArray<float> DecompressionVelocityCorrection;
+};
+
+/** Wheel geometry and spring config (in body space) */
+struct FPrvWheelSetup
+{
+	FVector Location;
+	FRotator Rotation;
+
+	float Length;
+	float MaxDrop;
+	float CollisionRadius;
+
+	float Stiffness;
+	float CompressionDamping;
+	float DecompressionDamping;
+
+	bool bDrivingWheel;
+
+	/** Defaults */
+	FPrvWheelSetup()
+	{
+		Location = FVector::ZeroVector;
+		Rotation = FRotator::ZeroRotator;
+
+		Length = 25.f;
+		MaxDrop = 10.f;
+		CollisionRadius = 36.f;
+
+		Stiffness = 4000000.f;				// [N/cm]
+		CompressionDamping = 4000000.f;		// [N/(cm/s)]
+		DecompressionDamping = 4000000.f;	// [N/(cm/s)]
+
+		bDrivingWheel = true;
+	}
+};
+
+/** Wheel suspension state used by headless simulation */
+struct FPrvWheelContact
+{
+	float PreviousLength;
+	FVector SuspensionForce;
+	FVector ImpactPoint;
+	FVector ImpactNormal;
+	bool bTouchedGround;
+
+	/** Defaults */
+	FPrvWheelContact()
+	{
+		PreviousLength = 0.f;
+		SuspensionForce = FVector::ZeroVector;
+		ImpactPoint = FVector::ZeroVector;
+		ImpactNormal = FVector::UpVector;
+		bTouchedGround = false;
+	}
+};
+
+
+//////////////////////////////////////////////////////////////////////////
+// Friction
+
+/** Friction tuning shared by all wheels of the vehicle */
+struct FPrvFrictionSettings
+{
+	FVector2D StaticFrictionCoefficientEllipse;
+	FVector2D KineticFrictionCoefficientEllipse;
+
+	float KineticFrictionTorqueCoefficient;
+	float RollingFrictionCoefficient;
+	float LinearSpeedPower;
+	float RollingVelocityCoefficientSquared;
+
+	/** RollingVelocityCoefficientSquared^2 (kept in sync by the owner) */
+	float RollingVelocityFactor;
+
+	float SprocketRadius;
+	float SprocketMass;
+	float TrackMass;
+
+	bool bScaleForceToActiveFrictionPoints;
+
+	/** Defaults */
+	FPrvFrictionSettings()
+	{
+		StaticFrictionCoefficientEllipse = FVector2D(1.f, 0.85f);
+		KineticFrictionCoefficientEllipse = FVector2D(0.5f, 0.75f);
+
+		KineticFrictionTorqueCoefficient = 1.f;
+		RollingFrictionCoefficient = 0.02f;
+		LinearSpeedPower = 1.f;
+		RollingVelocityCoefficientSquared = 0.000015f;
+		RollingVelocityFactor = FMath::Square(RollingVelocityCoefficientSquared);
+
+		SprocketRadius = 25.f;
+		SprocketMass = 65.f;
+		TrackMass = 600.f;
+
+		bScaleForceToActiveFrictionPoints = false;
+	}
+};
+
+/** Track (or wheels side for cars) state updated by friction of its wheels */
+struct FPrvTrackDrive
+{
+	float LinearSpeed;
+	float AngularSpeed;
+	float TorqueTransfer;
+	float BrakeRatio;
+	FVector DriveForce;
+
+	/** Accumulated by wheels */
+	float KineticFrictionTorque;
+	float RollingFrictionTorque;
+
+	/** Minimum angular speed of wheels with static friction */
+	float MinimumWheelAngularSpeed;
+
+	/** Defaults */
+	FPrvTrackDrive()
+	{
+		LinearSpeed = 0.f;
+		AngularSpeed = 0.f;
+		TorqueTransfer = 0.f;
+		BrakeRatio = 0.f;
+		DriveForce = FVector::ZeroVector;
+
+		KineticFrictionTorque = 0.f;
+		RollingFrictionTorque = 0.f;
+
+		MinimumWheelAngularSpeed = BIG_NUMBER;
+	}
+};
+
+/** Per-wheel friction input (all vectors are in world space) */
+struct FPrvWheelFrictionInput
+{
+	/** Wheel forward direction */
+	FVector WheelDirection;
+
+	FVector WheelCollisionNormal;
+	FVector WheelPointVelocity;
+	FVector PreviousWheelCollisionVelocity;
+	FVector SuspensionForce;
+
+	/** Driven wheel receives drive force and longitudinal friction */
+	bool bDrivenWheel;
+
+	/** Defaults */
+	FPrvWheelFrictionInput()
+	{
+		WheelDirection = FVector::ForwardVector;
+		WheelCollisionNormal = FVector::UpVector;
+		WheelPointVelocity = FVector::ZeroVector;
+		PreviousWheelCollisionVelocity = FVector::ZeroVector;
+		SuspensionForce = FVector::ZeroVector;
+		bDrivenWheel = true;
+	}
+};
+
+/** Vehicle body state required by friction */
+struct FPrvFrictionBodyState
+{
+	FQuat Rotation;
+	float Mass;
+	float GravityZ;
+
+	int32 NumWheels;
+	int32 ActiveFrictionPoints;
+	int32 ActiveDrivenFrictionPoints;
+
+	bool bReverseGear;
+
+	/** Defaults */
+	FPrvFrictionBodyState()
+	{
+		Rotation = FQuat::Identity;
+		Mass = 1.f;
+		GravityZ = -980.f;
+
+		NumWheels = 0;
+		ActiveFrictionPoints = 0;
+		ActiveDrivenFrictionPoints = 0;
+
+		bReverseGear = false;
+	}
+};
+
+/** Per-wheel friction result */
+struct FPrvWheelFrictionResult
+{
+	float WheelLoad;
+
+	/** Filtered wheel velocity (should be kept for the next tick) */
+	FVector WheelCollisionVelocity;
+
+	FVector RelativeWheelVelocity;
+
+	/** Force to be applied at collision location */
+	FVector ApplicationForce;
+
+	bool bUseKineticFriction;
+
+	/** Defaults */
+	FPrvWheelFrictionResult()
+	{
+		WheelLoad = 0.f;
+		WheelCollisionVelocity = FVector::ZeroVector;
+		RelativeWheelVelocity = FVector::ZeroVector;
+		ApplicationForce = FVector::ZeroVector;
+		bUseKineticFriction = false;
+	}
+};
+
+
+//////////////////////////////////////////////////////////////////////////
+// Simulation
+
+class FPrvFlatGroundQuery;
+class FPrvSimpleRigidBody;
+
+/**
+ * Vehicle model math that doesn't depend on UObject or physics engine
+ */
+struct PSREALVEHICLECORE_API FPrvVehicleSimulation
+{
+	/** Same as UKismetMathLibrary::ProjectVectorOnToVector */
+	static FVector ProjectVectorOnToVector(const FVector& V, const FVector& Target);
+
+	/** Same as UKismetMathLibrary::ProjectVectorOnToPlane */
+	static FVector ProjectVectorOnToPlane(const FVector& V, const FVector& PlaneNormal);
+
+	/** Spring and damper force magnitude for the new suspension length */
+	static float CalculateSuspensionForce(const FPrvSuspensionSettings& Settings, float Length, float Stiffness, float CompressionDamping, float DecompressionDamping,
+		float NewLength, float PreviousLength, float Mass, int32 ActiveWheelsNum, float DeltaTime);
+
+	/** Same as CalculateSuspensionForce, but uses precomputed wheel coefficients (debug logging is not supported) */
+	static float CalculateSuspensionForce(const FPrvSuspensionSettings& Settings, const FPrvSuspensionCoefficients& Coefficients, float Length,
+		float NewLength, float PreviousLength, int32 ActiveWheelsNum, float DeltaTime);
+
+	/** Adaptive damping scale (1 - exp(-x)) / x, tabulated */
+	static float GetAdaptiveDampingScale(float X);
+
+	/** Friction coefficient for the velocity direction from friction ellipse */
+	static float CalculateFrictionCoefficient(const FVector& DirectionVelocity, const FVector& ForwardVector, const FVector2D& FrictionEllipse);
+
+	/** Friction and drive forces of the single wheel, friction torques are accumulated by the track */
+	static FPrvWheelFrictionResult CalculateWheelFriction(const FPrvFrictionSettings& Settings, const FPrvFrictionBodyState& Body, FPrvTrackDrive& Track,
+		const FPrvWheelFrictionInput& Wheel, float DeltaTime);
+
+	/** Reduce angular velocity by brake */
+	static float ApplyBrake(float DeltaTime, float AngularVelocity, float BrakeRatio, float BrakeForce);
+
+	/** Engine rotation speed for the gear and hull speed */
+	static float CalculateEngineRPM(float GearRatio, float DifferentialRatio, float HullAngularSpeed, float MinEngineRPM, float MaxEngineRPM);
+
+	/** Torque transmitted to tracks by gearbox */
+	static float CalculateDriveTorque(float EngineTorque, float GearRatio, float DifferentialRatio, float TransmissionEfficiency, bool bReverseGear, float ExtraPowerRatio);
+
+	/** Next gear index for the shift request, respecting user input direction */
+	static int32 ShiftGear(int32 CurrentGear, int32 NumGears, int32 NeutralGear, bool bShiftUp, float ThrottleInput, bool& bOutReverseGear);
+
+	/**
+	 * Headless suspension step (PrvVehicle.BenchmarkFleet): query ground for every wheel, calculate and apply suspension forces
+	 * @return Number of wheels touching the ground
+	 */
+	static int32 UpdateSuspension(const FPrvSuspensionSettings& Settings, const TArray<FPrvWheelSetup>& Wheels, TArray<FPrvWheelContact>& Contacts,
+		const FPrvFlatGroundQuery& Ground, FPrvSimpleRigidBody& Body, bool bIsWheeled, int32 ActiveWheelsNum, float DeltaTime);
+};
@@ -12,6 +12,30 @@ struct FPrvWheelSimulator
 	FBoneReference			SuspReference;
 	FRotator				RotOffset;
 	FVector					LocOffset;
+
+	/** Rotation offset converted once on update */
+	FQuat					RotQuat;
+
+	/** Bones should be rotated by RotQuat */
+	bool					bApplyRotation;
+
+	/** Bones should be moved or rotated at all */
+	bool					bApplyOffset;
+};
+
+/** Wheel bones resolved for current required bones */
+struct FPrvWheelBoneIndices
+{
+	int32					SimulatorIndex;
+	FCompactPoseBoneIndex	WheelBoneIndex;
+	FCompactPoseBoneIndex	SuspBoneIndex;
+
+	FPrvWheelBoneIndices(int32 InSimulatorIndex, FCompactPoseBoneIndex InWheelBoneIndex, FCompactPoseBoneIndex InSuspBoneIndex)
+		: SimulatorIndex(InSimulatorIndex)
+		, WheelBoneIndex(InWheelBoneIndex)
+		, SuspBoneIndex(InSuspBoneIndex)
+	{
+	}
 };
 
 /**
@@ -28,6 +52,12 @@ struct PSREALVEHICLEPLUGIN_API FAnimNode_PrvWheelHandler : public FAnimNode_Skel
 
 	TArray<FPrvWheelSimulator> WheelSimulators;
 
+	/** Valid wheel bones sorted by compact pose index (parents first), rebuilt on required bones change */
+	TArray<FPrvWheelBoneIndices> WheelBones;
+
+	/** Offsets were applied from published state at least once */
+	bool bHasWheelState;
+
 	FAnimNode_PrvWheelHandler();
 
 	// FAnimNode_Base interface
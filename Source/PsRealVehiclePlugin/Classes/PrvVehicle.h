@@ -56,6 +56,11 @@ public:
 
 	//~ Begin AActor Interface
 	virtual void DisplayDebug(class UCanvas* Canvas, const FDebugDisplayInfo& DebugDisplay, float& YL, float& YPos) override;
+	virtual void PostNetReceivePhysicState() override;
 	//~ End Actor Interface
 
+	//~ Begin APawn Interface
+	virtual void Restart() override;
+	//~ End APawn Interface
+
 };
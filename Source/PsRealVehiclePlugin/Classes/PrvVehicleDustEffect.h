@@ -58,5 +58,37 @@ class UPrvVehicleDustEffect : public UDataAsset
 	{
 		DefaultFX = nullptr;
 		DefaultMinSpeed = 0.f;
+		bSurfaceTableDirty = true;
 	}
+
+	//~ Begin UObject Interface
+	virtual void PostLoad() override;
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+	//~ End UObject Interface
+
+protected:
+	/** Build per-surface lookup table from DustEffects */
+	void BuildSurfaceTable();
+
+#if WITH_EDITOR
+	/** Report duplicate and unreachable DustEffects entries */
+	void ValidateDustEffects() const;
+#endif
+
+	struct FSurfaceDust
+	{
+		float ActivationMinSpeed;
+		UParticleSystem* DustFX;
+	};
+
+	/** Reachable effects of all surfaces, each surface has its effects sorted by speed descending */
+	TArray<FSurfaceDust> SurfaceDust;
+
+	/** Effects of surface are [SurfaceDustStart[SurfaceType], SurfaceDustStart[SurfaceType + 1]) */
+	int32 SurfaceDustStart[SurfaceType_Max + 1];
+
+	/** Table should be rebuilt before lookup */
+	bool bSurfaceTableDirty;
 };
@@ -0,0 +1,135 @@
+// Copyright 2016 Pushkin Studio. All Rights Reserved.
+
+#pragma once
+
+#include "GameFramework/Info.h"
+
+#include "PrvTelemetry.h"
+
+#include "PrvVehicleFleetManager.generated.h"
+
+class UPrvVehicleMovementComponent;
+class UParticleSystem;
+class UParticleSystemComponent;
+
+/**
+ * World-level manager that ticks all registered vehicles in phases:
+ * suspension traces on game thread, pure-math dynamics in parallel, forces applied on game thread
+ */
+UCLASS(notplaceable, transient)
+class PSREALVEHICLEPLUGIN_API APrvVehicleFleetManager : public AInfo
+{
+	GENERATED_UCLASS_BODY()
+
+public:
+	/** Find or spawn fleet manager for the world */
+	static APrvVehicleFleetManager* Get(UWorld* World);
+
+	/** Vehicle is ticked by manager till it's unregistered */
+	void RegisterVehicle(UPrvVehicleMovementComponent* Vehicle);
+	void UnregisterVehicle(UPrvVehicleMovementComponent* Vehicle);
+
+	int32 GetNumVehicles() const { return Vehicles.Num(); }
+
+	/** Vehicle wheels LOD is assigned by manager till it's unregistered (clients only) */
+	void RegisterSignificance(UPrvVehicleMovementComponent* Vehicle);
+	void UnregisterSignificance(UPrvVehicleMovementComponent* Vehicle);
+
+	/** Whether suspension trace budget is set (PrvVehicle.SuspensionTraceBudget), checked when vehicle begins play */
+	static bool IsTraceBudgetEnabled();
+
+	/** Vehicle suspension traces are limited by global budget till it's unregistered */
+	void RegisterTraceBudget(UPrvVehicleMovementComponent* Vehicle);
+	void UnregisterTraceBudget(UPrvVehicleMovementComponent* Vehicle);
+
+	/** Take free wheel effect (the one with the same template if possible) or spawn new one, and attach it to the vehicle */
+	UParticleSystemComponent* AcquireWheelEffect(UParticleSystem* Template, USceneComponent* AttachParent, FName SocketName, const FVector& SocketOffset);
+
+	/** Deactivate wheel effect, it returns to pool when its particles are finished */
+	void ReleaseWheelEffect(UParticleSystemComponent* Effect);
+
+	/** Whether telemetry sampling is enabled (PrvVehicle.TelemetrySampleRate), checked when vehicle begins play */
+	static bool IsTelemetryEnabled();
+
+	/** Roll telemetry sampling for new vehicle and assign it session-unique id (0 if vehicle is not sampled) */
+	uint32 RegisterTelemetry();
+
+	/** Queue vehicle tick record to session telemetry file (opened on first record) */
+	void RecordTelemetry(const FPrvTelemetryRecord& Record);
+
+	//~ Begin AActor Interface
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void Tick(float DeltaSeconds) override;
+	//~ End AActor Interface
+
+protected:
+	/** Run tick phases for all vehicles */
+	void TickVehicles(float DeltaSeconds);
+
+	/** Rank simulated proxies by camera distance, screen size and visibility and assign wheels LOD by tier budgets */
+	void UpdateSignificance();
+
+	/**
+	 * Grant suspension traces of current frame: player-controlled vehicles first, then the closest to player views.
+	 * Trace cost is estimated from the previous frame (contact cache and landscape hits, interleaved trace frames)
+	 */
+	void UpdateTraceBudget();
+
+	/** Registered vehicles */
+	UPROPERTY(Transient)
+	TArray<UPrvVehicleMovementComponent*> Vehicles;
+
+	/** Vehicles (and their delta time) that have deferred step in current tick */
+	TArray<UPrvVehicleMovementComponent*> DeferredVehicles;
+	TArray<float> DeferredDeltaTimes;
+
+	/** Vehicles ranked by significance */
+	UPROPERTY(Transient)
+	TArray<UPrvVehicleMovementComponent*> SignificanceVehicles;
+
+	struct FRankedVehicle
+	{
+		UPrvVehicleMovementComponent* Vehicle;
+		float Distance;
+		float Significance;
+	};
+
+	/** Ranking scratch buffer */
+	TArray<FRankedVehicle> RankedVehicles;
+
+	/** Vehicles scheduled by suspension trace budget */
+	UPROPERTY(Transient)
+	TArray<UPrvVehicleMovementComponent*> BudgetVehicles;
+
+	struct FBudgetedVehicle
+	{
+		UPrvVehicleMovementComponent* Vehicle;
+		int32 TraceCost;
+		float Priority;
+	};
+
+	/** Trace budget scratch buffers */
+	TArray<FBudgetedVehicle> BudgetedVehicles;
+	TArray<FVector> BudgetViewLocations;
+
+	/** Create detached inactive wheel effect owned by manager */
+	UParticleSystemComponent* SpawnWheelEffect();
+
+	/** Released effect has finished its particles */
+	UFUNCTION()
+	void OnWheelEffectFinished(UParticleSystemComponent* Effect);
+
+	/** Wheel effects ready for reuse */
+	UPROPERTY(Transient)
+	TArray<UParticleSystemComponent*> FreeWheelEffects;
+
+	/** Session telemetry file writer */
+	TUniquePtr<FPrvTelemetryWriter> TelemetryWriter;
+
+	/** Telemetry file couldn't be opened, don't try again */
+	bool bTelemetryFailed;
+
+	/** Id given to the next sampled vehicle (object ids are reused after GC, so they can't identify vehicles in session) */
+	uint32 NextTelemetryVehicleId;
+};
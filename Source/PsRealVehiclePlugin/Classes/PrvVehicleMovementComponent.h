@@ -5,9 +5,30 @@
 #include "GameFramework/PawnMovementComponent.h"
 #include "Particles/ParticleSystemComponent.h"
 #include "Curves/CurveFloat.h"
+#include "WorldCollision.h"
+
+#include "PrvVehicleSimulation.h"
+#include "PrvBakedCurve.h"
+#include "PrvPublishedState.h"
 
 #include "PrvVehicleMovementComponent.generated.h"
 
+/** How wheels of simulated proxy are traced (ordered by significance) */
+UENUM(BlueprintType)
+enum class EPrvWheelLod : uint8
+{
+	/** Regular traces every frame */
+	Full,
+	/** Line traces every frame */
+	LineTrace,
+	/** Line traces every few frames, suspension is interpolated in between */
+	Interleaved,
+	/** No traces, wheels keep their last state */
+	Frozen,
+
+	MAX UMETA(Hidden)
+};
+
 USTRUCT(BlueprintType)
 struct FSuspensionInfo
 {
@@ -21,6 +42,10 @@ struct FSuspensionInfo
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = Suspension/*, meta = (EditCondition = "bInheritWheelBoneTransform")*/)
 	FName BoneName;
 
+	/** Suspension bone moved with the wheel (if not set, BoneName with "Wheel" replaced by "Suspension" is used) */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = Animation)
+	FName SuspensionBoneName;
+
 	/** Suspension location in Actor space */
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, meta = (EditCondition = "!bInheritWheelBoneTransform", DisplayName = "Suspension Location"))
 	FVector Location;
@@ -122,8 +147,15 @@ struct FSuspensionInfo
 		CompressionDamping = 4000000.f;		// [N/(cm/s)]
 		DecompressionDamping = 4000000.f;	// [N/(cm/s)]
 	}
+
+	/** Suspension bone moved with the wheel */
+	FName GetSuspensionBoneName() const
+	{
+		return SuspensionBoneName.IsNone() ? FName(*BoneName.ToString().Replace(TEXT("Wheel"), TEXT("Suspension"), ESearchCase::CaseSensitive)) : SuspensionBoneName;
+	}
 };
 
+/** Wheel state snapshot (simulation itself keeps it in FPrvWheelsState) */
 USTRUCT(BlueprintType)
 struct FSuspensionState
 {
@@ -288,8 +320,375 @@ struct FTrackInfo
 	}
 };
 
+/**
+ * Dynamic wheels state updated every tick, stored as structure of arrays.
+ * Wheel config is kept separately in SuspensionSetup (same indices).
+ * Use FSuspensionState via GetSuspensionData() to access it from Blueprints.
+ */
+struct FPrvWheelsState
+{
+	/** Current suspension rotation (steering wheels are changing yaw) */
+	TArray<FRotator> Rotation;
+
+	/** Effective suspension length on last tick */
+	TArray<float> PreviousLength;
+
+	/** Suspension length for visuals (including MaxDrop interval) */
+	TArray<float> VisualLength;
+
+	/** VisualLength before the last fixed step */
+	TArray<float> PreviousVisualLength;
+
+	/** VisualLength interpolated between fixed steps (used for rendering) */
+	TArray<float> RenderVisualLength;
+
+	/** Current wheel rotation angle (pitch) */
+	TArray<float> RotationAngle;
+
+	/** Current wheel steering angle (yaw) */
+	TArray<float> SteeringAngle;
+
+	/** Force that was generated by suspension compression */
+	TArray<FVector> SuspensionForce;
+
+	TArray<FVector> WheelCollisionLocation;
+	TArray<FVector> WheelCollisionNormal;
+	TArray<FVector> PreviousWheelCollisionVelocity;
+	TArray<float> WheelLoad;
+
+	/** Is wheel engaged into physics simulation */
+	TArray<bool> WheelTouchedGround;
+
+	TArray<TEnumAsByte<EPhysicalSurface>> SurfaceType;
+
+	/** Reset state for the given suspension config */
+	void Init(const TArray<FSuspensionInfo>& SuspensionSetup)
+	{
+		const int32 NumWheels = SuspensionSetup.Num();
+
+		Rotation.Reset(NumWheels);
+		PreviousLength.Reset(NumWheels);
+		for (const FSuspensionInfo& SuspInfo : SuspensionSetup)
+		{
+			Rotation.Add(SuspInfo.Rotation);
+			PreviousLength.Add(SuspInfo.Length);
+		}
+
+		VisualLength.Init(0.f, NumWheels);
+		PreviousVisualLength.Init(0.f, NumWheels);
+		RenderVisualLength.Init(0.f, NumWheels);
+		RotationAngle.Init(0.f, NumWheels);
+		SteeringAngle.Init(0.f, NumWheels);
+		SuspensionForce.Init(FVector::ZeroVector, NumWheels);
+		WheelCollisionLocation.Init(FVector::ZeroVector, NumWheels);
+		WheelCollisionNormal.Init(FVector::UpVector, NumWheels);
+		PreviousWheelCollisionVelocity.Init(FVector::ZeroVector, NumWheels);
+		WheelLoad.Init(0.f, NumWheels);
+		WheelTouchedGround.Init(false, NumWheels);
+		SurfaceType.Init(EPhysicalSurface::SurfaceType_Default, NumWheels);
+	}
+
+	int32 Num() const
+	{
+		return Rotation.Num();
+	}
+
+	bool IsValidIndex(int32 WheelIndex) const
+	{
+		return Rotation.IsValidIndex(WheelIndex);
+	}
+};
+
+/** Suspension trace requested asynchronously on previous tick */
+struct FSuspensionAsyncTrace
+{
+	/** Handle of the pending trace */
+	FTraceHandle Handle;
+
+	/** Trace was requested as a line trace */
+	bool bLineTrace;
+
+	/** Trace was requested as a multi sphere trace (cylindrical wheels) */
+	bool bMultiTrace;
+
+	/** Defaults */
+	FSuspensionAsyncTrace()
+	{
+		bLineTrace = false;
+		bMultiTrace = false;
+	}
+};
+
+
+/** Last traced wheel contact reused while the wheel stays close to it */
+struct FPrvWheelContactCache
+{
+	/** Trace result the contact plane is taken from */
+	FHitResult Hit;
+
+	/** Suspension location and direction the trace was made for */
+	FVector SuspWorldLocation;
+	FVector SuspUpVector;
+
+	/** World time of the trace */
+	float TraceTime;
+
+	/** Cached hit was made by line trace */
+	bool bLineTrace;
+
+	bool bValid;
+
+	/** Defaults */
+	FPrvWheelContactCache()
+	{
+		SuspWorldLocation = FVector::ZeroVector;
+		SuspUpVector = FVector::UpVector;
+		TraceTime = 0.f;
+		bLineTrace = false;
+		bValid = false;
+	}
+};
+
+
+/** Player inputs sent to server unreliably: each packet repeats a few previous inputs */
+USTRUCT()
+struct FPrvInputPacket
+{
+	GENERATED_USTRUCT_BODY()
+
+	/** Max number of inputs in one packet */
+	static const int32 MaxInputs = 4;
+
+	/** Number of input stream epochs (stream is restarted when vehicle is possessed) */
+	static const int32 MaxEpochs = 4;
+
+	/** Sequence number of the newest input */
+	uint16 Sequence;
+
+	/** Input stream epoch the sequence belongs to */
+	uint8 Epoch;
+
+	/** Number of inputs in the packet */
+	uint8 NumInputs;
+
+	/** Quantized inputs, newest first: Inputs[i] has sequence number (Sequence - i) */
+	uint16 Inputs[MaxInputs];
+
+	/** Defaults */
+	FPrvInputPacket()
+	{
+		Sequence = 0;
+		Epoch = 0;
+		NumInputs = 0;
+		FMemory::Memzero(Inputs);
+	}
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+
+	/** Payload size [bits] */
+	int32 GetNumBits() const
+	{
+		return 16 + 2 + 2 + 16 * NumInputs;
+	}
+};
+
+template<>
+#if ENGINE_MINOR_VERSION >= 16
+struct TStructOpsTypeTraits<FPrvInputPacket> : public TStructOpsTypeTraitsBase2<FPrvInputPacket>
+#else
+struct TStructOpsTypeTraits<FPrvInputPacket> : public TStructOpsTypeTraitsBase
+#endif
+{
+	enum
+	{
+		WithNetSerializer = true
+	};
+};
+
+
+/** Per-wheel visual state replicated to simulated proxies (bit-packed) */
+USTRUCT()
+struct FPrvReplicatedWheels
+{
+	GENERATED_USTRUCT_BODY()
+
+	/** Wheels count is serialized with 6 bits, the rest of wheels is not replicated */
+	static const int32 MaxWheels = 63;
+
+	/** Suspension visual length quantized to LengthBits over [0, Length + MaxDrop] */
+	UPROPERTY()
+	TArray<uint8> Lengths;
+
+	UPROPERTY()
+	TArray<bool> Grounded;
+
+	/** Surface type of grounded wheel */
+	UPROPERTY()
+	TArray<uint8> SurfaceTypes;
+
+	/** Bits per suspension length (1..8) */
+	UPROPERTY()
+	uint8 LengthBits;
+
+	/** Defaults */
+	FPrvReplicatedWheels()
+	{
+		LengthBits = 5;
+	}
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+#if ENGINE_MINOR_VERSION >= 16
+struct TStructOpsTypeTraits<FPrvReplicatedWheels> : public TStructOpsTypeTraitsBase2<FPrvReplicatedWheels>
+#else
+struct TStructOpsTypeTraits<FPrvReplicatedWheels> : public TStructOpsTypeTraitsBase
+#endif
+{
+	enum
+	{
+		WithNetSerializer = true
+	};
+};
+
+/** Authoritative vehicle state sent to the owning client with the last applied input */
+USTRUCT()
+struct FPrvServerState
+{
+	GENERATED_USTRUCT_BODY()
+
+	/** Sequence number of the last input applied by server */
+	UPROPERTY()
+	uint16 Sequence;
+
+	/** Time passed since the input was applied [sec] */
+	UPROPERTY()
+	float TimeSinceInput;
+
+	UPROPERTY()
+	FVector_NetQuantize100 Location;
+
+	UPROPERTY()
+	FQuat Rotation;
+
+	UPROPERTY()
+	FVector_NetQuantize100 LinearVelocity;
+
+	UPROPERTY()
+	FVector_NetQuantize100 AngularVelocity;
+
+	UPROPERTY()
+	float LeftTrackAngularSpeed;
+
+	UPROPERTY()
+	float RightTrackAngularSpeed;
+
+	/** Defaults */
+	FPrvServerState()
+	{
+		Sequence = 0;
+		TimeSinceInput = 0.f;
+		Location = FVector::ZeroVector;
+		Rotation = FQuat::Identity;
+		LinearVelocity = FVector::ZeroVector;
+		AngularVelocity = FVector::ZeroVector;
+		LeftTrackAngularSpeed = 0.f;
+		RightTrackAngularSpeed = 0.f;
+	}
+};
+
+/** Predicted client state recorded every frame */
+struct FPrvPredictionHistoryEntry
+{
+	/** Input the state was simulated with */
+	uint16 Sequence;
+
+	/** Time passed since the input was applied [sec] */
+	float TimeSinceInput;
+
+	FVector Location;
+	FQuat Rotation;
+	FVector LinearVelocity;
+	FVector AngularVelocity;
+	float LeftTrackAngularSpeed;
+	float RightTrackAngularSpeed;
+
+	/** Defaults */
+	FPrvPredictionHistoryEntry()
+	{
+		Sequence = 0;
+		TimeSinceInput = 0.f;
+		Location = FVector::ZeroVector;
+		Rotation = FQuat::Identity;
+		LinearVelocity = FVector::ZeroVector;
+		AngularVelocity = FVector::ZeroVector;
+		LeftTrackAngularSpeed = 0.f;
+		RightTrackAngularSpeed = 0.f;
+	}
+};
+
+
+/** Replicated body state of simulated proxy stamped with receive time */
+struct FPrvStateSnapshot
+{
+	float Time;
+	FVector Location;
+	FQuat Rotation;
+	FVector LinearVelocity;
+
+	/** [deg/s] */
+	FVector AngularVelocity;
+
+	/** Defaults */
+	FPrvStateSnapshot()
+	{
+		Time = 0.f;
+		Location = FVector::ZeroVector;
+		Rotation = FQuat::Identity;
+		LinearVelocity = FVector::ZeroVector;
+		AngularVelocity = FVector::ZeroVector;
+	}
+};
+
+
+/** Body modifications buffered while simulation runs off the game thread */
+struct FPrvBodyCommands
+{
+	struct FForceAtLocation
+	{
+		FVector Force;
+		FVector Location;
+	};
+
+	TArray<FForceAtLocation> Forces;
+	FVector Torque;
+
+	bool bSetLinearVelocity;
+	FVector LinearVelocity;
+
+	bool bSetAngularVelocity;
+	FVector AngularVelocity;
+
+	/** Defaults */
+	FPrvBodyCommands()
+	{
+		Reset();
+	}
+
+	void Reset()
+	{
+		Forces.Reset();
+		Torque = FVector::ZeroVector;
+		bSetLinearVelocity = false;
+		LinearVelocity = FVector::ZeroVector;
+		bSetAngularVelocity = false;
+		AngularVelocity = FVector::ZeroVector;
+	}
+};
 
 struct FAnimNode_PrvWheelHandler;
+class APrvVehicleFleetManager;
 
 /**
  * Component that uses Torque and Force to move tracked vehicles
@@ -302,12 +701,22 @@ class PSREALVEHICLEPLUGIN_API UPrvVehicleMovementComponent : public UPawnMovemen
 	// Let direct access for animation nodes
 	friend FAnimNode_PrvWheelHandler;
 
+	// Fleet manager runs tick phases directly
+	friend APrvVehicleFleetManager;
+
 protected:
 	//////////////////////////////////////////////////////////////////////////
 	// Initialization
 	
 	virtual void InitializeComponent() override;
 	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction *ThisTickFunction) override;
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker) override;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
 
 
 	//////////////////////////////////////////////////////////////////////////
@@ -319,6 +728,15 @@ protected:
 	void InitGears();
 	void CalculateMOI();
 
+	/** Precompute tuning derived coefficients for simulation */
+	void InitSimulationCache();
+
+	/** Bake float curves into lookup tables (shared by vehicles with the same curves) */
+	void InitCurves();
+
+	/** Evaluate curve using baked table if it's available */
+	float EvalCurve(FRuntimeFloatCurve& Curve, const TSharedPtr<const FPrvBakedCurve>& BakedCurve, float Time);
+
 
 	//////////////////////////////////////////////////////////////////////////
 	// Physics simulation
@@ -343,8 +761,85 @@ protected:
 	/** Tick of anti-rollover system */
 	void UpdateAntiRollover(float DeltaTime);
 
+	/** Run forces pipeline once */
+	void UpdateSimulation(float DeltaTime);
+
+	/** Forces pipeline after suspension: pure math, can run off the game thread with deferred body commands */
+	void UpdateDynamics(float DeltaTime);
+
+	/** Run forces pipeline with fixed substeps */
+	void UpdateFixedTimestep(float DeltaTime);
+
+	/** Blend visual wheels state between two last fixed steps */
+	void UpdateRenderWheelsState(float Alpha);
+
+	/** Apply force to the body considering current step time */
+	void AddSimForceAtLocation(const FVector& Force, const FVector& Location);
+
+	/** Apply torque to the body considering current step time */
+	void AddSimTorque(const FVector& Torque);
+
+
+	//////////////////////////////////////////////////////////////////////////
+	// Body access (buffered while simulation is deferred)
+
+	FVector GetBodyLinearVelocity() const;
+	FVector GetBodyAngularVelocity() const;
+	void SetBodyLinearVelocity(const FVector& NewVelocity);
+	void SetBodyAngularVelocity(const FVector& NewVelocity);
+
+	/** Apply body modifications buffered by deferred simulation */
+	void ApplyBodyCommands();
+
+	/** Apply the last fixed step forces for the whole frame (frame is shorter than fixed step) */
+	void ApplyHeldStepForces();
+
+
+	//////////////////////////////////////////////////////////////////////////
+	// Tick phases (used by fleet manager)
+
+	/** [game thread] Prepare simulation step. @return true if the rest of the step should be done by SimulateDeferred */
+	bool PreSimulate(float DeltaTime, bool bAllowDeferred);
+
+	/** [any thread] Pure-math simulation stages, body modifications are buffered */
+	void SimulateDeferred(float DeltaTime);
+
+	/** [game thread] Apply buffered body modifications and update visuals */
+	void PostSimulate(float DeltaTime);
+
 	void UpdateSuspension(float DeltaTime);
 
+	/** Suspension update shared by physics and visuals-only paths (policies are defined in cpp) */
+	template <typename TPolicy, bool bIsWheeled>
+	void UpdateSuspensionKernel(float DeltaTime, bool bUseLineTrace);
+
+	/** Select the nearest blocking hit that lies inside the wheel cylinder */
+	bool SelectWheelHit(int32 WheelIndex, const TArray<FHitResult>& Hits, FHitResult& OutHit);
+
+	/** Request suspension trace to be processed asynchronously till the next tick */
+	void RequestAsyncSuspensionTrace(int32 WheelIndex, const FVector& SuspWorldLocation, const FVector& SuspTraceEndLocation, const FVector& RadiusUpVector, bool bUseLineTrace);
+
+	/** Get result of the trace requested on previous tick and reproject it into current suspension transform */
+	bool ConsumeAsyncSuspensionTrace(int32 WheelIndex, const FVector& SuspWorldLocation, const FVector& SuspUpVector, FHitResult& OutHit, bool& bOutHit, bool& bOutHitValid, bool& bOutLineTrace);
+
+	/** Collect landscape components under suspension, returns false if there is any other collision nearby */
+	bool UpdateLandscapeGround();
+
+	/** Local bounds of all wheels at max drop */
+	FBox GetSuspensionBounds() const;
+
+	/** Sample collected landscape heightfields directly (raycast if no heightfield data) and convert it to wheel contact */
+	bool SampleLandscapeGround(const FVector& SuspWorldLocation, const FVector& SuspUpVector, const FVector& SuspTraceEndLocation, float Radius, bool bUseLineTrace, FHitResult& OutHit) const;
+
+	/** Evaluate wheel contact against the cached plane if the wheel is still inside the cache envelope */
+	bool UseCachedWheelContact(int32 WheelIndex, const FVector& SuspWorldLocation, const FVector& SuspUpVector, const FVector& SuspTraceEndLocation, bool bUseLineTrace, FHitResult& OutHit, bool& bOutHit);
+
+	/** Collect movable collision around suspension that can cover cached contacts */
+	void UpdateContactCacheBlockers();
+
+	/** Remember the traced contact if it's made over static geometry */
+	void CacheWheelContact(int32 WheelIndex, const FVector& SuspWorldLocation, const FVector& SuspUpVector, bool bLineTrace, bool bHitValid, const FHitResult& Hit);
+
 	/** Trace just to put wheels on the ground, don't calculate physics (used for proxy actors) */
 	void UpdateSuspensionVisualsOnly(float DeltaTime);
 
@@ -354,8 +849,10 @@ protected:
 
 	void AnimateWheels(float DeltaTime);
 
-	float ApplyBrake(float DeltaTime, float AngularVelocity, float BrakeRatio);
-	float CalculateFrictionCoefficient(FVector DirectionVelocity, FVector ForwardVector, FVector2D FrictionEllipse);
+	/** Vehicle model config for simulation core */
+	FPrvSuspensionSettings GetSuspensionSettings() const;
+	FPrvFrictionSettings GetFrictionSettings() const;
+	FPrvTrackDrive MakeTrackDrive(const FTrackInfo& Track) const;
 
 	/** Shift gear up or down 
 	 * Attn.! It doesn't think about why it happend, so it should be done externally!) */
@@ -365,9 +862,15 @@ protected:
 	//////////////////////////////////////////////////////////////////////////
 	// Network
 
-	/** Pass current state to server */
-	UFUNCTION(reliable, server, WithValidation)
-	void ServerUpdateState(uint16 InQuantizeInput);
+	/** Queue changed input and send the latest inputs to server respecting send rate */
+	void UpdateInputStream(uint16 NewQuantizeInput);
+
+	/** Apply quantized input on server */
+	void ApplyQuantizedInput(uint16 InQuantizeInput);
+
+	/** Pass player input to server (packets can be lost or reordered, so they carry previous inputs too) */
+	UFUNCTION(unreliable, server, WithValidation)
+	void ServerUpdateInput(const FPrvInputPacket& InPacket);
 
 	// MAKE ALL CONFIG PUBLIC
 public:
@@ -548,6 +1051,30 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Suspension)
 	bool bAdaptiveDampingCorrection;
 
+	/** Run forces pipeline with fixed time step (substeps are accumulated from frame time) */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = PhysicsSimulation)
+	bool bUseFixedTimestep;
+
+	/** Fixed simulation step [s] */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = PhysicsSimulation, meta = (EditCondition = "bUseFixedTimestep", ClampMin = "0.001", UIMin = "0.001"))
+	float FixedTimestep;
+
+	/** Maximum substeps per frame, rest of the frame time is dropped */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = PhysicsSimulation, meta = (EditCondition = "bUseFixedTimestep", ClampMin = "1", UIMin = "1"))
+	int32 MaxSubsteps;
+
+	/** Vehicle is ticked by world fleet manager: pure-math stages of all vehicles are processed in parallel */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = PhysicsSimulation)
+	bool bUseFleetManager;
+
+	/** Bake float curves into lookup tables on initialization */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = PhysicsSimulation)
+	bool bBakeCurves;
+
+	/** Number of samples in baked curve table */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = PhysicsSimulation, meta = (EditCondition = "bBakeCurves", ClampMin = "2", UIMin = "2"))
+	int32 CurveBakeResolution;
+
 	/** How fast wheels are animated while going down */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Suspension)
 	float DropFactor;
@@ -579,6 +1106,34 @@ public:
 	/** Suspension use line trace by camera (only for client) */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Suspension)
 	bool bSimplifiedSuspensionByCamera;
+
+	/** Process suspension traces asynchronously: results are used on the next tick being reprojected into current suspension transform */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Suspension)
+	bool bAsyncSuspensionTraces;
+
+	/** Sample landscape heightfield directly when vehicle stands on landscape only, scene traces are used near any other collision */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Suspension)
+	bool bLandscapeGroundSampling;
+
+	/** Extra distance around suspension bounds that should be free of non-landscape collision to use heightfield sampling */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Suspension, meta = (EditCondition = "bLandscapeGroundSampling", ClampMin = "0.0", UIMin = "0.0"))
+	float LandscapeGroundClearance;
+
+	/** Reuse the last wheel contact plane over static geometry instead of tracing while the wheel barely moves */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Suspension)
+	bool bSuspensionContactCache;
+
+	/** Max suspension displacement from the traced location the cached contact is valid for [cm] */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Suspension, meta = (EditCondition = "bSuspensionContactCache", ClampMin = "0.0", UIMin = "0.0"))
+	float ContactCacheMaxDisplacement;
+
+	/** Max suspension rotation from the traced direction the cached contact is valid for [deg] */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Suspension, meta = (EditCondition = "bSuspensionContactCache", ClampMin = "0.0", UIMin = "0.0"))
+	float ContactCacheMaxRotation;
+
+	/** Wheel is retraced after this time even if it didn't move [sec]. Movable objects entering the wheel are caught by a per-vehicle overlap, so this only bounds the error of other collision changes */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Suspension, meta = (EditCondition = "bSuspensionContactCache", ClampMin = "0.0", UIMin = "0.0"))
+	float ContactCacheTimeout;
 	
 public:
 
@@ -793,7 +1348,110 @@ public:
 protected:
 	float FinalMOI;
 
-	TArray<FSuspensionState> SuspensionData;
+	/** Per-wheel dynamic state (config is in SuspensionSetup) */
+	FPrvWheelsState WheelsState;
+
+	/** Dust effect per wheel (nullptr if wheel doesn't spawn dust or its effect isn't acquired yet) */
+	UPROPERTY(Transient)
+	TArray<UParticleSystemComponent*> WheelDustComponents;
+
+	/** Pending async traces (one per wheel) */
+	TArray<FSuspensionAsyncTrace> AsyncSuspensionTraces;
+
+	/** Landscape collision under suspension collected by UpdateLandscapeGround (valid during suspension update only) */
+	TArray<UPrimitiveComponent*> LandscapeGroundComponents;
+
+	/** Last traced contact per wheel */
+	TArray<FPrvWheelContactCache> WheelContactCache;
+
+	/** World bounds of movable collision around suspension collected by UpdateContactCacheBlockers (valid during suspension update only) */
+	TArray<FBox> ContactCacheBlockers;
+
+	/** Wheel contacts taken from cache and traced since the vehicle started */
+	uint32 ContactCacheHits;
+	uint32 ContactCacheMisses;
+
+	/** Body transform the suspension and friction are calculated for (extrapolated for fixed substeps) */
+	FTransform SimTransform;
+
+	/** Predicted velocity change since the physics body state (fixed substeps only) */
+	FVector SimLinearVelocityOffset;
+
+	/** Scale of forces applied by current step: step time relative to frame time */
+	float SimForceScale;
+
+	/** Sum of forces applied to the body by current step (unscaled) */
+	FVector SimAppliedForce;
+
+	/** Async traces should be requested by current step */
+	bool bSimRequestAsyncTraces;
+
+	/** World time of current step (captured on game thread for deferred dynamics) */
+	float SimWorldTime;
+
+	/** Not simulated time left from previous frames */
+	float FixedTimestepAccumulator;
+
+	/** Time since the last step covered by held forces (frames shorter than fixed step) */
+	float FixedTimestepHeldTime;
+
+	/** Unscaled forces of the last fixed step in body space, applied again by frames without steps */
+	FPrvBodyCommands HeldStepForces;
+
+	/** Current step forces should be recorded to HeldStepForces */
+	bool bRecordStepForces;
+
+	/** Tuning cached for simulation */
+	FPrvSuspensionSettings CachedSuspensionSettings;
+	FPrvFrictionSettings CachedFrictionSettings;
+
+	/** Per-wheel suspension coefficients (built for current vehicle mass) */
+	TArray<FPrvSuspensionCoefficients> SuspensionCoefficients;
+
+	/** Cached coefficients should be rebuilt */
+	bool bSimulationCacheDirty;
+
+	/** Body modifications buffered by deferred simulation */
+	FPrvBodyCommands PendingBodyCommands;
+
+	/** Body modifications should be buffered instead of being applied */
+	bool bDeferBodyCommands;
+
+	/** SimulateDeferred should complete current step */
+	bool bDeferredStepPending;
+
+	/** Manager the vehicle is registered with */
+	TWeakObjectPtr<APrvVehicleFleetManager> FleetManager;
+
+	/** Simulation is ticked by fleet manager, component tick runs the rest (blueprint tick) only */
+	bool bTickedByFleetManager;
+
+	/** Wheels tracing level assigned by significance of simulated proxy */
+	EPrvWheelLod WheelLod;
+
+	/** Interleaved tier frame counter and time passed since the last trace */
+	int32 WheelLodFrameCounter;
+	float WheelLodAccumulatedTime;
+
+	/** Suspension trace budget is exhausted for current frame: previous contacts are reused */
+	bool bTraceBudgetStarved;
+
+	/** Wheels served by contact cache or landscape sampling during the last suspension update (not charged by budget) */
+	int32 UntracedWheels;
+
+	/** Frames the vehicle was scheduled by trace budget and frames it was starved */
+	uint32 TraceBudgetFrames;
+	uint32 TraceBudgetStarvedFrames;
+
+	/** Frames in a row the vehicle was starved */
+	int32 TraceBudgetStarvedStreak;
+
+	/** Baked curves (null if curve is evaluated directly) */
+	TSharedPtr<const FPrvBakedCurve> BakedEngineTorqueCurve;
+	TSharedPtr<const FPrvBakedCurve> BakedSteeringCurve;
+	TSharedPtr<const FPrvBakedCurve> BakedMaxSpeedCurve;
+	TSharedPtr<const FPrvBakedCurve> BakedAutoBrakeUpRatio;
+	TSharedPtr<const FPrvBakedCurve> BakedAntiRolloverForceCurve;
 
 	int32 NeutralGear;
 	int32 CurrentGear;
@@ -917,6 +1575,10 @@ public:
 	UFUNCTION(BlueprintCallable, Category="PsRealVehicle|Components|VehicleMovement")
 	int32 GetLastUserSteeringInput() const;
 
+	/** Rebuild cached simulation coefficients on the next tick (call it when suspension or friction tuning is changed in runtime) */
+	UFUNCTION(BlueprintCallable, Category="PsRealVehicle|Components|VehicleMovement")
+	void InvalidateSimulationCache();
+
 protected:
 	/** */
 	UPROPERTY(Transient, Replicated)
@@ -938,6 +1600,38 @@ protected:
 	bool bShouldAnimateWheels;
 
 
+	//////////////////////////////////////////////////////////////////////////
+	// Published state
+
+public:
+	/**
+	 * Copy vehicle state published by the last tick (safe on any thread)
+	 * @return false if nothing was published yet
+	 */
+	bool GetPublishedState(FPrvVehicleStateSnapshot& OutState) const;
+
+protected:
+	/** [game thread] Publish wheels, engine and tracks state for worker thread consumers */
+	void PublishState();
+
+	/** Last published state */
+	TPrvSeqLock<FPrvVehicleStateSnapshot> PublishedState;
+
+
+	//////////////////////////////////////////////////////////////////////////
+	// Telemetry
+
+protected:
+	/** Queue inputs and state of current tick to fleet manager telemetry file */
+	void RecordTelemetry(float DeltaTime);
+
+	/** Vehicle was sampled for telemetry recording */
+	bool bRecordTelemetry;
+
+	/** Vehicle id in telemetry session (assigned by fleet manager) */
+	uint32 TelemetryVehicleId;
+
+
 	//////////////////////////////////////////////////////////////////////////
 	// Vehicle stats
 
@@ -978,6 +1672,14 @@ public:
 	UFUNCTION(BlueprintCallable, Category="PsRealVehicle|Components|VehicleMovement")
 	float GetAngularVelocityRight() const;
 
+	/** Part of wheel contacts taken from the contact cache instead of traces */
+	UFUNCTION(BlueprintCallable, Category="PsRealVehicle|Components|VehicleMovement")
+	float GetContactCacheHitRate() const;
+
+	/** Part of frames the vehicle was left without suspension traces by global trace budget */
+	UFUNCTION(BlueprintCallable, Category="PsRealVehicle|Components|VehicleMovement")
+	float GetTraceBudgetStarvedRate() const;
+
 	/** Get left track brake ratio */
 	UFUNCTION(BlueprintCallable, Category="PsRealVehicle|Components|VehicleMovement")
 	float GetBrakeRatioLeft() const;
@@ -1031,9 +1733,15 @@ public:
 	/** Get current suspension state */
 	void GetSuspensionData(TArray<FSuspensionState>& OutSuspensionData) const;
 
+	/** Get current state of the single wheel */
+	FSuspensionState GetSuspensionState(int32 WheelIndex) const;
+
 	/** Get raw steering input */
 	float GetRawSteeringInput() const;
 
+	/** Measure suspension kernels cost for current vehicle state (console: PrvVehicle.BenchmarkSuspension) */
+	void BenchmarkSuspension(int32 Iterations);
+
 protected:
 	/** Get the mesh this vehicle is tied to */
 	class USkinnedMeshComponent* GetMesh();
@@ -1044,6 +1752,216 @@ public:
 	USkinnedMeshComponent* UpdatedMesh;
 
 
+	//////////////////////////////////////////////////////////////////////////
+	// Input replication
+
+public:
+	/** Max number of input packets sent to server per second (0 - every frame) */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Network, meta = (ClampMin = "0.0", UIMin = "0.0"))
+	float MaxInputSendRate;
+
+	/** Throttle and steering changes smaller than this are not sent (full and zero values are always sent) */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Network, meta = (ClampMin = "0.0", UIMin = "0.0", ClampMax = "1.0", UIMax = "1.0"))
+	float InputDeadband;
+
+	/** Number of inputs in each packet: the newest one and previous ones to cover lost packets */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Network, meta = (ClampMin = "1", UIMin = "1", ClampMax = "4", UIMax = "4"))
+	int32 InputRedundancy;
+
+	/** Latest inputs are resent with this interval even if they are not changed [sec] */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Network, meta = (ClampMin = "0.0", UIMin = "0.0"))
+	float InputKeepAliveInterval;
+
+	/** Input packets sent (client) or received (server) per second since the vehicle started */
+	UFUNCTION(BlueprintCallable, Category="PsRealVehicle|Components|VehicleMovement")
+	float GetInputPacketsPerSecond() const;
+
+	/** Input payload bytes sent (client) or received (server) per second since the vehicle started */
+	UFUNCTION(BlueprintCallable, Category="PsRealVehicle|Components|VehicleMovement")
+	float GetInputBytesPerSecond() const;
+
+	/** Input packets dropped by server as outdated */
+	uint32 GetInputPacketsDropped() const { return InputPacketsDropped; }
+
+	/** Input packets received by server with already applied newest input (keep-alive resends) */
+	uint32 GetInputPacketsKeepAlive() const { return InputPacketsKeepAlive; }
+
+	/** New driver starts its own input sequence: should be called on server and owning client when vehicle is (re)possessed */
+	void ResetInputStream();
+
+protected:
+	/** [client] Time the newest input was applied */
+	float InputSequenceStartTime;
+
+	/** [server] Time the last input was applied */
+	float LastAppliedInputTime;
+
+	/** [client] Latest quantized inputs, newest first */
+	uint16 InputHistory[FPrvInputPacket::MaxInputs];
+	int32 InputHistoryNum;
+
+	/** [client] Sequence number of the newest input */
+	uint16 InputSequence;
+
+	/** [client] Current input stream epoch */
+	uint8 InputEpoch;
+
+	/** [client] Newest input is not sent yet */
+	bool bInputPending;
+
+	/** [client] Time of the last input packet */
+	float LastInputSendTime;
+
+	/** [server] Sequence number of the last applied input */
+	uint16 LastAppliedInputSequence;
+
+	/** [server] Epoch of the applied input stream, any epoch is accepted after possession */
+	uint8 LastAppliedInputEpoch;
+	bool bAcceptAnyInputEpoch;
+
+	/** Input traffic counters (client sends, server receives) */
+	uint32 InputPackets;
+	uint32 InputBytes;
+	uint32 InputPacketsDropped;
+	uint32 InputPacketsKeepAlive;
+	float InputStatsStartTime;
+
+
+	//////////////////////////////////////////////////////////////////////////
+	// Wheels replication
+
+public:
+	/** Server replicates compact wheels state, so simulated proxies animate wheels and dust without any traces (costs bandwidth, up to 63 wheels) */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Network)
+	bool bReplicateWheelState;
+
+	/** Bits per replicated suspension length */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Network, meta = (EditCondition = "bReplicateWheelState", ClampMin = "1", UIMin = "1", ClampMax = "8", UIMax = "8"))
+	int32 WheelStateLengthBits;
+
+protected:
+	/** [server] Quantize current wheels state for replication */
+	void UpdateReplicatedWheels();
+
+	/** [client] Simulated proxy uses replicated wheels state instead of traces */
+	bool UseReplicatedWheels() const;
+
+	/** [client] Put wheels to replicated state */
+	void ApplyReplicatedWheels(float DeltaTime);
+
+	UPROPERTY(Transient, Replicated)
+	FPrvReplicatedWheels ReplicatedWheels;
+
+
+	//////////////////////////////////////////////////////////////////////////
+	// Client prediction
+
+public:
+	/** Owning client predicts movement and reconciles it with server states instead of generic rigid body replication */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Network)
+	bool bClientPrediction;
+
+	/** How many authoritative states per second server sends to the owning client */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Network, meta = (EditCondition = "bClientPrediction", ClampMin = "1.0", UIMin = "1.0"))
+	float ServerStateSendRate;
+
+	/** Number of predicted frames kept for reconciliation (should cover round trip time) */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Network, meta = (EditCondition = "bClientPrediction", ClampMin = "1", UIMin = "1"))
+	int32 PredictionHistorySize;
+
+	/** Prediction errors smaller than this are ignored [cm] */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Network, meta = (EditCondition = "bClientPrediction", ClampMin = "0.0", UIMin = "0.0"))
+	float PredictionTolerance;
+
+	/** Prediction errors bigger than this are corrected instantly, smaller ones are blended [cm] */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Network, meta = (EditCondition = "bClientPrediction", ClampMin = "0.0", UIMin = "0.0"))
+	float PredictionSnapDistance;
+
+	/** Time to blend small prediction errors out [sec] */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Network, meta = (EditCondition = "bClientPrediction", ClampMin = "0.0", UIMin = "0.0"))
+	float PredictionCorrectionTime;
+
+	/** Owning client reconciles its movement with server (generic rigid body replication should be skipped) */
+	bool IsClientPredictionActive() const;
+
+protected:
+	/** [client] Remember predicted state for the current input */
+	void RecordPredictionHistory();
+
+	/** [client] Blend out pending prediction error */
+	void ApplyPredictionCorrection(float DeltaTime);
+
+	/** [server] Send authoritative state to the owning client respecting send rate */
+	void SendServerState();
+
+	/** Authoritative state with the last applied input */
+	UFUNCTION(unreliable, client)
+	void ClientAckState(const FPrvServerState& InState);
+
+	/** [client] Ring of predicted states */
+	TArray<FPrvPredictionHistoryEntry> PredictionHistory;
+	int32 PredictionHistoryHead;
+
+	/** [client] Position and rotation error not blended out yet */
+	FVector PendingCorrectionLocation;
+	FQuat PendingCorrectionRotation;
+	float PendingCorrectionTime;
+
+	/** [client] The newest acknowledged server state (older acks are ignored) */
+	uint16 LastAckedSequence;
+	float LastAckedTimeSinceInput;
+
+	/** [server] Time the last state was sent */
+	float LastServerStateSendTime;
+
+
+	//////////////////////////////////////////////////////////////////////////
+	// Snapshot interpolation
+
+public:
+	/** Simulated proxy is rendered from buffered replicated states with delay instead of being corrected by them */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Network)
+	bool bSnapshotInterpolation;
+
+	/** Render time delay behind the newest received state (should cover a couple of net updates) [sec] */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Network, meta = (EditCondition = "bSnapshotInterpolation", ClampMin = "0.0", UIMin = "0.0"))
+	float InterpolationDelay;
+
+	/** Max time the newest state is extrapolated for when buffer runs dry [sec] */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Network, meta = (EditCondition = "bSnapshotInterpolation", ClampMin = "0.0", UIMin = "0.0"))
+	float MaxExtrapolationTime;
+
+	/** Max number of buffered states */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Network, meta = (EditCondition = "bSnapshotInterpolation", ClampMin = "2", UIMin = "2"))
+	int32 SnapshotBufferSize;
+
+	/** Simulated proxy uses snapshot interpolation (generic rigid body replication should be skipped) */
+	bool IsSnapshotInterpolationActive() const;
+
+	/** Buffer replicated state */
+	void AddSnapshot(const FRigidBodyState& NewState);
+
+	/** Snapshot metrics since the vehicle started */
+	float GetAverageSnapshotCorrection() const;
+	float GetMaxSnapshotCorrection() const { return SnapshotCorrectionMax; }
+	uint32 GetSnapshotStarvedFrames() const { return SnapshotStarvedFrames; }
+
+protected:
+	/** Move the body to interpolated (or extrapolated) state for delayed render time */
+	void UpdateSnapshotInterpolation();
+
+	/** Received states, oldest first */
+	TArray<FPrvStateSnapshot> Snapshots;
+
+	/** Distance the body was moved by interpolation: sum and max [cm] */
+	float SnapshotCorrectionSum;
+	float SnapshotCorrectionMax;
+	uint32 SnapshotFrames;
+
+	/** Frames rendered beyond the newest state */
+	uint32 SnapshotStarvedFrames;
+
+
 	//////////////////////////////////////////////////////////////////////////
 	// Effects
 
@@ -1054,6 +1972,15 @@ protected:
 	/** */
 	UParticleSystemComponent* SpawnNewWheelEffect(FName InSocketName = NAME_None, FVector InSocketOffset = FVector::ZeroVector);
 
+	/** Take wheel effect from world pool (spawns new one if pooling is disabled) */
+	UParticleSystemComponent* AcquireWheelEffect(UParticleSystem* Template);
+
+	/** Return wheel effect to its pool when its particles are finished (auto destroyed if it wasn't pooled) */
+	void ReleaseWheelEffect(UParticleSystemComponent* Effect);
+
+	/** World pool of wheel effects (null if pooling is disabled) */
+	APrvVehicleFleetManager* GetWheelEffectPool() const;
+
 protected:
 	/** */
 	UPROPERTY(EditDefaultsOnly, Category = Effects)
@@ -1138,6 +2065,9 @@ protected:
 	
 	/** Use line trace */
 	bool UseLineTrace();
+
+	/** Number of suspension traces the vehicle needs this frame (for global trace budget) */
+	int32 GetSuspensionTraceCost() const;
 	
 	/** Get camera vector (for client only) */
 	bool GetCameraVector(FVector& RelativeCameraVector, FVector& RelativeMeshForwardVector);
@@ -1175,12 +2105,3 @@ private:
 	UPROPERTY(Transient)
 	float RawThrottleInputKeep;
 };
-
-//////////////////////////////////////////////////////////////////////////
-// Some helper functions for converting units
-
-// rad/s to rev per minute
-inline float PrvOmegaToRPM(float Omega)
-{
-	return Omega * 30.f / PI;
-}
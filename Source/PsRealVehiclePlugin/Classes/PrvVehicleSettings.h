@@ -0,0 +1,68 @@
+// Copyright 2016 Pushkin Studio. All Rights Reserved.
+
+#pragma once
+
+#include "Engine/DeveloperSettings.h"
+
+#include "PrvVehicleSettings.generated.h"
+
+/**
+ * Project-wide vehicle settings (platform values can be overridden in platform Game.ini files)
+ */
+UCLASS(config = Game, defaultconfig)
+class PSREALVEHICLEPLUGIN_API UPrvVehicleSettings : public UDeveloperSettings
+{
+	GENERATED_UCLASS_BODY()
+
+	/** Rank simulated proxies by significance and reduce their wheels tracing (disabled by default, enable per project or platform) */
+	UPROPERTY(config, EditAnywhere, Category = Significance)
+	bool bEnableWheelSignificance;
+
+	/** Max number of vehicles with full wheel traces */
+	UPROPERTY(config, EditAnywhere, Category = Significance, meta = (ClampMin = "0", UIMin = "0"))
+	int32 MaxFullTierVehicles;
+
+	/** Max number of vehicles with line wheel traces */
+	UPROPERTY(config, EditAnywhere, Category = Significance, meta = (ClampMin = "0", UIMin = "0"))
+	int32 MaxLineTraceTierVehicles;
+
+	/** Max number of vehicles tracing wheels every few frames, the rest vehicles have frozen wheels */
+	UPROPERTY(config, EditAnywhere, Category = Significance, meta = (ClampMin = "0", UIMin = "0"))
+	int32 MaxInterleavedTierVehicles;
+
+	/** Max camera distance for full wheel traces [cm] */
+	UPROPERTY(config, EditAnywhere, Category = Significance, meta = (ClampMin = "0.0", UIMin = "0.0"))
+	float FullTierMaxDistance;
+
+	/** Max camera distance for line wheel traces [cm] */
+	UPROPERTY(config, EditAnywhere, Category = Significance, meta = (ClampMin = "0.0", UIMin = "0.0"))
+	float LineTraceTierMaxDistance;
+
+	/** Max camera distance for interleaved wheel traces [cm] */
+	UPROPERTY(config, EditAnywhere, Category = Significance, meta = (ClampMin = "0.0", UIMin = "0.0"))
+	float InterleavedTierMaxDistance;
+
+	/** Interleaved tier traces wheels once per this number of frames and interpolates between traces */
+	UPROPERTY(config, EditAnywhere, Category = Significance, meta = (ClampMin = "1", UIMin = "1"))
+	int32 InterleavedTraceInterval;
+
+	/** Significance scale of vehicles that were not rendered recently */
+	UPROPERTY(config, EditAnywhere, Category = Significance, meta = (ClampMin = "0.0", UIMin = "0.0", ClampMax = "1.0", UIMax = "1.0"))
+	float NotRenderedSignificanceScale;
+
+	/** Vehicle is considered as not rendered after this time [sec] */
+	UPROPERTY(config, EditAnywhere, Category = Significance, meta = (ClampMin = "0.0", UIMin = "0.0"))
+	float RecentlyRenderedTolerance;
+
+	/** Recycle wheel dust components through world pool instead of spawning new ones on surface change */
+	UPROPERTY(config, EditAnywhere, Category = Effects)
+	bool bPoolWheelEffects;
+
+	/** Max number of free wheel effects kept by pool (finished effects above the limit are destroyed) */
+	UPROPERTY(config, EditAnywhere, Category = Effects, meta = (EditCondition = "bPoolWheelEffects", ClampMin = "0", UIMin = "0"))
+	int32 WheelEffectPoolSize;
+
+	/** Number of wheel effects created when the world starts */
+	UPROPERTY(config, EditAnywhere, Category = Effects, meta = (EditCondition = "bPoolWheelEffects", ClampMin = "0", UIMin = "0"))
+	int32 WheelEffectPoolPrewarm;
+};
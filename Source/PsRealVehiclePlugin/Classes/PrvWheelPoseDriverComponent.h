@@ -0,0 +1,58 @@
+// Copyright 2016 Pushkin Studio. All Rights Reserved.
+
+#pragma once
+
+#include "Components/ActorComponent.h"
+
+#include "PrvWheelPoseDriverComponent.generated.h"
+
+class UPrvVehicleMovementComponent;
+
+/**
+ * Fast path for vehicle crowds: writes wheel and suspension bones directly into component space transforms
+ * of the vehicle mesh, so the mesh doesn't need AnimBlueprint with wheel handler node.
+ * Bones are posed relative to reference pose, children of wheel and suspension bones are not updated.
+ */
+UCLASS(ClassGroup = (Rendering), meta = (BlueprintSpawnableComponent))
+class PSREALVEHICLEPLUGIN_API UPrvWheelPoseDriverComponent : public UActorComponent
+{
+	GENERATED_UCLASS_BODY()
+
+public:
+	/** Don't update bones of the mesh that wasn't rendered recently */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Animation)
+	bool bSkipWhenNotRendered;
+
+	//~ Begin UActorComponent Interface
+	virtual void BeginPlay() override;
+	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction *ThisTickFunction) override;
+	//~ End UActorComponent Interface
+
+	/** Resolve wheel bones of the vehicle mesh (called on begin play, call it again if skeletal mesh or suspension setup is changed) */
+	void InitWheelBones();
+
+	/** Write wheel bones from published vehicle state */
+	void UpdateWheelPose();
+
+protected:
+	/** Vehicle the wheel state is taken from */
+	UPROPERTY(Transient)
+	UPrvVehicleMovementComponent* VehicleMovement;
+
+	/** Mesh the bones are written to */
+	UPROPERTY(Transient)
+	USkeletalMeshComponent* Mesh;
+
+	struct FWheelBones
+	{
+		int32 WheelIndex;
+		int32 WheelBoneIndex;
+		int32 SuspBoneIndex;
+
+		/** Component space reference pose */
+		FTransform WheelRefTransform;
+	};
+
+	/** Wheels with valid bones sorted by bone index (parents first) */
+	TArray<FWheelBones> WheelBones;
+};
@@ -15,6 +15,7 @@
 FAnimNode_PrvWheelHandler::FAnimNode_PrvWheelHandler()
 {
 	VehicleSimComponent = nullptr;
+	bHasWheelState = false;
 }
 
 void FAnimNode_PrvWheelHandler::GatherDebugData(FNodeDebugData& DebugData)
@@ -60,42 +61,41 @@ void FAnimNode_PrvWheelHandler::EvaluateSkeletalControl_AnyThread(FComponentSpac
 		return;
 	}
 	
-	const FBoneContainer& BoneContainer = MeshBases.GetPose().GetBoneContainer();
-	for(const auto & WheelSim : WheelSimulators)
+	// Bone indices are validated once by InitializeBoneReferences
+	for(const FPrvWheelBoneIndices& WheelBone : WheelBones)
 	{
-		if (WheelSim.BoneReference.IsValid(BoneContainer))
+		const FPrvWheelSimulator& WheelSim = WheelSimulators[WheelBone.SimulatorIndex];
+
+		// Nothing to add to the input pose
+		if (!WheelSim.bApplyOffset)
 		{
-			FCompactPoseBoneIndex WheelSimBoneIndex = WheelSim.BoneReference.GetCompactPoseIndex(BoneContainer);
-			
-			if (!MeshBases.GetPose().IsValidIndex(WheelSimBoneIndex))
-			{
-				continue;
-			}
-			
-			// the way we apply transform is same as FMatrix or FTransform
-			// we apply scale first, and rotation, and translation
-			// if you'd like to translate first, you'll need two nodes that first node does translate and second nodes to rotate.
-			FTransform NewBoneTM = MeshBases.GetComponentSpaceTransform(WheelSimBoneIndex);
-			
-			// Apply loc offset
-			NewBoneTM.AddToTranslation(WheelSim.LocOffset);
-			
-			// Save suspension transform before rotation
-			FTransform NewSuspBoneTM = NewBoneTM;
-			
-			// Apply rotation offset
-			const FQuat BoneQuat(WheelSim.RotOffset);
-			NewBoneTM.SetRotation(BoneQuat * NewBoneTM.GetRotation());
-			
-			MeshBases.SetComponentSpaceTransform(WheelSimBoneIndex, NewBoneTM);
-			
-			// Update suspension
-			if (WheelSim.SuspReference.IsValid(BoneContainer))
-			{
-				FCompactPoseBoneIndex SuspSimBoneIndex = WheelSim.SuspReference.GetCompactPoseIndex(BoneContainer);
-				MeshBases.GetComponentSpaceTransform(SuspSimBoneIndex); // for recalculation bone tree
-				MeshBases.SetComponentSpaceTransform(SuspSimBoneIndex, NewSuspBoneTM);
-			}
+			continue;
+		}
+
+		// the way we apply transform is same as FMatrix or FTransform
+		// we apply scale first, and rotation, and translation
+		// if you'd like to translate first, you'll need two nodes that first node does translate and second nodes to rotate.
+		FTransform NewBoneTM = MeshBases.GetComponentSpaceTransform(WheelBone.WheelBoneIndex);
+		
+		// Apply loc offset
+		NewBoneTM.AddToTranslation(WheelSim.LocOffset);
+		
+		// Save suspension transform before rotation
+		FTransform NewSuspBoneTM = NewBoneTM;
+		
+		// Apply rotation offset
+		if (WheelSim.bApplyRotation)
+		{
+			NewBoneTM.SetRotation(WheelSim.RotQuat * NewBoneTM.GetRotation());
+		}
+		
+		MeshBases.SetComponentSpaceTransform(WheelBone.WheelBoneIndex, NewBoneTM);
+		
+		// Update suspension
+		if (WheelBone.SuspBoneIndex.IsValid())
+		{
+			MeshBases.GetComponentSpaceTransform(WheelBone.SuspBoneIndex); // for recalculation bone tree
+			MeshBases.SetComponentSpaceTransform(WheelBone.SuspBoneIndex, NewSuspBoneTM);
 		}
 	}
 #endif
@@ -106,60 +106,79 @@ bool FAnimNode_PrvWheelHandler::IsValidToEvaluate(const USkeleton* Skeleton, con
 #if UE_SERVER
 	return false;
 #else
-	return RequiredBones.GetNumBones() > 0;
+	return RequiredBones.GetNumBones() > 0 && WheelBones.Num() > 0;
 #endif
 }
 
 void FAnimNode_PrvWheelHandler::InitializeBoneReferences(const FBoneContainer& RequiredBones) 
 {
 #if !UE_SERVER
-	for (auto & WheelSim : WheelSimulators)
+	WheelBones.Reset(WheelSimulators.Num());
+
+	for (int32 SimulatorIndex = 0; SimulatorIndex < WheelSimulators.Num(); ++SimulatorIndex)
 	{
+		FPrvWheelSimulator& WheelSim = WheelSimulators[SimulatorIndex];
 		WheelSim.BoneReference.Initialize(RequiredBones);
 		WheelSim.SuspReference.Initialize(RequiredBones);
+
+		// Wheels with bones missing in current LOD are skipped
+		if (WheelSim.BoneReference.IsValid(RequiredBones))
+		{
+			const FCompactPoseBoneIndex SuspBoneIndex = WheelSim.SuspReference.IsValid(RequiredBones) ? WheelSim.SuspReference.GetCompactPoseIndex(RequiredBones) : FCompactPoseBoneIndex(INDEX_NONE);
+			WheelBones.Add(FPrvWheelBoneIndices(SimulatorIndex, WheelSim.BoneReference.GetCompactPoseIndex(RequiredBones), SuspBoneIndex));
+		}
 	}
 
-	// sort by bone indices
-	WheelSimulators.Sort([](FPrvWheelSimulator L, FPrvWheelSimulator R) { return L.BoneReference.BoneIndex < R.BoneReference.BoneIndex; });
+	// Compact pose has parents before children
+	WheelBones.Sort([](const FPrvWheelBoneIndices& L, const FPrvWheelBoneIndices& R) { return L.WheelBoneIndex.GetInt() < R.WheelBoneIndex.GetInt(); });
 #endif
 }
 
 void FAnimNode_PrvWheelHandler::UpdateInternal(const FAnimationUpdateContext& Context)
 {
 #if !UE_SERVER
-	if(VehicleSimComponent)
+	// Published state is safe to read on worker thread
+	FPrvVehicleStateSnapshot VehicleState;
+	if(VehicleSimComponent && VehicleSimComponent->GetPublishedState(VehicleState))
 	{
+		// Sleeping vehicle keeps the offsets applied last time
+		if (VehicleState.bSleeping && bHasWheelState)
+		{
+			return;
+		}
+
 		for(auto & WheelSim : WheelSimulators)
 		{
-			if (VehicleSimComponent->SuspensionData.IsValidIndex(WheelSim.WheelIndex))
+			if (WheelSim.WheelIndex >= 0 && WheelSim.WheelIndex < VehicleState.NumWheels)
 			{
 				// Zero offset by default
-				WheelSim.RotOffset = FRotator::ZeroRotator;
-				WheelSim.LocOffset = FVector::ZeroVector;
-
-				const FSuspensionState& Wheel = VehicleSimComponent->SuspensionData[WheelSim.WheelIndex];
+				FRotator RotOffset = FRotator::ZeroRotator;
 
-				if (Wheel.SuspensionInfo.bAnimateBoneRotation)
+				const bool bApplyRotation = VehicleState.bAnimateRotation[WheelSim.WheelIndex];
+				if (bApplyRotation)
 				{
-					WheelSim.RotOffset.Pitch = Wheel.RotationAngle + WheelSim.WheelIndex * 250.f;
-					WheelSim.RotOffset.Yaw = Wheel.SteeringAngle;
-					WheelSim.RotOffset.Roll = 0.f;
+					RotOffset.Pitch = VehicleState.RotationAngle[WheelSim.WheelIndex] + WheelSim.WheelIndex * 250.f;
+					RotOffset.Yaw = VehicleState.SteeringAngle[WheelSim.WheelIndex];
 				}
 
-				if (Wheel.SuspensionInfo.bAnimateBoneOffset)
+				// Suspension, wheel bone and visual offsets
+				const FVector& LocOffset = VehicleState.WheelOffset[WheelSim.WheelIndex];
+
+				// Static wheel keeps its offsets and quaternion
+				if (bHasWheelState && bApplyRotation == WheelSim.bApplyRotation && RotOffset == WheelSim.RotOffset && LocOffset == WheelSim.LocOffset)
 				{
-					WheelSim.LocOffset.X = 0.f;
-					WheelSim.LocOffset.Y = 0.f;
-					WheelSim.LocOffset.Z = Wheel.SuspensionInfo.Length - Wheel.VisualLength;
+					continue;
 				}
 
-				// Apply wheen bone offset
-				WheelSim.LocOffset += Wheel.SuspensionInfo.WheelBoneOffset;
-
-				// Apply just visual offset
-				WheelSim.LocOffset += Wheel.SuspensionInfo.VisualOffset;
+				WheelSim.RotOffset = RotOffset;
+				WheelSim.LocOffset = LocOffset;
+				WheelSim.RotQuat = bApplyRotation ? FQuat(RotOffset) : FQuat::Identity;
+				WheelSim.bApplyRotation = bApplyRotation;
+				WheelSim.bApplyOffset = bApplyRotation || !LocOffset.IsZero();
 			}
 		}
+
+		bHasWheelState = true;
 	}
 #endif
 }
@@ -179,6 +198,10 @@ void FAnimNode_PrvWheelHandler::Initialize(const FAnimationInitializeContext& Co
 		int32 NumOfwheels = VehicleSimComponent->SuspensionSetup.Num();
 		if(NumOfwheels > 0)
 		{
+			// Bone indices are resolved again by InitializeBoneReferences
+			WheelBones.Reset();
+			bHasWheelState = false;
+
 			WheelSimulators.Empty(NumOfwheels);
 			WheelSimulators.AddZeroed(NumOfwheels);
 
@@ -192,12 +215,13 @@ void FAnimNode_PrvWheelHandler::Initialize(const FAnimationInitializeContext& Co
 				WheelSim.WheelIndex = WheelIndex;
 				WheelSim.BoneReference.BoneName = WheelSetup.BoneName;
 				
-				// TODO:
-				// WheelSim.SuspReference.BoneName = WheelSetup.SuspBoneName;
-				WheelSim.SuspReference.BoneName = FName(*WheelSetup.BoneName.ToString().Replace(TEXT("Wheel"), TEXT("Suspension"), ESearchCase::Type::CaseSensitive));
+				WheelSim.SuspReference.BoneName = WheelSetup.GetSuspensionBoneName();
 				
 				WheelSim.LocOffset = FVector::ZeroVector;
 				WheelSim.RotOffset = FRotator::ZeroRotator;
+				WheelSim.RotQuat = FQuat::Identity;
+				WheelSim.bApplyRotation = false;
+				WheelSim.bApplyOffset = false;
 			}
 		}
 	}
@@ -207,9 +231,6 @@ void FAnimNode_PrvWheelHandler::Initialize(const FAnimationInitializeContext& Co
 
 bool FAnimNode_PrvWheelHandler::CanUpdateInWorkerThread() const
 {
-#if UE_SERVER
+	// Vehicle state is read from published snapshot
 	return true;
-#else
-	return false;
-#endif
 }
@@ -0,0 +1,83 @@
+// Copyright 2016 Pushkin Studio. All Rights Reserved.
+
+#include "PrvPlugin.h"
+
+#include "PrvBakedCurveCache.h"
+
+TMap<uint32, TArray<FPrvBakedCurveCache::FEntry>> FPrvBakedCurveCache::Entries;
+
+TSharedPtr<const FPrvBakedCurve> FPrvBakedCurveCache::GetBakedCurve(const FRichCurve& Curve, int32 NumSamples, const TCHAR* CurveName)
+{
+	check(IsInGameThread());
+
+	if (Curve.GetNumKeys() == 0)
+	{
+		return nullptr;
+	}
+
+	// Table is clamped by time range, so other extrapolation types can't be baked
+	if (Curve.PreInfinityExtrap != RCCE_Constant || Curve.PostInfinityExtrap != RCCE_Constant)
+	{
+		UE_LOG(LogPrvVehicle, Warning, TEXT("%s: curve with non-constant extrapolation is evaluated without baking"), CurveName);
+		return nullptr;
+	}
+
+	const uint32 CurveHash = GetCurveHash(Curve, NumSamples);
+	TArray<FEntry>& HashEntries = Entries.FindOrAdd(CurveHash);
+
+	// Remove curves nobody uses anymore
+	HashEntries.RemoveAllSwap([](const FEntry& Entry) { return !Entry.BakedCurve.IsValid(); });
+
+	for (const FEntry& Entry : HashEntries)
+	{
+		if (Entry.NumSamples == NumSamples && Entry.Keys == Curve.Keys)
+		{
+			return Entry.BakedCurve.Pin();
+		}
+	}
+
+	float MinTime = 0.f;
+	float MaxTime = 0.f;
+	Curve.GetTimeRange(MinTime, MaxTime);
+
+	TSharedPtr<FPrvBakedCurve> BakedCurve = MakeShareable(new FPrvBakedCurve());
+	BakedCurve->Bake(MinTime, MaxTime, NumSamples, [&Curve](float Time) { return Curve.Eval(Time); });
+
+	// Report baking precision relative to the curve values range
+	float MinValue = 0.f;
+	float MaxValue = 0.f;
+	Curve.GetValueRange(MinValue, MaxValue);
+	const float ValueRange = FMath::Max(MaxValue - MinValue, KINDA_SMALL_NUMBER);
+	const float RelativeError = BakedCurve->GetMaxError() / ValueRange;
+
+	UE_LOG(LogPrvVehicle, Log, TEXT("%s: baked %d samples [%f, %f], max error %f (%.2f%%) at %f"),
+		CurveName, BakedCurve->GetNumSamples(), MinTime, MaxTime, BakedCurve->GetMaxError(), RelativeError * 100.f, BakedCurve->GetMaxErrorTime());
+
+	if (RelativeError > 0.01f)
+	{
+		UE_LOG(LogPrvVehicle, Warning, TEXT("%s: baked curve deviates from the source by %.2f%%, consider increasing CurveBakeResolution"), CurveName, RelativeError * 100.f);
+	}
+
+	FEntry& NewEntry = HashEntries[HashEntries.AddDefaulted()];
+	NewEntry.Keys = Curve.Keys;
+	NewEntry.NumSamples = NumSamples;
+	NewEntry.BakedCurve = BakedCurve;
+
+	return BakedCurve;
+}
+
+uint32 FPrvBakedCurveCache::GetCurveHash(const FRichCurve& Curve, int32 NumSamples)
+{
+	uint32 Hash = GetTypeHash(NumSamples);
+
+	for (const FRichCurveKey& Key : Curve.Keys)
+	{
+		Hash = HashCombine(Hash, GetTypeHash(Key.Time));
+		Hash = HashCombine(Hash, GetTypeHash(Key.Value));
+		Hash = HashCombine(Hash, GetTypeHash(Key.ArriveTangent));
+		Hash = HashCombine(Hash, GetTypeHash(Key.LeaveTangent));
+		Hash = HashCombine(Hash, GetTypeHash(static_cast<uint8>(Key.InterpMode)));
+	}
+
+	return Hash;
+}
@@ -0,0 +1,33 @@
+// Copyright 2016 Pushkin Studio. All Rights Reserved.
+
+#pragma once
+
+#include "Curves/RichCurve.h"
+
+#include "PrvBakedCurve.h"
+
+/**
+ * Baked curves shared between vehicles: curves with the same keys are baked once
+ */
+class FPrvBakedCurveCache
+{
+public:
+	/**
+	 * Find or bake the curve table (game thread only)
+	 * @return nullptr if the curve can't be baked (no keys or non-constant extrapolation)
+	 */
+	static TSharedPtr<const FPrvBakedCurve> GetBakedCurve(const FRichCurve& Curve, int32 NumSamples, const TCHAR* CurveName);
+
+protected:
+	struct FEntry
+	{
+		TArray<FRichCurveKey> Keys;
+		int32 NumSamples;
+		TWeakPtr<const FPrvBakedCurve> BakedCurve;
+	};
+
+	static uint32 GetCurveHash(const FRichCurve& Curve, int32 NumSamples);
+
+	/** Entries by curve hash */
+	static TMap<uint32, TArray<FEntry>> Entries;
+};
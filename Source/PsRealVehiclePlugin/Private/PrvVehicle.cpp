@@ -42,6 +42,43 @@ void APrvVehicle::MoveRight(float Val)
 }
 
 
+//////////////////////////////////////////////////////////////////////////
+// Replication
+
+void APrvVehicle::Restart()
+{
+	Super::Restart();
+
+	// Called on server by PossessedBy and on owning client by PawnClientRestart
+	if (VehicleMovement)
+	{
+		VehicleMovement->ResetInputStream();
+	}
+}
+
+void APrvVehicle::PostNetReceivePhysicState()
+{
+	UPrvVehicleMovementComponent* Movement = GetVehicleMovementComponent();
+
+	// Predicting client is corrected by movement component
+	if (Movement && Movement->IsClientPredictionActive())
+	{
+		return;
+	}
+
+	// Simulated proxy renders buffered states
+	if (Movement && Movement->IsSnapshotInterpolationActive())
+	{
+		FRigidBodyState NewState;
+		ReplicatedMovement.CopyTo(NewState, this);
+		Movement->AddSnapshot(NewState);
+		return;
+	}
+
+	Super::PostNetReceivePhysicState();
+}
+
+
 //////////////////////////////////////////////////////////////////////////
 // Debug
 
@@ -5,17 +5,104 @@
 UPrvVehicleDustEffect::UPrvVehicleDustEffect(const FObjectInitializer& ObjectInitializer) 
 	: Super(ObjectInitializer)
 {
+	bSurfaceTableDirty = true;
+}
+
+void UPrvVehicleDustEffect::PostLoad()
+{
+	Super::PostLoad();
+
+	BuildSurfaceTable();
+
+#if WITH_EDITOR
+	ValidateDustEffects();
+#endif
+}
+
+#if WITH_EDITOR
+void UPrvVehicleDustEffect::PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
 
+	BuildSurfaceTable();
+	ValidateDustEffects();
+}
+
+void UPrvVehicleDustEffect::ValidateDustEffects() const
+{
+	for (int32 EffectIndex = 0; EffectIndex < DustEffects.Num(); ++EffectIndex)
+	{
+		const FDustInfo& DustEffect = DustEffects[EffectIndex];
+
+		// Entries are checked in order, so the earlier one with lower (or same) speed always wins
+		for (int32 PrevIndex = 0; PrevIndex < EffectIndex; ++PrevIndex)
+		{
+			const FDustInfo& PrevEffect = DustEffects[PrevIndex];
+			if (PrevEffect.SurfaceType != DustEffect.SurfaceType)
+			{
+				continue;
+			}
+
+			if (PrevEffect.ActivationMinSpeed == DustEffect.ActivationMinSpeed)
+			{
+				UE_LOG(LogPrvVehicle, Warning, TEXT("%s: DustEffects[%d] duplicates DustEffects[%d] (surface %d, speed %.1f)"),
+					*GetPathName(), EffectIndex, PrevIndex, (int32)DustEffect.SurfaceType, DustEffect.ActivationMinSpeed);
+				break;
+			}
+			else if (PrevEffect.ActivationMinSpeed < DustEffect.ActivationMinSpeed)
+			{
+				UE_LOG(LogPrvVehicle, Warning, TEXT("%s: DustEffects[%d] is unreachable, DustEffects[%d] has lower speed for the same surface %d (%.1f < %.1f), place faster effects first"),
+					*GetPathName(), EffectIndex, PrevIndex, (int32)DustEffect.SurfaceType, PrevEffect.ActivationMinSpeed, DustEffect.ActivationMinSpeed);
+				break;
+			}
+		}
+	}
+}
+#endif // WITH_EDITOR
+
+void UPrvVehicleDustEffect::BuildSurfaceTable()
+{
+	SurfaceDust.Reset(DustEffects.Num());
+
+	for (int32 Surface = 0; Surface < SurfaceType_Max; ++Surface)
+	{
+		SurfaceDustStart[Surface] = SurfaceDust.Num();
+
+		// Entry is reachable only if it's faster than all previous ones of the surface, so kept ones are sorted by speed descending
+		float MinSpeed = MAX_flt;
+		for (const FDustInfo& DustEffect : DustEffects)
+		{
+			if (DustEffect.SurfaceType == Surface && DustEffect.ActivationMinSpeed < MinSpeed)
+			{
+				FSurfaceDust& Dust = SurfaceDust[SurfaceDust.AddUninitialized()];
+				Dust.ActivationMinSpeed = DustEffect.ActivationMinSpeed;
+				Dust.DustFX = DustEffect.DustFX;
+
+				MinSpeed = DustEffect.ActivationMinSpeed;
+			}
+		}
+	}
+
+	SurfaceDustStart[SurfaceType_Max] = SurfaceDust.Num();
+	bSurfaceTableDirty = false;
 }
 
 UParticleSystem* UPrvVehicleDustEffect::GetDustFX(EPhysicalSurface SurfaceType, float CurrentSpeed)
 {
-	for (auto DustEffect : DustEffects)
+	if (bSurfaceTableDirty)
+	{
+		BuildSurfaceTable();
+	}
+
+	if (SurfaceType >= 0 && SurfaceType < SurfaceType_Max)
 	{
-		if (DustEffect.SurfaceType == SurfaceType && 
-			CurrentSpeed >= DustEffect.ActivationMinSpeed)
+		for (int32 DustIndex = SurfaceDustStart[SurfaceType]; DustIndex < SurfaceDustStart[SurfaceType + 1]; ++DustIndex)
 		{
-			return DustEffect.DustFX;
+			const FSurfaceDust& Dust = SurfaceDust[DustIndex];
+			if (CurrentSpeed >= Dust.ActivationMinSpeed)
+			{
+				return Dust.DustFX;
+			}
 		}
 	}
 
@@ -0,0 +1,721 @@
+// Copyright 2016 Pushkin Studio. All Rights Reserved.
+
+#include "PrvPlugin.h"
+
+#include "PrvHeadlessVehicle.h"
+
+#include "EngineUtils.h"
+#include "Kismet/GameplayStatics.h"
+#include "Async/ParallelFor.h"
+
+DECLARE_CYCLE_STAT(TEXT("Fleet Tick"), STAT_PrvFleetTick, STATGROUP_MovementPhysics);
+DECLARE_CYCLE_STAT(TEXT("Fleet Pre Simulate"), STAT_PrvFleetPreSimulate, STATGROUP_MovementPhysics);
+DECLARE_CYCLE_STAT(TEXT("Fleet Simulate Deferred"), STAT_PrvFleetSimulateDeferred, STATGROUP_MovementPhysics);
+DECLARE_CYCLE_STAT(TEXT("Fleet Post Simulate"), STAT_PrvFleetPostSimulate, STATGROUP_MovementPhysics);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Fleet Vehicles"), STAT_PrvFleetVehicles, STATGROUP_MovementPhysics);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Fleet Deferred Vehicles"), STAT_PrvFleetDeferredVehicles, STATGROUP_MovementPhysics);
+DECLARE_CYCLE_STAT(TEXT("Fleet Update Significance"), STAT_PrvFleetUpdateSignificance, STATGROUP_MovementPhysics);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Wheel LOD Full"), STAT_PrvWheelLodFull, STATGROUP_MovementPhysics);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Wheel LOD Line Trace"), STAT_PrvWheelLodLineTrace, STATGROUP_MovementPhysics);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Wheel LOD Interleaved"), STAT_PrvWheelLodInterleaved, STATGROUP_MovementPhysics);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Wheel LOD Frozen"), STAT_PrvWheelLodFrozen, STATGROUP_MovementPhysics);
+DECLARE_CYCLE_STAT(TEXT("Fleet Update Trace Budget"), STAT_PrvFleetUpdateTraceBudget, STATGROUP_MovementPhysics);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Trace Budget Granted Traces"), STAT_PrvTraceBudgetGranted, STATGROUP_MovementPhysics);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Trace Budget Starved Vehicles"), STAT_PrvTraceBudgetStarved, STATGROUP_MovementPhysics);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Wheel Effects Spawned"), STAT_PrvWheelEffectsSpawned, STATGROUP_MovementPhysics);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Wheel Effects Recycled"), STAT_PrvWheelEffectsRecycled, STATGROUP_MovementPhysics);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Wheel Effect Pool Misses"), STAT_PrvWheelEffectPoolMisses, STATGROUP_MovementPhysics);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Wheel Effect Pool Free"), STAT_PrvWheelEffectPoolFree, STATGROUP_MovementPhysics);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Telemetry Records"), STAT_PrvTelemetryRecords, STATGROUP_MovementPhysics);
+
+static int32 GPrvVehicleFleetParallel = 1;
+static FAutoConsoleVariableRef CVarPrvVehicleFleetParallel(
+	TEXT("PrvVehicle.FleetParallel"),
+	GPrvVehicleFleetParallel,
+	TEXT("Process deferred dynamics of fleet vehicles on worker threads (0 - game thread only)"));
+
+static int32 GPrvVehicleSuspensionTraceBudget = 0;
+static FAutoConsoleVariableRef CVarPrvVehicleSuspensionTraceBudget(
+	TEXT("PrvVehicle.SuspensionTraceBudget"),
+	GPrvVehicleSuspensionTraceBudget,
+	TEXT("Max suspension traces per frame for all vehicles in the world, vehicles out of budget reuse previous contacts, applied to vehicles that begin play after change (0 - unlimited)"));
+
+static float GPrvVehicleTelemetrySampleRate = 0.f;
+static FAutoConsoleVariableRef CVarPrvVehicleTelemetrySampleRate(
+	TEXT("PrvVehicle.TelemetrySampleRate"),
+	GPrvVehicleTelemetrySampleRate,
+	TEXT("Fraction of vehicles that record per-tick telemetry to Saved/Telemetry, rolled when vehicle begins play (0 - disabled, 1 - all vehicles)"));
+
+static int32 GPrvVehicleTelemetryMaxFileSizeMB = 512;
+static FAutoConsoleVariableRef CVarPrvVehicleTelemetryMaxFileSizeMB(
+	TEXT("PrvVehicle.TelemetryMaxFileSizeMB"),
+	GPrvVehicleTelemetryMaxFileSizeMB,
+	TEXT("Telemetry session file stops growing at this size, the rest of records is dropped (0 - unlimited)"));
+
+APrvVehicleFleetManager::APrvVehicleFleetManager(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = true;
+	PrimaryActorTick.TickGroup = TG_PrePhysics;
+
+	bReplicates = false;
+
+	bTelemetryFailed = false;
+	NextTelemetryVehicleId = 1;
+}
+
+APrvVehicleFleetManager* APrvVehicleFleetManager::Get(UWorld* World)
+{
+	if (!World || !World->IsGameWorld())
+	{
+		return nullptr;
+	}
+
+	for (TActorIterator<APrvVehicleFleetManager> It(World); It; ++It)
+	{
+		if (!It->IsPendingKill())
+		{
+			return *It;
+		}
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	SpawnParams.ObjectFlags |= RF_Transient;
+
+	return World->SpawnActor<APrvVehicleFleetManager>(SpawnParams);
+}
+
+void APrvVehicleFleetManager::RegisterVehicle(UPrvVehicleMovementComponent* Vehicle)
+{
+	if (Vehicle && !Vehicles.Contains(Vehicle))
+	{
+		Vehicles.Add(Vehicle);
+
+		// Manager simulates vehicle instead, component tick is left for blueprint tick
+		Vehicle->bTickedByFleetManager = true;
+
+		// Input set by pawn tick should be simulated in the same frame
+		if (AActor* Owner = Vehicle->GetOwner())
+		{
+			AddTickPrerequisiteActor(Owner);
+		}
+	}
+}
+
+void APrvVehicleFleetManager::UnregisterVehicle(UPrvVehicleMovementComponent* Vehicle)
+{
+	if (Vehicles.Remove(Vehicle) > 0)
+	{
+		Vehicle->bTickedByFleetManager = false;
+
+		if (AActor* Owner = Vehicle->GetOwner())
+		{
+			RemoveTickPrerequisiteActor(Owner);
+		}
+	}
+}
+
+void APrvVehicleFleetManager::RegisterSignificance(UPrvVehicleMovementComponent* Vehicle)
+{
+	if (Vehicle)
+	{
+		SignificanceVehicles.AddUnique(Vehicle);
+	}
+}
+
+void APrvVehicleFleetManager::UnregisterSignificance(UPrvVehicleMovementComponent* Vehicle)
+{
+	if (SignificanceVehicles.Remove(Vehicle) > 0)
+	{
+		Vehicle->WheelLod = EPrvWheelLod::Full;
+	}
+}
+
+bool APrvVehicleFleetManager::IsTraceBudgetEnabled()
+{
+	return GPrvVehicleSuspensionTraceBudget > 0;
+}
+
+void APrvVehicleFleetManager::RegisterTraceBudget(UPrvVehicleMovementComponent* Vehicle)
+{
+	if (Vehicle)
+	{
+		BudgetVehicles.AddUnique(Vehicle);
+
+		// Budget is granted by manager tick, so vehicles ticking themselves should go after it
+		Vehicle->PrimaryComponentTick.AddPrerequisite(this, PrimaryActorTick);
+	}
+}
+
+void APrvVehicleFleetManager::UnregisterTraceBudget(UPrvVehicleMovementComponent* Vehicle)
+{
+	if (BudgetVehicles.Remove(Vehicle) > 0)
+	{
+		Vehicle->PrimaryComponentTick.RemovePrerequisite(this, PrimaryActorTick);
+		Vehicle->bTraceBudgetStarved = false;
+	}
+}
+
+void APrvVehicleFleetManager::BeginPlay()
+{
+	Super::BeginPlay();
+
+	const UPrvVehicleSettings* Settings = GetDefault<UPrvVehicleSettings>();
+	if (Settings->bPoolWheelEffects && GetNetMode() != NM_DedicatedServer)
+	{
+		const int32 PrewarmNum = FMath::Min(Settings->WheelEffectPoolPrewarm, Settings->WheelEffectPoolSize);
+		for (int32 i = FreeWheelEffects.Num(); i < PrewarmNum; ++i)
+		{
+			FreeWheelEffects.Add(SpawnWheelEffect());
+		}
+	}
+}
+
+void APrvVehicleFleetManager::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// Writer thread flushes the rest of records
+	TelemetryWriter.Reset();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void APrvVehicleFleetManager::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	UpdateSignificance();
+	UpdateTraceBudget();
+	TickVehicles(DeltaSeconds);
+}
+
+void APrvVehicleFleetManager::UpdateSignificance()
+{
+	PRV_CYCLE_COUNTER(STAT_PrvFleetUpdateSignificance);
+
+	SignificanceVehicles.RemoveAll([](const UPrvVehicleMovementComponent* Vehicle) { return (Vehicle == nullptr) || Vehicle->IsPendingKill(); });
+
+	if (SignificanceVehicles.Num() == 0)
+	{
+		return;
+	}
+
+	const UPrvVehicleSettings* Settings = GetDefault<UPrvVehicleSettings>();
+	const APlayerCameraManager* CameraManager = UGameplayStatics::GetPlayerCameraManager(this, 0);
+
+	const FVector CameraLocation = CameraManager ? CameraManager->GetCameraLocation() : FVector::ZeroVector;
+	const float ViewScale = CameraManager ? FMath::Tan(FMath::DegreesToRadians(FMath::Max(CameraManager->GetFOVAngle(), 1.f) * 0.5f)) : 1.f;
+
+	int32 TierCounts[(int32)EPrvWheelLod::MAX] = { 0 };
+	RankedVehicles.Reset();
+
+	for (UPrvVehicleMovementComponent* Vehicle : SignificanceVehicles)
+	{
+		// Vehicles simulated locally always trace everything
+		if (!Settings->bEnableWheelSignificance || !CameraManager || !Vehicle->UpdatedMesh || Vehicle->ShouldAddForce())
+		{
+			Vehicle->WheelLod = EPrvWheelLod::Full;
+			continue;
+		}
+
+		FRankedVehicle RankedVehicle;
+		RankedVehicle.Vehicle = Vehicle;
+		RankedVehicle.Distance = FVector::Dist(CameraLocation, Vehicle->UpdatedMesh->Bounds.Origin);
+		RankedVehicle.Significance = Vehicle->UpdatedMesh->Bounds.SphereRadius / FMath::Max(RankedVehicle.Distance * ViewScale, 1.f);
+
+		const AActor* Owner = Vehicle->GetOwner();
+		if (Owner && !Owner->WasRecentlyRendered(Settings->RecentlyRenderedTolerance))
+		{
+			RankedVehicle.Significance *= Settings->NotRenderedSignificanceScale;
+		}
+
+		RankedVehicles.Add(RankedVehicle);
+	}
+
+	RankedVehicles.Sort([](const FRankedVehicle& A, const FRankedVehicle& B) { return A.Significance > B.Significance; });
+
+	const int32 TierBudgets[] = { Settings->MaxFullTierVehicles, Settings->MaxLineTraceTierVehicles, Settings->MaxInterleavedTierVehicles };
+	const float TierMaxDistances[] = { Settings->FullTierMaxDistance, Settings->LineTraceTierMaxDistance, Settings->InterleavedTierMaxDistance };
+
+	// The most significant vehicles take the best tier that has budget left and covers their distance
+	for (const FRankedVehicle& RankedVehicle : RankedVehicles)
+	{
+		int32 Tier = 0;
+		while (Tier < (int32)EPrvWheelLod::Frozen && (TierCounts[Tier] >= TierBudgets[Tier] || RankedVehicle.Distance > TierMaxDistances[Tier]))
+		{
+			++Tier;
+		}
+
+		RankedVehicle.Vehicle->WheelLod = (EPrvWheelLod)Tier;
+		++TierCounts[Tier];
+	}
+
+	// Not ranked vehicles are counted as full
+	TierCounts[(int32)EPrvWheelLod::Full] += SignificanceVehicles.Num() - RankedVehicles.Num();
+
+	SET_DWORD_STAT(STAT_PrvWheelLodFull, TierCounts[(int32)EPrvWheelLod::Full]);
+	SET_DWORD_STAT(STAT_PrvWheelLodLineTrace, TierCounts[(int32)EPrvWheelLod::LineTrace]);
+	SET_DWORD_STAT(STAT_PrvWheelLodInterleaved, TierCounts[(int32)EPrvWheelLod::Interleaved]);
+	SET_DWORD_STAT(STAT_PrvWheelLodFrozen, TierCounts[(int32)EPrvWheelLod::Frozen]);
+}
+
+void APrvVehicleFleetManager::UpdateTraceBudget()
+{
+	PRV_CYCLE_COUNTER(STAT_PrvFleetUpdateTraceBudget);
+
+	BudgetVehicles.RemoveAll([](const UPrvVehicleMovementComponent* Vehicle) { return (Vehicle == nullptr) || Vehicle->IsPendingKill(); });
+
+	if (GPrvVehicleSuspensionTraceBudget <= 0)
+	{
+		for (UPrvVehicleMovementComponent* Vehicle : BudgetVehicles)
+		{
+			Vehicle->bTraceBudgetStarved = false;
+		}
+
+		return;
+	}
+
+	// Local players on client, all players on server
+	BudgetViewLocations.Reset();
+	for (TActorIterator<APlayerController> It(GetWorld()); It; ++It)
+	{
+		FVector ViewLocation;
+		FRotator ViewRotation;
+		It->GetPlayerViewPoint(ViewLocation, ViewRotation);
+		BudgetViewLocations.Add(ViewLocation);
+	}
+
+	BudgetedVehicles.Reset();
+
+	for (UPrvVehicleMovementComponent* Vehicle : BudgetVehicles)
+	{
+		FBudgetedVehicle BudgetedVehicle;
+		BudgetedVehicle.Vehicle = Vehicle;
+		BudgetedVehicle.TraceCost = Vehicle->GetSuspensionTraceCost();
+
+		if (BudgetedVehicle.TraceCost <= 0)
+		{
+			Vehicle->bTraceBudgetStarved = false;
+			continue;
+		}
+
+		// Player-controlled vehicles go first, the rest are ordered by distance to the closest view
+		const APawn* Pawn = Cast<APawn>(Vehicle->GetOwner());
+		if (Pawn && Pawn->IsPlayerControlled())
+		{
+			BudgetedVehicle.Priority = -1.f;
+		}
+		else
+		{
+			BudgetedVehicle.Priority = (BudgetViewLocations.Num() > 0) ? MAX_flt : 0.f;
+			for (const FVector& ViewLocation : BudgetViewLocations)
+			{
+				BudgetedVehicle.Priority = FMath::Min(BudgetedVehicle.Priority, FVector::DistSquared(ViewLocation, Vehicle->UpdatedMesh->Bounds.Origin));
+			}
+
+			// Starved vehicles move up each frame, so far ones are not starved forever
+			BudgetedVehicle.Priority /= FMath::Square(1.f + Vehicle->TraceBudgetStarvedStreak);
+		}
+
+		BudgetedVehicles.Add(BudgetedVehicle);
+	}
+
+	BudgetedVehicles.Sort([](const FBudgetedVehicle& A, const FBudgetedVehicle& B) { return A.Priority < B.Priority; });
+
+	// Vehicle gets traces for all its wheels or none of them, player-controlled vehicles are never starved
+	int32 TracesLeft = GPrvVehicleSuspensionTraceBudget;
+	int32 NumStarved = 0;
+
+	for (const FBudgetedVehicle& BudgetedVehicle : BudgetedVehicles)
+	{
+		UPrvVehicleMovementComponent* Vehicle = BudgetedVehicle.Vehicle;
+		Vehicle->bTraceBudgetStarved = (BudgetedVehicle.Priority >= 0.f) && (BudgetedVehicle.TraceCost > TracesLeft);
+
+		++Vehicle->TraceBudgetFrames;
+		if (Vehicle->bTraceBudgetStarved)
+		{
+			++Vehicle->TraceBudgetStarvedFrames;
+			++Vehicle->TraceBudgetStarvedStreak;
+			++NumStarved;
+		}
+		else
+		{
+			Vehicle->TraceBudgetStarvedStreak = 0;
+			TracesLeft -= BudgetedVehicle.TraceCost;
+		}
+	}
+
+	SET_DWORD_STAT(STAT_PrvTraceBudgetGranted, GPrvVehicleSuspensionTraceBudget - TracesLeft);
+	SET_DWORD_STAT(STAT_PrvTraceBudgetStarved, NumStarved);
+}
+
+UParticleSystemComponent* APrvVehicleFleetManager::SpawnWheelEffect()
+{
+	UParticleSystemComponent* Effect = NewObject<UParticleSystemComponent>(this);
+	Effect->bAutoActivate = false;
+	Effect->bAutoDestroy = false;
+	Effect->RegisterComponentWithWorld(GetWorld());
+
+	INC_DWORD_STAT(STAT_PrvWheelEffectsSpawned);
+
+	return Effect;
+}
+
+UParticleSystemComponent* APrvVehicleFleetManager::AcquireWheelEffect(UParticleSystem* Template, USceneComponent* AttachParent, FName SocketName, const FVector& SocketOffset)
+{
+	FreeWheelEffects.RemoveAll([](const UParticleSystemComponent* Effect) { return (Effect == nullptr) || Effect->IsPendingKill(); });
+
+	UParticleSystemComponent* Effect = nullptr;
+
+	// Same template doesn't require emitters to be recreated
+	int32 EffectIndex = FreeWheelEffects.IndexOfByPredicate([Template](const UParticleSystemComponent* FreeEffect) { return FreeEffect->Template == Template; });
+	if (EffectIndex == INDEX_NONE)
+	{
+		EffectIndex = FreeWheelEffects.Num() - 1;
+	}
+
+	if (EffectIndex != INDEX_NONE)
+	{
+		Effect = FreeWheelEffects[EffectIndex];
+		FreeWheelEffects.RemoveAtSwap(EffectIndex);
+
+		INC_DWORD_STAT(STAT_PrvWheelEffectsRecycled);
+	}
+	else
+	{
+		Effect = SpawnWheelEffect();
+
+		INC_DWORD_STAT(STAT_PrvWheelEffectPoolMisses);
+	}
+
+	// Effect stays owned by manager, so it isn't destroyed with the vehicle while it's finishing
+	Effect->AttachToComponent(AttachParent, FAttachmentTransformRules::SnapToTargetIncludingScale, SocketName);
+	Effect->SetRelativeLocation(SocketOffset);
+
+	if (Template && Effect->Template != Template)
+	{
+		Effect->SetTemplate(Template);
+	}
+
+	SET_DWORD_STAT(STAT_PrvWheelEffectPoolFree, FreeWheelEffects.Num());
+
+	return Effect;
+}
+
+void APrvVehicleFleetManager::ReleaseWheelEffect(UParticleSystemComponent* Effect)
+{
+	if (Effect == nullptr || Effect->IsPendingKill())
+	{
+		return;
+	}
+
+	// Particles still alive are finished in place
+	if (Effect->Template && !Effect->bWasCompleted && (Effect->IsActive() || Effect->bWasDeactivated))
+	{
+		Effect->OnSystemFinished.AddUniqueDynamic(this, &APrvVehicleFleetManager::OnWheelEffectFinished);
+		Effect->Deactivate();
+	}
+	else
+	{
+		OnWheelEffectFinished(Effect);
+	}
+}
+
+void APrvVehicleFleetManager::OnWheelEffectFinished(UParticleSystemComponent* Effect)
+{
+	Effect->OnSystemFinished.RemoveDynamic(this, &APrvVehicleFleetManager::OnWheelEffectFinished);
+
+	if (FreeWheelEffects.Num() >= GetDefault<UPrvVehicleSettings>()->WheelEffectPoolSize || IsPendingKillPending())
+	{
+		Effect->DestroyComponent();
+		return;
+	}
+
+	Effect->DetachFromComponent(FDetachmentTransformRules::KeepWorldTransform);
+
+	FreeWheelEffects.Add(Effect);
+
+	SET_DWORD_STAT(STAT_PrvWheelEffectPoolFree, FreeWheelEffects.Num());
+}
+
+bool APrvVehicleFleetManager::IsTelemetryEnabled()
+{
+	return GPrvVehicleTelemetrySampleRate > 0.f;
+}
+
+uint32 APrvVehicleFleetManager::RegisterTelemetry()
+{
+	if (bTelemetryFailed || !IsTelemetryEnabled() || FMath::FRand() >= GPrvVehicleTelemetrySampleRate)
+	{
+		return 0;
+	}
+
+	return NextTelemetryVehicleId++;
+}
+
+void APrvVehicleFleetManager::RecordTelemetry(const FPrvTelemetryRecord& Record)
+{
+	if (!TelemetryWriter.IsValid())
+	{
+		if (bTelemetryFailed)
+		{
+			return;
+		}
+
+#if ENGINE_MINOR_VERSION >= 18
+		const FString SavedDir = FPaths::ProjectSavedDir();
+#else
+		const FString SavedDir = FPaths::GameSavedDir();
+#endif
+		// Several worlds can record at once (PIE server and clients), so each one has its own file
+		FString WorldName;
+		switch (GetNetMode())
+		{
+		case NM_DedicatedServer:
+			WorldName = TEXT("Server");
+			break;
+		case NM_ListenServer:
+			WorldName = TEXT("ListenServer");
+			break;
+		case NM_Client:
+			WorldName = TEXT("Client");
+			break;
+		default:
+			WorldName = TEXT("Standalone");
+			break;
+		}
+
+		const int32 PIEInstanceID = GetWorld()->GetOutermost()->PIEInstanceID;
+		if (PIEInstanceID != INDEX_NONE)
+		{
+			WorldName += FString::Printf(TEXT("-PIE%d"), PIEInstanceID);
+		}
+
+		const FString BaseFilename = SavedDir / TEXT("Telemetry") / FString::Printf(TEXT("PrvVehicle_%s_%s_%s"),
+			*UWorld::RemovePIEPrefix(GetWorld()->GetMapName()), *WorldName, *FDateTime::Now().ToString(TEXT("%Y%m%d-%H%M%S")));
+
+		// Don't truncate the file of another world started within the same second
+		FString Filename = BaseFilename + TEXT(".prvt");
+		for (int32 Suffix = 1; IFileManager::Get().FileSize(*Filename) >= 0; ++Suffix)
+		{
+			Filename = FString::Printf(TEXT("%s_%d.prvt"), *BaseFilename, Suffix);
+		}
+
+		TelemetryWriter = MakeUnique<FPrvTelemetryWriter>();
+		if (!TelemetryWriter->Open(Filename, 4096, (int64)GPrvVehicleTelemetryMaxFileSizeMB * 1024 * 1024))
+		{
+			TelemetryWriter.Reset();
+			bTelemetryFailed = true;
+			return;
+		}
+
+		UE_LOG(LogPrvVehicle, Log, TEXT("Recording vehicle telemetry to %s"), *Filename);
+	}
+
+	if (TelemetryWriter->Push(Record))
+	{
+		INC_DWORD_STAT(STAT_PrvTelemetryRecords);
+	}
+}
+
+void APrvVehicleFleetManager::TickVehicles(float DeltaSeconds)
+{
+	PRV_CYCLE_COUNTER(STAT_PrvFleetTick);
+
+	Vehicles.RemoveAll([](const UPrvVehicleMovementComponent* Vehicle) { return (Vehicle == nullptr) || Vehicle->IsPendingKill(); });
+
+	DeferredVehicles.Reset();
+	DeferredDeltaTimes.Reset();
+
+	// Phase 1: input, sleeping and suspension traces (game thread)
+	{
+		PRV_CYCLE_COUNTER(STAT_PrvFleetPreSimulate);
+
+		for (UPrvVehicleMovementComponent* Vehicle : Vehicles)
+		{
+			const AActor* Owner = Vehicle->GetOwner();
+			const float DeltaTime = DeltaSeconds * (Owner ? Owner->CustomTimeDilation : 1.f);
+
+			if (Vehicle->IsActive() && Vehicle->PreSimulate(DeltaTime, true))
+			{
+				DeferredVehicles.Add(Vehicle);
+				DeferredDeltaTimes.Add(DeltaTime);
+			}
+		}
+	}
+
+	// Phase 2: pure-math dynamics, body modifications are buffered (worker threads)
+	{
+		PRV_CYCLE_COUNTER(STAT_PrvFleetSimulateDeferred);
+
+		ParallelFor(DeferredVehicles.Num(), [this](int32 Index)
+		{
+			DeferredVehicles[Index]->SimulateDeferred(DeferredDeltaTimes[Index]);
+		}, (GPrvVehicleFleetParallel == 0));
+	}
+
+	// Phase 3: forces, wheels animation and effects (game thread)
+	{
+		PRV_CYCLE_COUNTER(STAT_PrvFleetPostSimulate);
+
+		for (UPrvVehicleMovementComponent* Vehicle : Vehicles)
+		{
+			if (Vehicle->IsActive())
+			{
+				const AActor* Owner = Vehicle->GetOwner();
+				Vehicle->PostSimulate(DeltaSeconds * (Owner ? Owner->CustomTimeDilation : 1.f));
+			}
+		}
+	}
+
+	SET_DWORD_STAT(STAT_PrvFleetVehicles, Vehicles.Num());
+	SET_DWORD_STAT(STAT_PrvFleetDeferredVehicles, DeferredVehicles.Num());
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Benchmark
+
+/** Headless vehicle used to measure fleet scaling without spawning actors */
+struct FPrvBenchmarkVehicle
+{
+	TArray<FPrvWheelSetup> Wheels;
+	TArray<FPrvWheelContact> Contacts;
+	FPrvSimpleRigidBody Body;
+	FPrvTrackDrive LeftTrack;
+	FPrvTrackDrive RightTrack;
+	int32 ActiveWheelsNum;
+
+	FPrvBenchmarkVehicle()
+		: ActiveWheelsNum(0)
+	{
+	}
+
+	void Init(int32 NumWheelsPerSide, float Offset)
+	{
+		for (int32 Side = 0; Side < 2; ++Side)
+		{
+			for (int32 i = 0; i < NumWheelsPerSide; ++i)
+			{
+				FPrvWheelSetup Wheel;
+				Wheel.Location = FVector(-250.f + 500.f * i / FMath::Max(1, NumWheelsPerSide - 1), (Side == 0) ? -150.f : 150.f, 0.f);
+				Wheels.Add(Wheel);
+			}
+		}
+
+		Contacts.SetNum(Wheels.Num());
+		Body.Mass = 30000.f;
+		Body.Inertia = 30000.f * 100.f * 100.f;
+		Body.Transform.SetLocation(FVector(Offset, 0.f, 60.f));
+	}
+
+	void Step(const FPrvSuspensionSettings& SuspensionSettings, const FPrvFrictionSettings& FrictionSettings, const FPrvFlatGroundQuery& Ground, float DeltaTime)
+	{
+		ActiveWheelsNum = FPrvVehicleSimulation::UpdateSuspension(SuspensionSettings, Wheels, Contacts, Ground, Body, false, ActiveWheelsNum, DeltaTime);
+
+		FPrvFrictionBodyState BodyState;
+		BodyState.Rotation = Body.Transform.GetRotation();
+		BodyState.Mass = Body.Mass;
+		BodyState.NumWheels = Wheels.Num();
+		BodyState.ActiveFrictionPoints = ActiveWheelsNum;
+		BodyState.ActiveDrivenFrictionPoints = ActiveWheelsNum;
+
+		LeftTrack.KineticFrictionTorque = LeftTrack.RollingFrictionTorque = 0.f;
+		RightTrack.KineticFrictionTorque = RightTrack.RollingFrictionTorque = 0.f;
+
+		for (int32 WheelIndex = 0; WheelIndex < Wheels.Num(); ++WheelIndex)
+		{
+			const FPrvWheelContact& Contact = Contacts[WheelIndex];
+			if (!Contact.bTouchedGround)
+			{
+				continue;
+			}
+
+			FPrvWheelFrictionInput WheelInput;
+			WheelInput.WheelDirection = BodyState.Rotation.GetForwardVector();
+			WheelInput.WheelCollisionNormal = Contact.ImpactNormal;
+			WheelInput.SuspensionForce = Contact.SuspensionForce;
+			WheelInput.WheelPointVelocity = Body.GetLinearVelocityAtPoint(Contact.ImpactPoint);
+
+			FPrvTrackDrive& Track = (Wheels[WheelIndex].Location.Y > 0.f) ? RightTrack : LeftTrack;
+			const FPrvWheelFrictionResult Friction = FPrvVehicleSimulation::CalculateWheelFriction(FrictionSettings, BodyState, Track, WheelInput, DeltaTime);
+			Body.AddForceAtLocation(Friction.ApplicationForce, Contact.ImpactPoint);
+		}
+
+		// Drivetrain on the first gear with full throttle
+		const float HullAngularSpeed = (LeftTrack.AngularSpeed + RightTrack.AngularSpeed) / 2.f;
+		const float EngineRPM = FPrvVehicleSimulation::CalculateEngineRPM(2.f, 3.5f, HullAngularSpeed, 600.f, 2800.f);
+		const float EngineTorque = (EngineRPM < 2800.f) ? 80000.f : 0.f;
+		const float DriveTorque = FPrvVehicleSimulation::CalculateDriveTorque(EngineTorque, 2.f, 3.5f, 0.9f, false, 1.f);
+
+		const float TrackInertia = 0.5f * FrictionSettings.SprocketMass * FMath::Square(FrictionSettings.SprocketRadius) + FrictionSettings.TrackMass * FMath::Square(FrictionSettings.SprocketRadius);
+		LeftTrack.AngularSpeed += (DriveTorque / 2.f + LeftTrack.KineticFrictionTorque + LeftTrack.RollingFrictionTorque) / TrackInertia * DeltaTime;
+		RightTrack.AngularSpeed += (DriveTorque / 2.f + RightTrack.KineticFrictionTorque + RightTrack.RollingFrictionTorque) / TrackInertia * DeltaTime;
+		LeftTrack.LinearSpeed = LeftTrack.AngularSpeed * FrictionSettings.SprocketRadius;
+		RightTrack.LinearSpeed = RightTrack.AngularSpeed * FrictionSettings.SprocketRadius;
+
+		Body.Integrate(DeltaTime);
+	}
+};
+
+static double PrvRunFleetBenchmark(TArray<FPrvBenchmarkVehicle>& Fleet, int32 Iterations, bool bParallel)
+{
+	const FPrvSuspensionSettings SuspensionSettings;
+	const FPrvFrictionSettings FrictionSettings;
+	const FPrvFlatGroundQuery Ground(0.f);
+	const float DeltaTime = 1.f / 30.f;
+
+	const double StartTime = FPlatformTime::Seconds();
+	for (int32 i = 0; i < Iterations; ++i)
+	{
+		ParallelFor(Fleet.Num(), [&](int32 Index)
+		{
+			Fleet[Index].Step(SuspensionSettings, FrictionSettings, Ground, DeltaTime);
+		}, !bParallel);
+	}
+
+	return (FPlatformTime::Seconds() - StartTime) / Iterations;
+}
+
+static void PrvBenchmarkFleet(const TArray<FString>& Args)
+{
+	const int32 MaxVehicles = (Args.Num() > 0) ? FMath::Max(1, FCString::Atoi(*Args[0])) : 1000;
+	const int32 Iterations = (Args.Num() > 1) ? FMath::Max(1, FCString::Atoi(*Args[1])) : 100;
+	const int32 NumWheelsPerSide = 8;
+
+	UE_LOG(LogPrvVehicle, Log, TEXT("Fleet benchmark: %d wheels per vehicle, %d iterations, %d worker threads"),
+		NumWheelsPerSide * 2, Iterations, FTaskGraphInterface::Get().GetNumWorkerThreads());
+
+	// 1, 10, 100 .. MaxVehicles
+	TArray<int32> FleetSizes;
+	for (int32 NumVehicles = 1; NumVehicles < MaxVehicles; NumVehicles *= 10)
+	{
+		FleetSizes.Add(NumVehicles);
+	}
+	FleetSizes.Add(MaxVehicles);
+
+	for (const int32 NumVehicles : FleetSizes)
+	{
+		TArray<FPrvBenchmarkVehicle> Fleet;
+		Fleet.SetNum(NumVehicles);
+		for (int32 i = 0; i < NumVehicles; ++i)
+		{
+			Fleet[i].Init(NumWheelsPerSide, i * 1000.f);
+		}
+
+		// Both runs start from the same state
+		TArray<FPrvBenchmarkVehicle> ParallelFleet = Fleet;
+
+		const double SerialTime = PrvRunFleetBenchmark(Fleet, Iterations, false);
+		const double ParallelTime = PrvRunFleetBenchmark(ParallelFleet, Iterations, true);
+
+		UE_LOG(LogPrvVehicle, Log, TEXT("Fleet benchmark (%4d vehicles): serial %.3f ms, parallel %.3f ms per tick, speedup x%.2f"),
+			NumVehicles, SerialTime * 1000.0, ParallelTime * 1000.0, (ParallelTime > 0.0) ? (SerialTime / ParallelTime) : 0.0);
+	}
+}
+
+static FAutoConsoleCommandWithArgs PrvBenchmarkFleetCommand(
+	TEXT("PrvVehicle.BenchmarkFleet"),
+	TEXT("Measures headless vehicle dynamics for 1..N vehicles ticked serially and in parallel. Usage: PrvVehicle.BenchmarkFleet [MaxVehicles] [Iterations]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&PrvBenchmarkFleet));
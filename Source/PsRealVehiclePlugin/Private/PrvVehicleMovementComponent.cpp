@@ -2,11 +2,18 @@
 
 #include "PrvPlugin.h"
 
+#include "PrvBakedCurveCache.h"
+#include "PrvVehicleFleetManager.h"
+
 #include "DrawDebugHelpers.h"
 #include "Kismet/GameplayStatics.h"
 #include "Kismet/KismetMathLibrary.h"
 #include "Kismet/KismetSystemLibrary.h"
+#include "LandscapeDataAccess.h"
+#include "LandscapeHeightfieldCollisionComponent.h"
 #include "PhysicsEngine/PhysicsSettings.h"
+#include "PhysXPublic.h"
+#include "UObject/UObjectIterator.h"
 
 #include "Runtime/Launch/Resources/Version.h"
 
@@ -20,6 +27,62 @@ DECLARE_CYCLE_STAT(TEXT("Update Suspension"), STAT_PrvMovementUpdateSuspension,
 DECLARE_CYCLE_STAT(TEXT("Update Suspension Visuals Only"), STAT_PrvMovementUpdateSuspensionVisualsOnly, STATGROUP_MovementPhysics);
 DECLARE_CYCLE_STAT(TEXT("Update Friction"), STAT_PrvMovementUpdateFriction, STATGROUP_MovementPhysics);
 DECLARE_CYCLE_STAT(TEXT("Update Wheel Effects"), STAT_PrvMovementUpdateWheelEffects, STATGROUP_MovementPhysics);
+DECLARE_CYCLE_STAT(TEXT("Update Fixed Timestep"), STAT_PrvMovementUpdateFixedTimestep, STATGROUP_MovementPhysics);
+DECLARE_CYCLE_STAT(TEXT("Is Sleeping"), STAT_PrvMovementIsSleeping, STATGROUP_MovementPhysics);
+DECLARE_CYCLE_STAT(TEXT("Update Tracks Velocity"), STAT_PrvMovementUpdateTracksVelocity, STATGROUP_MovementPhysics);
+DECLARE_CYCLE_STAT(TEXT("Update Hull Velocity"), STAT_PrvMovementUpdateHullVelocity, STATGROUP_MovementPhysics);
+DECLARE_CYCLE_STAT(TEXT("Update Drive Force"), STAT_PrvMovementUpdateDriveForce, STATGROUP_MovementPhysics);
+DECLARE_CYCLE_STAT(TEXT("Update Linear Velocity"), STAT_PrvMovementUpdateLinearVelocity, STATGROUP_MovementPhysics);
+DECLARE_CYCLE_STAT(TEXT("Update Angular Velocity"), STAT_PrvMovementUpdateAngularVelocity, STATGROUP_MovementPhysics);
+DECLARE_CYCLE_STAT(TEXT("Update Anti Rollover"), STAT_PrvMovementUpdateAntiRollover, STATGROUP_MovementPhysics);
+DECLARE_CYCLE_STAT(TEXT("Animate Wheels"), STAT_PrvMovementAnimateWheels, STATGROUP_MovementPhysics);
+DECLARE_CYCLE_STAT(TEXT("Network Correction"), STAT_PrvMovementNetworkCorrection, STATGROUP_MovementPhysics);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Async Suspension Traces"), STAT_PrvMovementAsyncTraces, STATGROUP_MovementPhysics);
+DECLARE_CYCLE_STAT(TEXT("Update Landscape Ground"), STAT_PrvMovementUpdateLandscapeGround, STATGROUP_MovementPhysics);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Async Suspension Traces Offloaded (ms)"), STAT_PrvMovementAsyncTracesOffloadedTime, STATGROUP_MovementPhysics);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Landscape Ground Samples"), STAT_PrvMovementLandscapeSamples, STATGROUP_MovementPhysics);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Contact Cache Hits"), STAT_PrvMovementContactCacheHits, STATGROUP_MovementPhysics);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Contact Cache Misses"), STAT_PrvMovementContactCacheMisses, STATGROUP_MovementPhysics);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Input Packets Sent"), STAT_PrvInputPacketsSent, STATGROUP_MovementPhysics);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Input Bytes Sent"), STAT_PrvInputBytesSent, STATGROUP_MovementPhysics);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Input Packets Received"), STAT_PrvInputPacketsReceived, STATGROUP_MovementPhysics);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Input Packets Dropped"), STAT_PrvInputPacketsDropped, STATGROUP_MovementPhysics);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Input Packets Keep-Alive"), STAT_PrvInputPacketsKeepAlive, STATGROUP_MovementPhysics);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Prediction Corrections"), STAT_PrvPredictionCorrections, STATGROUP_MovementPhysics);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Snapshot Correction (cm)"), STAT_PrvSnapshotCorrection, STATGROUP_MovementPhysics);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Snapshot Starved Vehicles"), STAT_PrvSnapshotStarved, STATGROUP_MovementPhysics);
+
+// Per net role counters
+DECLARE_DWORD_COUNTER_STAT(TEXT("Vehicles Ticked (Authority)"), STAT_PrvVehiclesTickedAuthority, STATGROUP_MovementPhysics);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Vehicles Ticked (Autonomous)"), STAT_PrvVehiclesTickedAutonomous, STATGROUP_MovementPhysics);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Vehicles Ticked (Simulated)"), STAT_PrvVehiclesTickedSimulated, STATGROUP_MovementPhysics);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Suspension Traces (Authority)"), STAT_PrvSuspensionTracesAuthority, STATGROUP_MovementPhysics);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Suspension Traces (Autonomous)"), STAT_PrvSuspensionTracesAutonomous, STATGROUP_MovementPhysics);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Suspension Traces (Simulated)"), STAT_PrvSuspensionTracesSimulated, STATGROUP_MovementPhysics);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Suspension Hits (Authority)"), STAT_PrvSuspensionHitsAuthority, STATGROUP_MovementPhysics);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Suspension Hits (Autonomous)"), STAT_PrvSuspensionHitsAutonomous, STATGROUP_MovementPhysics);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Suspension Hits (Simulated)"), STAT_PrvSuspensionHitsSimulated, STATGROUP_MovementPhysics);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Forces Applied (Authority)"), STAT_PrvForcesAppliedAuthority, STATGROUP_MovementPhysics);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Forces Applied (Autonomous)"), STAT_PrvForcesAppliedAutonomous, STATGROUP_MovementPhysics);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Forces Applied (Simulated)"), STAT_PrvForcesAppliedSimulated, STATGROUP_MovementPhysics);
+
+/** Increment counter declared for each net role (Authority, Autonomous, Simulated) */
+#if STATS
+	#define PRV_INC_ROLE_STAT_BY(Role, Stat, Amount) \
+		switch (Role) \
+		{ \
+		case ROLE_Authority: INC_DWORD_STAT_BY(Stat##Authority, Amount); break; \
+		case ROLE_AutonomousProxy: INC_DWORD_STAT_BY(Stat##Autonomous, Amount); break; \
+		default: INC_DWORD_STAT_BY(Stat##Simulated, Amount); break; \
+		}
+#else
+	#define PRV_INC_ROLE_STAT_BY(Role, Stat, Amount)
+#endif
+
+/** Build PrvVehicle.BenchmarkSuspension with suspension code as it was before the shared kernel to compare against (never used by simulation) */
+#ifndef PRV_BENCHMARK_LEGACY_SUSPENSION
+	#define PRV_BENCHMARK_LEGACY_SUSPENSION 0
+#endif
 
 static int32 GPrvVehicleShowDustEffect = 0;
 static FAutoConsoleVariableRef CVarPrvVehicleShowDustEffect(
@@ -33,6 +96,129 @@ static FAutoConsoleVariableRef CVarPrvVehicleShowDustEffectForOwnerOnly(
 	GPrvVehicleShowDustEffectForOwnerOnly, 
 	TEXT("Only owner can see its own wheels dust effect"));
 
+static float GPrvVehicleDustEffectLocationTolerance = 2.f;
+static FAutoConsoleVariableRef CVarPrvVehicleDustEffectLocationTolerance(
+	TEXT("PrvVehicle.DustEffectLocationTolerance"),
+	GPrvVehicleDustEffectLocationTolerance,
+	TEXT("Dust effect is moved only when wheel contact shifts relative to vehicle body by this distance [cm]"));
+
+static float GPrvVehicleDustEffectRotationTolerance = 2.f;
+static FAutoConsoleVariableRef CVarPrvVehicleDustEffectRotationTolerance(
+	TEXT("PrvVehicle.DustEffectRotationTolerance"),
+	GPrvVehicleDustEffectRotationTolerance,
+	TEXT("Dust effect is rotated only when wheel contact normal changes by this angle [deg]"));
+
+static const FName NAME_PrvSuspensionTrace(TEXT("PrvSuspensionTrace"));
+
+/** Average game thread cost of one blocking suspension trace (used to estimate time saved by async traces) */
+static float GPrvAverageSyncTraceMs = 0.f;
+
+static void PrvRegisterSyncTraceCycles(uint32 TraceCycles)
+{
+	const float TraceMs = FPlatformTime::ToMilliseconds(TraceCycles);
+	GPrvAverageSyncTraceMs = (GPrvAverageSyncTraceMs > 0.f) ? FMath::Lerp(GPrvAverageSyncTraceMs, TraceMs, 0.05f) : TraceMs;
+}
+
+/**
+ * Wheel contact with the ground plane: sphere is put onto the plane, line hit is left for the caller to convert
+ * @return false if the plane is out of suspension range
+ */
+static bool PrvWheelPlaneContact(const FVector& PlanePoint, const FVector& PlaneNormal, const FVector& SuspWorldLocation, const FVector& SuspUpVector, 
+	float TraceLength, float Radius, bool bLineTrace, FHitResult& OutHit)
+{
+	const float NormalUp = FVector::DotProduct(PlaneNormal, SuspUpVector);
+	if (NormalUp < KINDA_SMALL_NUMBER)
+	{
+		return false;
+	}
+
+	// Distance from suspension origin to the plane along suspension axis
+	const float AxisDistance = FVector::DotProduct(SuspWorldLocation - PlanePoint, PlaneNormal) / NormalUp;
+
+	if (bLineTrace)
+	{
+		// Line is traced from one radius above suspension to one radius below its end
+		if (AxisDistance < -Radius || AxisDistance > TraceLength + Radius)
+		{
+			return false;
+		}
+
+		OutHit.ImpactPoint = SuspWorldLocation - SuspUpVector * AxisDistance;
+		OutHit.Location = OutHit.ImpactPoint;
+	}
+	else
+	{
+		const float SphereDistance = FMath::Max(0.f, AxisDistance - Radius / NormalUp);
+		if (SphereDistance > TraceLength)
+		{
+			return false;
+		}
+
+		OutHit.Distance = SphereDistance;
+		OutHit.Location = SuspWorldLocation - SuspUpVector * SphereDistance;
+		OutHit.ImpactPoint = OutHit.Location - PlaneNormal * Radius;
+	}
+
+	OutHit.ImpactNormal = PlaneNormal;
+	OutHit.Normal = PlaneNormal;
+
+	return true;
+}
+
+#if WITH_PHYSX
+/** Sample landscape collision heightfield at world location (component Z axis), returns false outside of the component or over a hole */
+static bool PrvSampleLandscapeHeightfield(const ULandscapeHeightfieldCollisionComponent* LandscapeComponent, const FVector& WorldLocation, FVector& OutPoint, FVector& OutNormal, UPhysicalMaterial*& OutPhysMaterial)
+{
+	const FHeightfieldGeometryRef* HeightfieldRef = LandscapeComponent->HeightfieldRef.GetReference();
+	const physx::PxHeightField* HeightField = HeightfieldRef ? HeightfieldRef->RBHeightfield : nullptr;
+	if (!HeightField || LandscapeComponent->CollisionScale <= 0.f)
+	{
+		return false;
+	}
+
+	// Heightfield rows go along component X and columns along Y, one sample per collision quad
+	const FTransform& ComponentTransform = LandscapeComponent->GetComponentTransform();
+	const FVector LocalLocation = ComponentTransform.InverseTransformPosition(WorldLocation);
+	const float MaxRow = (float)(HeightField->getNbRows() - 1);
+	const float MaxColumn = (float)(HeightField->getNbColumns() - 1);
+	const float Row = LocalLocation.X / LandscapeComponent->CollisionScale;
+	const float Column = LocalLocation.Y / LandscapeComponent->CollisionScale;
+	if (Row < 0.f || Row > MaxRow || Column < 0.f || Column > MaxColumn || MaxRow < 1.f || MaxColumn < 1.f)
+	{
+		return false;
+	}
+
+	const uint32 RowIndex = (uint32)FMath::Min(FMath::FloorToInt(Row), (int32)MaxRow - 1);
+	const uint32 ColumnIndex = (uint32)FMath::Min(FMath::FloorToInt(Column), (int32)MaxColumn - 1);
+	const physx::PxMaterialTableIndex MaterialIndex = HeightField->getTriangleMaterialIndex((RowIndex * HeightField->getNbColumns() + ColumnIndex) * 2);
+	if (MaterialIndex == physx::PxHeightFieldMaterial::eHOLE)
+	{
+		return false;
+	}
+
+	// Heights are stored relative to the landscape mid height with the same Z scale as render data
+	auto SampleLocal = [HeightField, LandscapeComponent](float SampleRow, float SampleColumn)
+	{
+		return FVector(SampleRow * LandscapeComponent->CollisionScale, SampleColumn * LandscapeComponent->CollisionScale, HeightField->getHeight(SampleRow, SampleColumn) * LANDSCAPE_ZSCALE);
+	};
+
+	OutPoint = ComponentTransform.TransformPosition(SampleLocal(Row, Column));
+
+	// Normal by central differences over one collision quad
+	const FVector AxisX = ComponentTransform.TransformPosition(SampleLocal(FMath::Min(Row + 0.5f, MaxRow), Column)) - ComponentTransform.TransformPosition(SampleLocal(FMath::Max(Row - 0.5f, 0.f), Column));
+	const FVector AxisY = ComponentTransform.TransformPosition(SampleLocal(Row, FMath::Min(Column + 0.5f, MaxColumn))) - ComponentTransform.TransformPosition(SampleLocal(Row, FMath::Max(Column - 0.5f, 0.f)));
+	OutNormal = FVector::CrossProduct(AxisX, AxisY).GetSafeNormal();
+	if (FVector::DotProduct(OutNormal, ComponentTransform.GetUnitAxis(EAxis::Z)) < 0.f)
+	{
+		OutNormal = -OutNormal;
+	}
+
+	OutPhysMaterial = HeightfieldRef->UsedPhysicalMaterialArray.IsValidIndex(MaterialIndex) ? HeightfieldRef->UsedPhysicalMaterialArray[MaterialIndex] : nullptr;
+
+	return !OutNormal.IsNearlyZero();
+}
+#endif // WITH_PHYSX
+
 UPrvVehicleMovementComponent::UPrvVehicleMovementComponent(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 {
@@ -157,6 +343,15 @@ UPrvVehicleMovementComponent::UPrvVehicleMovementComponent(const FObjectInitiali
 	DecompressionDampingFactor = 1.f;
 	DropFactor = 5.f;
 
+	bUseFixedTimestep = false;
+	FixedTimestep = 1.f / 60.f;
+	MaxSubsteps = 4;
+
+	bUseFleetManager = false;
+
+	bBakeCurves = true;
+	CurveBakeResolution = 256;
+
 	// Init basic torque curve
 	FRichCurve* TorqueCurveData = EngineTorqueCurve.GetRichCurve();
 	TorqueCurveData->AddKey(0.f, 800.f);
@@ -188,6 +383,20 @@ UPrvVehicleMovementComponent::UPrvVehicleMovementComponent(const FObjectInitiali
 	UpdatedMesh = nullptr;
 	
 	bUseKineticFriction = false;
+
+	SimTransform = FTransform::Identity;
+	SimLinearVelocityOffset = FVector::ZeroVector;
+	SimForceScale = 1.f;
+	SimAppliedForce = FVector::ZeroVector;
+	bSimRequestAsyncTraces = true;
+	SimWorldTime = 0.f;
+	FixedTimestepAccumulator = 0.f;
+	FixedTimestepHeldTime = 0.f;
+	bRecordStepForces = false;
+	bSimulationCacheDirty = true;
+	bDeferBodyCommands = false;
+	bDeferredStepPending = false;
+	bTickedByFleetManager = false;
 	
 	CorrectionBeganTime = 0.f;
 	CorrectionEndTime = 0.f;
@@ -204,6 +413,57 @@ UPrvVehicleMovementComponent::UPrvVehicleMovementComponent(const FObjectInitiali
 	RawThrottleInputKeep = 0.f;
 	bRawHandbrakeInput = false;
 	QuantizeInput = 0;
+
+	MaxInputSendRate = 30.f;
+	InputDeadband = 0.02f;
+	InputRedundancy = 3;
+	InputKeepAliveInterval = 0.25f;
+
+	FMemory::Memzero(InputHistory);
+	InputHistoryNum = 0;
+	InputSequence = 0;
+	bInputPending = false;
+	LastInputSendTime = 0.f;
+	LastAppliedInputSequence = 0;
+	InputEpoch = 0;
+	LastAppliedInputEpoch = 0;
+	bAcceptAnyInputEpoch = true;
+
+	InputPackets = 0;
+	InputBytes = 0;
+	InputPacketsDropped = 0;
+	InputPacketsKeepAlive = 0;
+	InputStatsStartTime = 0.f;
+	InputSequenceStartTime = 0.f;
+	LastAppliedInputTime = 0.f;
+
+	bClientPrediction = false;
+	ServerStateSendRate = 10.f;
+	PredictionHistorySize = 128;
+	PredictionTolerance = 2.f;
+	PredictionSnapDistance = 300.f;
+	PredictionCorrectionTime = 0.2f;
+
+	PredictionHistoryHead = 0;
+	PendingCorrectionLocation = FVector::ZeroVector;
+	PendingCorrectionRotation = FQuat::Identity;
+	PendingCorrectionTime = 0.f;
+	LastAckedSequence = 0;
+	LastAckedTimeSinceInput = -1.f;
+	LastServerStateSendTime = 0.f;
+
+	bReplicateWheelState = false;
+	WheelStateLengthBits = 5;
+
+	bSnapshotInterpolation = false;
+	InterpolationDelay = 0.1f;
+	MaxExtrapolationTime = 0.25f;
+	SnapshotBufferSize = 32;
+
+	SnapshotCorrectionSum = 0.f;
+	SnapshotCorrectionMax = 0.f;
+	SnapshotFrames = 0;
+	SnapshotStarvedFrames = 0;
 	
 	bScaleForceToActiveFrictionPoints = false;
 	bClampSuspensionForce = false;
@@ -211,6 +471,29 @@ UPrvVehicleMovementComponent::UPrvVehicleMovementComponent(const FObjectInitiali
 	bSimplifiedSuspension = false;
 	bSimplifiedSuspensionWithoutThrottle = true;
 	bSimplifiedSuspensionByCamera = true;
+	bAsyncSuspensionTraces = false;
+	bLandscapeGroundSampling = false;
+	LandscapeGroundClearance = 200.f;
+
+	WheelLod = EPrvWheelLod::Full;
+	WheelLodFrameCounter = 0;
+	WheelLodAccumulatedTime = 0.f;
+
+	bTraceBudgetStarved = false;
+	UntracedWheels = 0;
+	TraceBudgetFrames = 0;
+	TraceBudgetStarvedFrames = 0;
+	TraceBudgetStarvedStreak = 0;
+
+	bRecordTelemetry = false;
+	TelemetryVehicleId = 0;
+
+	bSuspensionContactCache = false;
+	ContactCacheMaxDisplacement = 1.f;
+	ContactCacheMaxRotation = 0.5f;
+	ContactCacheTimeout = 0.5f;
+	ContactCacheHits = 0;
+	ContactCacheMisses = 0;
 	
 	bEnableAntiRollover = false;
 	AntiRolloverValueThreshold = 1.f;
@@ -235,6 +518,7 @@ void UPrvVehicleMovementComponent::InitializeComponent()
 	CalculateMOI();
 	InitSuspension();
 	InitGears();
+	InitSimulationCache();
 
 	// Cache RPM limits
 	FRichCurve* TorqueCurveData = EngineTorqueCurve.GetRichCurve();
@@ -245,10 +529,108 @@ void UPrvVehicleMovementComponent::InitializeComponent()
 	MaxEngineRPM = FMath::Max(0.f, MaxEngineRPM);
 }
 
+#if WITH_EDITOR
+void UPrvVehicleMovementComponent::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	InvalidateSimulationCache();
+}
+#endif
+
 void UPrvVehicleMovementComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction *ThisTickFunction)
 {
 	PRV_CYCLE_COUNTER(STAT_PrvMovementTickComponent);
 
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	// Component tick can be enabled again by Activate, so check the vehicle is not simulated by manager already
+	if (bTickedByFleetManager)
+	{
+		return;
+	}
+
+	PreSimulate(DeltaTime, false);
+	PostSimulate(DeltaTime);
+}
+
+void UPrvVehicleMovementComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (bUseFleetManager)
+	{
+		APrvVehicleFleetManager* Manager = APrvVehicleFleetManager::Get(GetWorld());
+		if (Manager)
+		{
+			Manager->RegisterVehicle(this);
+			FleetManager = Manager;
+		}
+	}
+
+	// Wheels of simulated proxies are traced according to their significance
+	if (GetNetMode() != NM_DedicatedServer && GetDefault<UPrvVehicleSettings>()->bEnableWheelSignificance)
+	{
+		APrvVehicleFleetManager* Manager = FleetManager.IsValid() ? FleetManager.Get() : APrvVehicleFleetManager::Get(GetWorld());
+		if (Manager)
+		{
+			Manager->RegisterSignificance(this);
+			FleetManager = Manager;
+		}
+
+		// Spread interleaved traces of different vehicles over frames
+		WheelLodFrameCounter = GetUniqueID();
+	}
+
+	// Suspension traces are scheduled by global budget
+	if (APrvVehicleFleetManager::IsTraceBudgetEnabled())
+	{
+		APrvVehicleFleetManager* Manager = FleetManager.IsValid() ? FleetManager.Get() : APrvVehicleFleetManager::Get(GetWorld());
+		if (Manager)
+		{
+			Manager->RegisterTraceBudget(this);
+			FleetManager = Manager;
+		}
+	}
+
+	// Only sampled vehicles pay for telemetry
+	if (APrvVehicleFleetManager::IsTelemetryEnabled())
+	{
+		APrvVehicleFleetManager* Manager = FleetManager.IsValid() ? FleetManager.Get() : APrvVehicleFleetManager::Get(GetWorld());
+		if (Manager)
+		{
+			TelemetryVehicleId = Manager->RegisterTelemetry();
+			bRecordTelemetry = (TelemetryVehicleId != 0);
+			FleetManager = Manager;
+		}
+	}
+}
+
+void UPrvVehicleMovementComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (FleetManager.IsValid())
+	{
+		FleetManager->UnregisterVehicle(this);
+		FleetManager->UnregisterSignificance(this);
+		FleetManager->UnregisterTraceBudget(this);
+	}
+
+	// Dust effects are given back to the pool
+	for (UParticleSystemComponent*& DustPSC : WheelDustComponents)
+	{
+		ReleaseWheelEffect(DustPSC);
+		DustPSC = nullptr;
+	}
+
+	FleetManager.Reset();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+bool UPrvVehicleMovementComponent::PreSimulate(float DeltaTime, bool bAllowDeferred)
+{
+	bDeferredStepPending = false;
+
 	// Notify server about player input
 	APawn* MyOwner = UpdatedMesh ? Cast<APawn>(UpdatedMesh->GetOwner()) : nullptr;
 	if (MyOwner && MyOwner->IsLocallyControlled())
@@ -258,19 +640,45 @@ void UPrvVehicleMovementComponent::TickComponent(float DeltaTime, enum ELevelTic
 		const int32 QHandbrakeInput = bRawHandbrakeInput ? (1 << 15) : 0;
 		const uint16 NewQuantizeInput = QHandbrakeInput | QSteeringInput | QThrottleInput;
 
-		if (QuantizeInput != NewQuantizeInput)
+		UpdateInputStream(NewQuantizeInput);
+
+		// Server simulates queued input only, so owning client does the same (changes within deadband are not sent)
+		if (GetOwnerRole() == ROLE_AutonomousProxy && InputHistoryNum > 0)
 		{
-			QuantizeInput = NewQuantizeInput;
-			ServerUpdateState(QuantizeInput);
+			ApplyQuantizedInput(InputHistory[0]);
 		}
 	}
 
-	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+	// Owning client reconciles prediction with server, server feeds it with authoritative states
+	if (IsClientPredictionActive())
+	{
+		ApplyPredictionCorrection(DeltaTime);
+		RecordPredictionHistory();
+	}
+	else if (bClientPrediction && GetOwner()->Role == ROLE_Authority)
+	{
+		SendServerState();
+	}
 
 	// Check that mesh exists
 	if (!UpdatedMesh)
 	{
-		return;
+		return false;
+	}
+
+	PRV_INC_ROLE_STAT_BY(GetOwnerRole(), STAT_PrvVehiclesTicked, 1);
+
+	// Simulate actual body state by default
+	SimTransform = UpdatedMesh->GetComponentTransform();
+	SimLinearVelocityOffset = FVector::ZeroVector;
+	SimForceScale = 1.f;
+	bSimRequestAsyncTraces = true;
+	SimWorldTime = GetWorld()->GetTimeSeconds();
+
+	// Cache is rebuilt on game thread only, deferred dynamics can run on worker threads
+	if (bSimulationCacheDirty)
+	{
+		InitSimulationCache();
 	}
 
 	// Reset sleeping state each time we have any input
@@ -286,31 +694,23 @@ void UPrvVehicleMovementComponent::TickComponent(float DeltaTime, enum ELevelTic
 		// Perform full simulation only on server and for local owner
 		if (ShouldAddForce())
 		{
-			// Suspension
-			UpdateSuspension(DeltaTime);
-			UpdateFriction(DeltaTime);
-
-			// Engine
-			UpdateSteering(DeltaTime);
-			UpdateThrottle(DeltaTime);
-
-			// Control
-			UpdateGearBox();
-			UpdateBrake(DeltaTime);
-
-			// Movement
-			UpdateTracksVelocity(DeltaTime);
-			UpdateHullVelocity(DeltaTime);
-			UpdateEngine();
-			UpdateDriveForce();
+			if (bUseFixedTimestep)
+			{
+				UpdateFixedTimestep(DeltaTime);
+			}
+			else if (bAllowDeferred && !bShowDebug && !bDebugAutoGearBox && !bDebugCustomDamping)
+			{
+				// Suspension traces and hits stay on game thread, the rest is pure math
+				// (vehicles with debug output are simulated on game thread entirely)
+				UpdateSuspension(DeltaTime);
+				UpdateRenderWheelsState(1.f);
 
-			// Additional damping
-			UpdateLinearVelocity(DeltaTime);
-			UpdateAngularVelocity(DeltaTime);
-			
-			if (bEnableAntiRollover)
+				bDeferredStepPending = true;
+			}
+			else
 			{
-				UpdateAntiRollover(DeltaTime);
+				UpdateSimulation(DeltaTime);
+				UpdateRenderWheelsState(1.f);
 			}
 		}
 		else
@@ -324,30 +724,76 @@ void UPrvVehicleMovementComponent::TickComponent(float DeltaTime, enum ELevelTic
 				UpdatedMesh->SetEnableGravity(false);
 			}
 			
+			if (IsSnapshotInterpolationActive())
+			{
+				UpdateSnapshotInterpolation();
+			}
 			// Check if we are in the process of body's state correction
-			if (bCorrectionInProgress && GetWorld()->GetTimeSeconds() >= CorrectionEndTime)
+			else if (bCorrectionInProgress && GetWorld()->GetTimeSeconds() >= CorrectionEndTime)
 			{
 				// Time has come
 				// Set the body into it's meant position
 				
 				bCorrectionInProgress = false;
-					
+				
+				// Tighten thresholds for this correction only, so they don't degrade over the session
 				FVector DeltaPos(FVector::ZeroVector);
-				ErrorCorrectionData.LinearDeltaThresholdSq /= 2.f;
-				ErrorCorrectionData.AngularDeltaThreshold /= 2.f;
-				ErrorCorrectionData.LinearRecipFixTime *= 2.f;
-				ErrorCorrectionData.AngularRecipFixTime *= 2.f;
+				FRigidBodyErrorCorrection ForcedErrorCorrection = ErrorCorrectionData;
+				ForcedErrorCorrection.LinearDeltaThresholdSq /= 2.f;
+				ForcedErrorCorrection.AngularDeltaThreshold /= 2.f;
+				ForcedErrorCorrection.LinearRecipFixTime *= 2.f;
+				ForcedErrorCorrection.AngularRecipFixTime *= 2.f;
 				
-				UE_LOG(LogPrvVehicle, Warning, TEXT("Force correct body position, LinearRecipFixTime=%.2f"), ErrorCorrectionData.LinearRecipFixTime);
+				UE_LOG(LogPrvVehicle, Warning, TEXT("Force correct body position, LinearRecipFixTime=%.2f"), ForcedErrorCorrection.LinearRecipFixTime);
 					
-				ApplyRigidBodyState(CorrectionEndState, ErrorCorrectionData, DeltaPos);
+				ApplyRigidBodyState(CorrectionEndState, ForcedErrorCorrection, DeltaPos);
 			}
 		}
 	}
 
+	return bDeferredStepPending;
+}
+
+void UPrvVehicleMovementComponent::SimulateDeferred(float DeltaTime)
+{
+	if (!bDeferredStepPending)
+	{
+		return;
+	}
+
+	bDeferBodyCommands = true;
+	UpdateDynamics(DeltaTime);
+	bDeferBodyCommands = false;
+}
+
+void UPrvVehicleMovementComponent::PostSimulate(float DeltaTime)
+{
+	if (!UpdatedMesh)
+	{
+		return;
+	}
+
+	if (bDeferredStepPending)
+	{
+		ApplyBodyCommands();
+		bDeferredStepPending = false;
+	}
+
+	if (bReplicateWheelState && GetOwner()->Role == ROLE_Authority)
+	{
+		UpdateReplicatedWheels();
+	}
+
 	// @todo Network wheels animation
 	AnimateWheels(DeltaTime);
 
+	PublishState();
+
+	if (bRecordTelemetry)
+	{
+		RecordTelemetry(DeltaTime);
+	}
+
 	// Update dust VFX
 	if (!IsRunningDedicatedServer())
 	{
@@ -361,118 +807,427 @@ void UPrvVehicleMovementComponent::TickComponent(float DeltaTime, enum ELevelTic
 	}
 }
 
+void UPrvVehicleMovementComponent::UpdateSimulation(float DeltaTime)
+{
+	UpdateSuspension(DeltaTime);
+	UpdateDynamics(DeltaTime);
+}
 
-//////////////////////////////////////////////////////////////////////////
-// Physics Initialization
-
-void UPrvVehicleMovementComponent::InitMesh()
+void UPrvVehicleMovementComponent::UpdateDynamics(float DeltaTime)
 {
-	if (!UpdatedMesh)
+	// Suspension
+	UpdateFriction(DeltaTime);
+
+	// Engine
+	UpdateSteering(DeltaTime);
+	UpdateThrottle(DeltaTime);
+
+	// Control
+	UpdateGearBox();
+	UpdateBrake(DeltaTime);
+
+	// Movement
+	UpdateTracksVelocity(DeltaTime);
+	UpdateHullVelocity(DeltaTime);
+	UpdateEngine();
+	UpdateDriveForce();
+
+	// Additional damping
+	UpdateLinearVelocity(DeltaTime);
+	UpdateAngularVelocity(DeltaTime);
+
+	if (bEnableAntiRollover)
 	{
-		UpdatedMesh = Cast<USkinnedMeshComponent>(UpdatedComponent);
+		UpdateAntiRollover(DeltaTime);
 	}
 }
 
-void UPrvVehicleMovementComponent::InitBodyPhysics()
+void UPrvVehicleMovementComponent::UpdateFixedTimestep(float DeltaTime)
 {
-	if (!UpdatedMesh)
-	{
-		UE_LOG(LogPrvVehicle, Error, TEXT("InitBodyPhysics failed: No UpdatedMesh component found"));
-		return;
-	}
+	PRV_CYCLE_COUNTER(STAT_PrvMovementUpdateFixedTimestep);
 
-	if (bOverrideMass)
-	{
-		UpdatedMesh->SetMassOverrideInKg(NAME_None, OverrideVehicleMass);
-	}
+	const float StepTime = FMath::Max(FixedTimestep, 0.001f);
+	FixedTimestepAccumulator += DeltaTime;
 
-	if (!bCustomLinearDamping)
-	{
-		UpdatedMesh->SetLinearDamping(LinearDamping);
-	}
-	else
+	int32 NumSubsteps = FMath::FloorToInt(FixedTimestepAccumulator / StepTime);
+
+	// Frame is shorter than the step: physics still integrates gravity, so the last step forces are held
+	if (NumSubsteps == 0)
 	{
-		// Force zero physX damping
-		UpdatedMesh->SetLinearDamping(0.f);
+		ApplyHeldStepForces();
+		FixedTimestepHeldTime += DeltaTime;
+
+		UpdateRenderWheelsState(FMath::Clamp(FixedTimestepAccumulator / StepTime, 0.f, 1.f));
+		return;
 	}
 
-	if (!bCustomAngularDamping)
+	if (NumSubsteps > MaxSubsteps)
 	{
-		UpdatedMesh->SetAngularDamping(AngularDamping);
+		// Drop the time we can't simulate, otherwise slow frames would become even slower.
+		// Physics integrates the whole frame anyway, so the dropped time is spread over the steps we run
+		NumSubsteps = FMath::Max(1, MaxSubsteps);
+		FixedTimestepAccumulator = NumSubsteps * StepTime;
+		SimForceScale = 1.f / NumSubsteps;
 	}
 	else
 	{
-		// Force zero damping instead
-		UpdatedMesh->SetAngularDamping(0.f);
+		// Each step applies its impulse within the frame, minus the time already covered by held forces
+		const float StepsTime = NumSubsteps * StepTime;
+		const float UncoveredTime = FMath::Max(StepsTime - FixedTimestepHeldTime, 0.f);
+		SimForceScale = (DeltaTime > SMALL_NUMBER) ? (StepTime / DeltaTime) * (UncoveredTime / StepsTime) : 1.f;
 	}
 
-	UpdatedMesh->SetCenterOfMass(COMOffset);
-}
+	FixedTimestepHeldTime = 0.f;
 
-void UPrvVehicleMovementComponent::InitSuspension()
-{
-	if (!UpdatedMesh)
-	{
-		UE_LOG(LogPrvVehicle, Error, TEXT("InitSuspension failed: No UpdatedMesh component found"));
-		return;
-	}
+	const float GravityZ = UpdatedMesh->IsGravityEnabled() ? GetGravityZ() : 0.f;
+	const float Mass = FMath::Max(UpdatedMesh->GetMass(), KINDA_SMALL_NUMBER);
 
-	for (auto& SuspInfo : SuspensionSetup)
+	for (int32 Substep = 0; Substep < NumSubsteps; ++Substep)
 	{
-		if (!SuspInfo.bCustomWheelConfig)
-		{
-			SuspInfo.WheelBoneOffset = DefaultWheelBoneOffset;
-			SuspInfo.Length = DefaultLength;
-			SuspInfo.MaxDrop = DefaultMaxDrop;
-			SuspInfo.CollisionRadius = DefaultCollisionRadius;
-			SuspInfo.CollisionWidth = DefaultCollisionWidth;
-			SuspInfo.VisualOffset = DefaultVisualOffset;
-			SuspInfo.Stiffness = DefaultStiffness;
-			SuspInfo.CompressionDamping = DefaultCompressionDamping;
-			SuspInfo.DecompressionDamping = DefaultDecompressionDamping;
+		// Async traces are consumed on the next frame, so request them once
+		bSimRequestAsyncTraces = (Substep == NumSubsteps - 1);
 
-			if (SuspInfo.bRightTrack)
-			{
-				SuspInfo.WheelBoneOffset.Y *= -1.f;
-				SuspInfo.VisualOffset.Y *= -1.f;
-			}
-		}
-		
-		if (UpdatedMesh)
-		{
-			if (SuspInfo.bInheritWheelBoneTransform)
-			{
-				FTransform WheelTransform = UpdatedMesh->GetSocketTransform(SuspInfo.BoneName, RTS_Actor);
-				SuspInfo.Location = WheelTransform.GetLocation() + SuspInfo.WheelBoneOffset + FVector::UpVector * SuspInfo.Length;
-				SuspInfo.Rotation = WheelTransform.GetRotation().Rotator();
+		// Keep previous state for interpolation
+		WheelsState.PreviousVisualLength = WheelsState.VisualLength;
 
-				UE_LOG(LogPrvVehicle, Log, TEXT("Init suspension (%s): %s"), *SuspInfo.BoneName.ToString(), *SuspInfo.Location.ToString());
-			}
-			else
-			{
-				FTransform WheelTransform = UpdatedMesh->GetSocketTransform(SuspInfo.BoneName, RTS_Actor);
-				SuspInfo.WheelBoneOffset = (SuspInfo.Location - FVector::UpVector * SuspInfo.Length) - WheelTransform.GetLocation();
-			}
+		SimAppliedForce = FVector::ZeroVector;
+
+		// The last step forces are held by frames that have no steps
+		bRecordStepForces = (Substep == NumSubsteps - 1);
+		if (bRecordStepForces)
+		{
+			HeldStepForces.Reset();
 		}
 
-		FSuspensionState SuspState;
-		SuspState.SuspensionInfo = SuspInfo;
-		SuspState.PreviousLength = SuspInfo.Length;
+		UpdateSimulation(StepTime);
+		FixedTimestepAccumulator -= StepTime;
+		bRecordStepForces = false;
+
+		// Body is moved by physics once per frame, so extrapolate it for the next step
+		SimLinearVelocityOffset += (SimAppliedForce / Mass + FVector(0.f, 0.f, GravityZ)) * StepTime;
+
+		const FVector LinearVelocity = UpdatedMesh->GetPhysicsLinearVelocity() + SimLinearVelocityOffset;
+		const FVector AngularVelocity = FMath::DegreesToRadians(UpdatedMesh->GetPhysicsAngularVelocity());
+		const float AngularSpeed = AngularVelocity.Size();
 
-		if (SuspInfo.bSpawnDust)
+		SimTransform.AddToTranslation(LinearVelocity * StepTime);
+		if (AngularSpeed > SMALL_NUMBER)
 		{
-			SuspState.DustPSC = SpawnNewWheelEffect();
+			const FQuat DeltaRotation(AngularVelocity / AngularSpeed, AngularSpeed * StepTime);
+			SimTransform.SetRotation((DeltaRotation * SimTransform.GetRotation()).GetNormalized());
 		}
+	}
+
+	UpdateRenderWheelsState(FMath::Clamp(FixedTimestepAccumulator / StepTime, 0.f, 1.f));
+}
 
-		SuspensionData.Add(SuspState);
+void UPrvVehicleMovementComponent::UpdateRenderWheelsState(float Alpha)
+{
+	for (int32 WheelIndex = 0; WheelIndex < WheelsState.Num(); ++WheelIndex)
+	{
+		WheelsState.RenderVisualLength[WheelIndex] = FMath::Lerp(WheelsState.PreviousVisualLength[WheelIndex], WheelsState.VisualLength[WheelIndex], Alpha);
 	}
 }
 
-void UPrvVehicleMovementComponent::InitGears()
+void UPrvVehicleMovementComponent::AddSimForceAtLocation(const FVector& Force, const FVector& Location)
 {
-	for (int32 i = 0; i < GearSetup.Num(); ++i)
+	if (bDeferBodyCommands)
 	{
-		if (FMath::IsNearlyZero(GearSetup[i].Ratio))
+		FPrvBodyCommands::FForceAtLocation& Command = PendingBodyCommands.Forces[PendingBodyCommands.Forces.AddUninitialized()];
+		Command.Force = Force * SimForceScale;
+		Command.Location = Location;
+	}
+	else
+	{
+		UpdatedMesh->AddForceAtLocation(Force * SimForceScale, Location);
+	}
+
+	SimAppliedForce += Force;
+
+	// Held forces are kept in body space, the body is moved by physics before they are applied again
+	if (bRecordStepForces)
+	{
+		FPrvBodyCommands::FForceAtLocation& Command = HeldStepForces.Forces[HeldStepForces.Forces.AddUninitialized()];
+		Command.Force = SimTransform.InverseTransformVectorNoScale(Force);
+		Command.Location = SimTransform.InverseTransformPosition(Location);
+	}
+
+	PRV_INC_ROLE_STAT_BY(GetOwnerRole(), STAT_PrvForcesApplied, 1);
+}
+
+void UPrvVehicleMovementComponent::AddSimTorque(const FVector& Torque)
+{
+	if (bDeferBodyCommands)
+	{
+		PendingBodyCommands.Torque += Torque * SimForceScale;
+	}
+	else
+	{
+		UpdatedMesh->AddTorque(Torque * SimForceScale);
+	}
+
+	if (bRecordStepForces)
+	{
+		HeldStepForces.Torque += SimTransform.InverseTransformVectorNoScale(Torque);
+	}
+
+	PRV_INC_ROLE_STAT_BY(GetOwnerRole(), STAT_PrvForcesApplied, 1);
+}
+
+void UPrvVehicleMovementComponent::ApplyHeldStepForces()
+{
+	const FTransform BodyTransform = UpdatedMesh->GetComponentTransform();
+
+	for (const FPrvBodyCommands::FForceAtLocation& Command : HeldStepForces.Forces)
+	{
+		UpdatedMesh->AddForceAtLocation(BodyTransform.TransformVectorNoScale(Command.Force), BodyTransform.TransformPosition(Command.Location));
+	}
+
+	if (!HeldStepForces.Torque.IsZero())
+	{
+		UpdatedMesh->AddTorque(BodyTransform.TransformVectorNoScale(HeldStepForces.Torque));
+	}
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Body access
+
+FVector UPrvVehicleMovementComponent::GetBodyLinearVelocity() const
+{
+	return PendingBodyCommands.bSetLinearVelocity ? PendingBodyCommands.LinearVelocity : UpdatedMesh->GetPhysicsLinearVelocity();
+}
+
+FVector UPrvVehicleMovementComponent::GetBodyAngularVelocity() const
+{
+	return PendingBodyCommands.bSetAngularVelocity ? PendingBodyCommands.AngularVelocity : UpdatedMesh->GetPhysicsAngularVelocity();
+}
+
+void UPrvVehicleMovementComponent::SetBodyLinearVelocity(const FVector& NewVelocity)
+{
+	if (bDeferBodyCommands)
+	{
+		PendingBodyCommands.bSetLinearVelocity = true;
+		PendingBodyCommands.LinearVelocity = NewVelocity;
+	}
+	else
+	{
+		UpdatedMesh->SetPhysicsLinearVelocity(NewVelocity);
+	}
+}
+
+void UPrvVehicleMovementComponent::SetBodyAngularVelocity(const FVector& NewVelocity)
+{
+	if (bDeferBodyCommands)
+	{
+		PendingBodyCommands.bSetAngularVelocity = true;
+		PendingBodyCommands.AngularVelocity = NewVelocity;
+	}
+	else
+	{
+		UpdatedMesh->SetPhysicsAngularVelocity(NewVelocity);
+	}
+}
+
+void UPrvVehicleMovementComponent::ApplyBodyCommands()
+{
+	if (PendingBodyCommands.bSetLinearVelocity)
+	{
+		UpdatedMesh->SetPhysicsLinearVelocity(PendingBodyCommands.LinearVelocity);
+	}
+
+	if (PendingBodyCommands.bSetAngularVelocity)
+	{
+		UpdatedMesh->SetPhysicsAngularVelocity(PendingBodyCommands.AngularVelocity);
+	}
+
+	for (const FPrvBodyCommands::FForceAtLocation& Command : PendingBodyCommands.Forces)
+	{
+		UpdatedMesh->AddForceAtLocation(Command.Force, Command.Location);
+	}
+
+	if (!PendingBodyCommands.Torque.IsZero())
+	{
+		UpdatedMesh->AddTorque(PendingBodyCommands.Torque);
+	}
+
+	PendingBodyCommands.Reset();
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Physics Initialization
+
+void UPrvVehicleMovementComponent::InitMesh()
+{
+	if (!UpdatedMesh)
+	{
+		UpdatedMesh = Cast<USkinnedMeshComponent>(UpdatedComponent);
+	}
+}
+
+void UPrvVehicleMovementComponent::InitBodyPhysics()
+{
+	if (!UpdatedMesh)
+	{
+		UE_LOG(LogPrvVehicle, Error, TEXT("InitBodyPhysics failed: No UpdatedMesh component found"));
+		return;
+	}
+
+	if (bOverrideMass)
+	{
+		UpdatedMesh->SetMassOverrideInKg(NAME_None, OverrideVehicleMass);
+	}
+
+	if (!bCustomLinearDamping)
+	{
+		UpdatedMesh->SetLinearDamping(LinearDamping);
+	}
+	else
+	{
+		// Force zero physX damping
+		UpdatedMesh->SetLinearDamping(0.f);
+	}
+
+	if (!bCustomAngularDamping)
+	{
+		UpdatedMesh->SetAngularDamping(AngularDamping);
+	}
+	else
+	{
+		// Force zero damping instead
+		UpdatedMesh->SetAngularDamping(0.f);
+	}
+
+	UpdatedMesh->SetCenterOfMass(COMOffset);
+}
+
+void UPrvVehicleMovementComponent::InitSuspension()
+{
+	if (!UpdatedMesh)
+	{
+		UE_LOG(LogPrvVehicle, Error, TEXT("InitSuspension failed: No UpdatedMesh component found"));
+		return;
+	}
+
+	for (UParticleSystemComponent* DustPSC : WheelDustComponents)
+	{
+		ReleaseWheelEffect(DustPSC);
+	}
+
+	if (SuspensionSetup.Num() > FPrvVehicleStateSnapshot::MaxWheels)
+	{
+		UE_LOG(LogPrvVehicle, Warning, TEXT("InitSuspension: %d wheels, only %d of them are published for animation"), SuspensionSetup.Num(), (int32)FPrvVehicleStateSnapshot::MaxWheels);
+	}
+
+	if (bReplicateWheelState && SuspensionSetup.Num() > FPrvReplicatedWheels::MaxWheels)
+	{
+		UE_LOG(LogPrvVehicle, Warning, TEXT("InitSuspension: %d wheels, only %d of them are replicated, simulated proxies will trace suspension"), SuspensionSetup.Num(), (int32)FPrvReplicatedWheels::MaxWheels);
+	}
+
+	// Dust effects are acquired by the first effects update (never on dedicated server)
+	WheelDustComponents.Reset(SuspensionSetup.Num());
+	WheelDustComponents.AddZeroed(SuspensionSetup.Num());
+
+	for (auto& SuspInfo : SuspensionSetup)
+	{
+		if (!SuspInfo.bCustomWheelConfig)
+		{
+			SuspInfo.WheelBoneOffset = DefaultWheelBoneOffset;
+			SuspInfo.Length = DefaultLength;
+			SuspInfo.MaxDrop = DefaultMaxDrop;
+			SuspInfo.CollisionRadius = DefaultCollisionRadius;
+			SuspInfo.CollisionWidth = DefaultCollisionWidth;
+			SuspInfo.VisualOffset = DefaultVisualOffset;
+			SuspInfo.Stiffness = DefaultStiffness;
+			SuspInfo.CompressionDamping = DefaultCompressionDamping;
+			SuspInfo.DecompressionDamping = DefaultDecompressionDamping;
+
+			if (SuspInfo.bRightTrack)
+			{
+				SuspInfo.WheelBoneOffset.Y *= -1.f;
+				SuspInfo.VisualOffset.Y *= -1.f;
+			}
+		}
+		
+		if (UpdatedMesh)
+		{
+			if (SuspInfo.bInheritWheelBoneTransform)
+			{
+				FTransform WheelTransform = UpdatedMesh->GetSocketTransform(SuspInfo.BoneName, RTS_Actor);
+				SuspInfo.Location = WheelTransform.GetLocation() + SuspInfo.WheelBoneOffset + FVector::UpVector * SuspInfo.Length;
+				SuspInfo.Rotation = WheelTransform.GetRotation().Rotator();
+
+				UE_LOG(LogPrvVehicle, Log, TEXT("Init suspension (%s): %s"), *SuspInfo.BoneName.ToString(), *SuspInfo.Location.ToString());
+			}
+			else
+			{
+				FTransform WheelTransform = UpdatedMesh->GetSocketTransform(SuspInfo.BoneName, RTS_Actor);
+				SuspInfo.WheelBoneOffset = (SuspInfo.Location - FVector::UpVector * SuspInfo.Length) - WheelTransform.GetLocation();
+			}
+		}
+	}
+
+	// Dynamic state starts from relaxed suspension
+	WheelsState.Init(SuspensionSetup);
+
+	AsyncSuspensionTraces.SetNum(WheelsState.Num());
+	WheelContactCache.SetNum(WheelsState.Num());
+}
+
+void UPrvVehicleMovementComponent::InitSimulationCache()
+{
+	CachedSuspensionSettings = GetSuspensionSettings();
+	CachedFrictionSettings = GetFrictionSettings();
+
+	const float VehicleMass = UpdatedMesh ? UpdatedMesh->GetMass() : 0.f;
+
+	SuspensionCoefficients.SetNum(SuspensionSetup.Num());
+	for (int32 WheelIndex = 0; WheelIndex < SuspensionSetup.Num(); ++WheelIndex)
+	{
+		const FSuspensionInfo& SuspInfo = SuspensionSetup[WheelIndex];
+		SuspensionCoefficients[WheelIndex].Build(CachedSuspensionSettings, SuspInfo.Stiffness, SuspInfo.CompressionDamping, SuspInfo.DecompressionDamping, VehicleMass);
+	}
+
+	InitCurves();
+
+	bSimulationCacheDirty = false;
+}
+
+void UPrvVehicleMovementComponent::InitCurves()
+{
+	if (!bBakeCurves)
+	{
+		BakedEngineTorqueCurve.Reset();
+		BakedSteeringCurve.Reset();
+		BakedMaxSpeedCurve.Reset();
+		BakedAutoBrakeUpRatio.Reset();
+		BakedAntiRolloverForceCurve.Reset();
+		return;
+	}
+
+	BakedEngineTorqueCurve = FPrvBakedCurveCache::GetBakedCurve(*EngineTorqueCurve.GetRichCurve(), CurveBakeResolution, TEXT("EngineTorqueCurve"));
+	BakedSteeringCurve = FPrvBakedCurveCache::GetBakedCurve(*SteeringCurve.GetRichCurve(), CurveBakeResolution, TEXT("SteeringCurve"));
+	BakedMaxSpeedCurve = FPrvBakedCurveCache::GetBakedCurve(*MaxSpeedCurve.GetRichCurve(), CurveBakeResolution, TEXT("MaxSpeedCurve"));
+	BakedAutoBrakeUpRatio = FPrvBakedCurveCache::GetBakedCurve(*AutoBrakeUpRatio.GetRichCurve(), CurveBakeResolution, TEXT("AutoBrakeUpRatio"));
+	BakedAntiRolloverForceCurve = FPrvBakedCurveCache::GetBakedCurve(*AntiRolloverForceCurve.GetRichCurve(), CurveBakeResolution, TEXT("AntiRolloverForceCurve"));
+}
+
+float UPrvVehicleMovementComponent::EvalCurve(FRuntimeFloatCurve& Curve, const TSharedPtr<const FPrvBakedCurve>& BakedCurve, float Time)
+{
+	if (BakedCurve.IsValid())
+	{
+		return BakedCurve->Eval(Time);
+	}
+
+	return Curve.GetRichCurve()->Eval(Time);
+}
+
+void UPrvVehicleMovementComponent::InitGears()
+{
+	for (int32 i = 0; i < GearSetup.Num(); ++i)
+	{
+		if (FMath::IsNearlyZero(GearSetup[i].Ratio))
 		{
 			NeutralGear = i;
 			break;
@@ -509,6 +1264,8 @@ void UPrvVehicleMovementComponent::CalculateMOI()
 
 bool UPrvVehicleMovementComponent::IsSleeping(float DeltaTime)
 {
+	PRV_CYCLE_COUNTER(STAT_PrvMovementIsSleeping);
+
 	if (bForceNeverSleep)
 	{
 		return false;
@@ -563,9 +1320,9 @@ void UPrvVehicleMovementComponent::UpdateSteering(float DeltaTime)
 	
 	if (bAngularVelocitySteering)
 	{
-		if (bUseActiveDrivenFrictionPoints && SuspensionData.Num() > 0)
+		if (bUseActiveDrivenFrictionPoints && WheelsState.Num() > 0)
 		{
-			FrictionRatio = static_cast<float>(ActiveDrivenFrictionPoints) / SuspensionData.Num();
+			FrictionRatio = static_cast<float>(ActiveDrivenFrictionPoints) / WheelsState.Num();
 			
 			if (FrictionRatio >= AngularSteeringFrictionThreshold)
 			{
@@ -627,9 +1384,8 @@ void UPrvVehicleMovementComponent::UpdateSteering(float DeltaTime)
 
 	if (bUseSteeringCurve)
 	{
-		FRichCurve* SteeringCurveData = SteeringCurve.GetRichCurve();
-		const float SteeringCurveZeroPoint = FMath::Min(SteeringCurveData->Eval(0.f) + TurnRateModAngularSpeed, SteeringAngularSpeed);
-		const float SteeringCurvePoint = FMath::Min(SteeringCurveData->Eval(GetForwardSpeed()) + TurnRateModAngularSpeed, SteeringAngularSpeed);
+		const float SteeringCurveZeroPoint = FMath::Min(EvalCurve(SteeringCurve, BakedSteeringCurve, 0.f) + TurnRateModAngularSpeed, SteeringAngularSpeed);
+		const float SteeringCurvePoint = FMath::Min(EvalCurve(SteeringCurve, BakedSteeringCurve, GetForwardSpeed()) + TurnRateModAngularSpeed, SteeringAngularSpeed);
 
 		if (bMaximizeZeroThrottleSteering && FMath::IsNearlyZero(RawThrottleInput))
 		{
@@ -671,7 +1427,7 @@ void UPrvVehicleMovementComponent::UpdateSteering(float DeltaTime)
 	
 	if (bAngularVelocitySteering)
 	{
-		FVector LocalAngularVelocity = UpdatedMesh->GetComponentTransform().InverseTransformVectorNoScale(UpdatedMesh->GetPhysicsAngularVelocity());
+		FVector LocalAngularVelocity = UpdatedMesh->GetComponentTransform().InverseTransformVectorNoScale(GetBodyAngularVelocity());
 		
 		float TargetSteeringVelocity = EffectiveSteeringAngularSpeed;
 		
@@ -705,7 +1461,7 @@ void UPrvVehicleMovementComponent::UpdateSteering(float DeltaTime)
 			{
 				LocalAngularVelocity.Z = TargetSteeringVelocity;
 				EffectiveSteeringVelocity = UpdatedMesh->GetComponentTransform().TransformVectorNoScale(LocalAngularVelocity);
-				UpdatedMesh->SetPhysicsAngularVelocity(EffectiveSteeringVelocity);
+				SetBodyAngularVelocity(EffectiveSteeringVelocity);
 			}
 		}
 		else
@@ -718,11 +1474,11 @@ void UPrvVehicleMovementComponent::UpdateSteering(float DeltaTime)
 	if (bWheeledVehicle && bFullSteeringFriction)
 	{
 		// Update driving wheels for wheeled vehicles
-		for (auto& SuspState : SuspensionData)
+		for (int32 WheelIndex = 0; WheelIndex < WheelsState.Num(); ++WheelIndex)
 		{
-			if (SuspState.SuspensionInfo.bSteeringWheel)
+			if (SuspensionSetup[WheelIndex].bSteeringWheel)
 			{
-				SuspState.SuspensionInfo.Rotation.Yaw = EffectiveSteeringAngularSpeed;
+				WheelsState.Rotation[WheelIndex].Yaw = EffectiveSteeringAngularSpeed;
 			}
 		}
 	}
@@ -803,7 +1559,7 @@ void UPrvVehicleMovementComponent::UpdateGearBox()
 		ShiftGear(!bIsMovingForward);
 	}
 	// Check that we can shift gear by time
-	else if ((GetWorld()->GetTimeSeconds() - LastAutoGearShiftTime) > GearAutoBoxLatency)
+	else if ((SimWorldTime - LastAutoGearShiftTime) > GearAutoBoxLatency)
 	{
 		const float CurrentRPMRatio = (EngineRPM - MinEngineRPM) / (MaxEngineRPM - MinEngineRPM);
 		
@@ -825,47 +1581,9 @@ void UPrvVehicleMovementComponent::UpdateGearBox()
 void UPrvVehicleMovementComponent::ShiftGear(bool bShiftUp)
 {
 	const int32 PrevGear = CurrentGear;
-	
-	if (bShiftUp)
-	{
-		CurrentGear += 1;
-	}
-	else
-	{
-		CurrentGear -= 1;
-	}
-	
-	CurrentGear = FMath::Clamp(CurrentGear, 0, GearSetup.Num() - 1);
-
-	// Force gears limits on user input
-	if (FMath::IsNearlyZero(RawThrottleInput) == false)
-	{
-		bReverseGear = (RawThrottleInput < 0.f);
 
-		if (bReverseGear)
-		{
-			CurrentGear = FMath::Max(0, FMath::Min(CurrentGear, NeutralGear - 1));
-		}
-		else
-		{
-			CurrentGear = FMath::Max(CurrentGear, NeutralGear);
-		}
-	}
-	else
-	{
-		// Don't switch gear when we want to be neutral
-		if (PrevGear >= NeutralGear)
-		{
-			CurrentGear = FMath::Max(CurrentGear, NeutralGear);
-		}
-		else
-		{
-			CurrentGear = FMath::Min(CurrentGear, NeutralGear);
-		}
+	CurrentGear = FPrvVehicleSimulation::ShiftGear(CurrentGear, GearSetup.Num(), NeutralGear, bShiftUp, RawThrottleInput, bReverseGear);
 
-		bReverseGear = (CurrentGear < NeutralGear);
-	}
-	
 	if (bDebugAutoGearBox)
 	{
 		if (bShiftUp)
@@ -878,7 +1596,7 @@ void UPrvVehicleMovementComponent::ShiftGear(bool bShiftUp)
 		}
 	}
 
-	LastAutoGearShiftTime = GetWorld()->GetTimeSeconds();
+	LastAutoGearShiftTime = SimWorldTime;
 }
 
 void UPrvVehicleMovementComponent::UpdateBrake(float DeltaTime)
@@ -890,7 +1608,7 @@ void UPrvVehicleMovementComponent::UpdateBrake(float DeltaTime)
 	
 	if (bAutoBrake)
 	{
-		const float AutoBrakeCurveValue = AutoBrakeUpRatio.GetRichCurve()->Eval(GetForwardSpeed());
+		const float AutoBrakeCurveValue = EvalCurve(AutoBrakeUpRatio, BakedAutoBrakeUpRatio, GetForwardSpeed());
 		BrakeInputIncremented = FMath::Clamp(BrakeInput + AutoBrakeCurveValue * DeltaTime, 0.f, AutoBrakeFactor);
 		const bool bHasThrottleInput = (FMath::IsNearlyZero(RawThrottleInput) == false);
 		
@@ -988,8 +1706,7 @@ void UPrvVehicleMovementComponent::UpdateBrake(float DeltaTime)
 	{
 		const float CurrentSpeed = UpdatedMesh->GetComponentVelocity().Size();
 
-		FRichCurve* MaxSpeedCurveData = MaxSpeedCurve.GetRichCurve();
-		const float MaxSpeedLimit = MaxSpeedCurveData->Eval(FMath::Abs(TargetSteeringAngularSpeed) - TurnRateModAngularSpeed);
+		const float MaxSpeedLimit = EvalCurve(MaxSpeedCurve, BakedMaxSpeedCurve, FMath::Abs(TargetSteeringAngularSpeed) - TurnRateModAngularSpeed);
 
 		if (CurrentSpeed >= MaxSpeedLimit)
 		{
@@ -1031,6 +1748,8 @@ void UPrvVehicleMovementComponent::UpdateBrake(float DeltaTime)
 
 void UPrvVehicleMovementComponent::UpdateTracksVelocity(float DeltaTime)
 {
+	PRV_CYCLE_COUNTER(STAT_PrvMovementUpdateTracksVelocity);
+
 	// Calc total torque
 	RightTrackTorque = RightTrack.DriveTorque + RightTrack.KineticFrictionTorque + RightTrack.RollingFrictionTorque;
 	LeftTrackTorque = LeftTrack.DriveTorque + LeftTrack.KineticFrictionTorque + LeftTrack.RollingFrictionTorque;
@@ -1038,13 +1757,13 @@ void UPrvVehicleMovementComponent::UpdateTracksVelocity(float DeltaTime)
 	// Update right track velocity
 	const float RightAngularSpeed = RightTrack.AngularSpeed + (bUseKineticFriction ?  (RightTrackTorque / FinalMOI * DeltaTime) : 0.f);
 	RightTrackEffectiveAngularSpeed = RightAngularSpeed;
-	RightTrack.AngularSpeed = ApplyBrake(DeltaTime, RightAngularSpeed, RightTrack.BrakeRatio);
+	RightTrack.AngularSpeed = FPrvVehicleSimulation::ApplyBrake(DeltaTime, RightAngularSpeed, RightTrack.BrakeRatio, BrakeForce);
 	RightTrack.LinearSpeed = RightTrack.AngularSpeed * SprocketRadius;
 
 	// Update left track velocity
 	const float LeftAngularSpeed = LeftTrack.AngularSpeed + (bUseKineticFriction ?  (LeftTrackTorque / FinalMOI * DeltaTime) : 0.f);
 	LeftTrackEffectiveAngularSpeed = LeftAngularSpeed;
-	LeftTrack.AngularSpeed = ApplyBrake(DeltaTime, LeftAngularSpeed, LeftTrack.BrakeRatio);
+	LeftTrack.AngularSpeed = FPrvVehicleSimulation::ApplyBrake(DeltaTime, LeftAngularSpeed, LeftTrack.BrakeRatio, BrakeForce);
 	LeftTrack.LinearSpeed = LeftTrack.AngularSpeed * SprocketRadius;
 
 	// Debug
@@ -1060,20 +1779,10 @@ void UPrvVehicleMovementComponent::UpdateTracksVelocity(float DeltaTime)
 	}
 }
 
-float UPrvVehicleMovementComponent::ApplyBrake(float DeltaTime, float AngularVelocity, float BrakeRatio)
-{
-	const float BrakeVelocity = BrakeRatio * BrakeForce * DeltaTime;
-
-	if (FMath::Abs(AngularVelocity) > FMath::Abs(BrakeVelocity))
-	{
-		return (AngularVelocity - (BrakeVelocity * FMath::Sign(AngularVelocity)));
-	}
-
-	return 0.f;
-}
-
 void UPrvVehicleMovementComponent::UpdateHullVelocity(float DeltaTime)
 {
+	PRV_CYCLE_COUNTER(STAT_PrvMovementUpdateHullVelocity);
+
 	HullAngularSpeed = (FMath::Abs(LeftTrack.AngularSpeed) + FMath::Abs(RightTrack.AngularSpeed)) / 2.f;
 }
 
@@ -1084,12 +1793,10 @@ void UPrvVehicleMovementComponent::UpdateEngine()
 	const FGearInfo CurrentGearInfo = GetCurrentGearInfo();
 
 	// Update engine rotation speed (RPM)
-	EngineRPM = PrvOmegaToRPM((CurrentGearInfo.Ratio * DifferentialRatio) * HullAngularSpeed);
-	EngineRPM = FMath::Clamp(EngineRPM, MinEngineRPM, MaxEngineRPM);
+	EngineRPM = FPrvVehicleSimulation::CalculateEngineRPM(CurrentGearInfo.Ratio, DifferentialRatio, HullAngularSpeed, MinEngineRPM, MaxEngineRPM);
 
 	// Calculate engine torque based on current RPM
-	FRichCurve* TorqueCurveData = EngineTorqueCurve.GetRichCurve();
-	const float MaxEngineTorque = TorqueCurveData->Eval(EngineRPM) * 100.f; // Meters to Cm
+	const float MaxEngineTorque = EvalCurve(EngineTorqueCurve, BakedEngineTorqueCurve, EngineRPM) * 100.f; // Meters to Cm
 
 	// Check engine torque limitations
 	const float CurrentSpeed = UpdatedMesh->GetComponentVelocity().Size();
@@ -1099,8 +1806,7 @@ void UPrvVehicleMovementComponent::UpdateEngine()
 	bool bLimitTorqueBySpeed = false;
 	if (bLimitMaxSpeed)
 	{
-		FRichCurve* MaxSpeedCurveData = MaxSpeedCurve.GetRichCurve();
-		const float MaxSpeedLimit = MaxSpeedCurveData->Eval(FMath::Abs(TargetSteeringAngularSpeed) - TurnRateModAngularSpeed);
+		const float MaxSpeedLimit = EvalCurve(MaxSpeedCurve, BakedMaxSpeedCurve, FMath::Abs(TargetSteeringAngularSpeed) - TurnRateModAngularSpeed);
 
 		bLimitTorqueBySpeed = (CurrentSpeed >= MaxSpeedLimit);
 	}
@@ -1116,14 +1822,8 @@ void UPrvVehicleMovementComponent::UpdateEngine()
 	}
 	
 	// Gear box torque
-	DriveTorque = EngineTorque * CurrentGearInfo.Ratio * DifferentialRatio * TransmissionEfficiency;
-	DriveTorque *= (bReverseGear) ? -1.f : 1.f;
-	DriveTorque *= EngineExtraPowerRatio;
-	
-	if (RawThrottleInput < 0.f)
-	{
-		DriveTorque *= EngineRearExtraPowerRatio;
-	}
+	const float ExtraPowerRatio = (RawThrottleInput < 0.f) ? (EngineExtraPowerRatio * EngineRearExtraPowerRatio) : EngineExtraPowerRatio;
+	DriveTorque = FPrvVehicleSimulation::CalculateDriveTorque(EngineTorque, CurrentGearInfo.Ratio, DifferentialRatio, TransmissionEfficiency, bReverseGear, ExtraPowerRatio);
 
 	// Debug
 	if (bShowDebug)
@@ -1136,6 +1836,8 @@ void UPrvVehicleMovementComponent::UpdateEngine()
 
 void UPrvVehicleMovementComponent::UpdateDriveForce()
 {
+	PRV_CYCLE_COUNTER(STAT_PrvMovementUpdateDriveForce);
+
 	// Drive force (right)
 	if (bSteeringStabilizerActiveRight == false)
 	{
@@ -1163,6 +1865,8 @@ void UPrvVehicleMovementComponent::UpdateDriveForce()
 
 void UPrvVehicleMovementComponent::UpdateAntiRollover(float DeltaTime)
 {
+	PRV_CYCLE_COUNTER(STAT_PrvMovementUpdateAntiRollover);
+
 	const FVector VehicleZ = UpdatedMesh->GetUpVector();
 	const FVector WorldZ = FVector::UpVector;
 	const FVector AntiRolloverVector = FVector::CrossProduct(VehicleZ, WorldZ);
@@ -1170,120 +1874,196 @@ void UPrvVehicleMovementComponent::UpdateAntiRollover(float DeltaTime)
 	
 	if (Sine > LastAntiRolloverValue || Sine >= AntiRolloverValueThreshold)
 	{
-		const float TorqueMultiplier = AntiRolloverForceCurve.GetRichCurve()->Eval(Sine);
-		UpdatedMesh->AddTorque(AntiRolloverVector * TorqueMultiplier);
+		const float TorqueMultiplier = EvalCurve(AntiRolloverForceCurve, BakedAntiRolloverForceCurve, Sine);
+		AddSimTorque(AntiRolloverVector * TorqueMultiplier);
 	}
 	
 	LastAntiRolloverValue = Sine;
 }
 
-void UPrvVehicleMovementComponent::UpdateSuspension(float DeltaTime)
+/** Full simulation: suspension forces are calculated and applied to the body */
+struct FPrvSuspensionPhysicsPolicy
 {
-	PRV_CYCLE_COUNTER(STAT_PrvMovementUpdateSuspension);
+	static const bool bComputeForces = true;
+	static const bool bApplyForces = true;
+};
+
+/** Wheels are just put on the ground (used for proxy actors) */
+struct FPrvSuspensionVisualsPolicy
+{
+	static const bool bComputeForces = false;
+	static const bool bApplyForces = false;
+};
 
+/** Forces are calculated but never applied (used by suspension benchmark) */
+struct FPrvSuspensionDryRunPolicy
+{
+	static const bool bComputeForces = true;
+	static const bool bApplyForces = false;
+};
+
+template <typename TPolicy, bool bIsWheeled>
+void UPrvVehicleMovementComponent::UpdateSuspensionKernel(float DeltaTime, bool bUseLineTrace)
+{
 	// Refresh friction points counter
 	const int32 ActiveWheelsNum = ActiveFrictionPoints;
-	ActiveFrictionPoints = 0;
-	ActiveDrivenFrictionPoints = 0;
+	if (TPolicy::bComputeForces)
+	{
+		ActiveFrictionPoints = 0;
+		ActiveDrivenFrictionPoints = 0;
+	}
+
+	const float VehicleMass = UpdatedMesh->GetMass();
+
+	// Coefficients depend on mass, so check it was not changed in runtime
+	if (bSimulationCacheDirty || SuspensionCoefficients.Num() != WheelsState.Num() ||
+		(SuspensionCoefficients.Num() > 0 && SuspensionCoefficients[0].Mass != VehicleMass))
+	{
+		InitSimulationCache();
+	}
+
+	const FPrvSuspensionSettings& SuspensionSettings = CachedSuspensionSettings;
 
 	TArray<AActor*> IgnoredActors;
 	const EDrawDebugTrace::Type DebugType = IsDebug() ? EDrawDebugTrace::ForOneFrame : EDrawDebugTrace::None;
+
+	// Open landscape: wheels sample heightfield directly instead of scene traces
+	const bool bLandscapeGround = bLandscapeGroundSampling && UpdateLandscapeGround();
+
+	// Cached contacts can be covered by movable objects (nothing but landscape is around when sampling it)
+	ContactCacheBlockers.Reset();
+	if (bSuspensionContactCache && !bLandscapeGround)
+	{
+		UpdateContactCacheBlockers();
+	}
+
+	// Out of global trace budget: wheels are put onto previous contact planes
+	const bool bTraceBudgetUsed = bTraceBudgetStarved;
+
+	// Stats are flushed once after the loop
+	uint32 NumTraces = 0;
+	uint32 NumHits = 0;
+	uint32 NumForces = 0;
+	int32 NumUntracedWheels = 0;
 	
-	const bool bUseLineTrace = UseLineTrace();
-	
-	for (auto& SuspState : SuspensionData)
+	for (int32 WheelIndex = 0; WheelIndex < WheelsState.Num(); ++WheelIndex)
 	{
-		const FVector SuspUpVector = UpdatedMesh->GetComponentTransform().TransformVectorNoScale(UKismetMathLibrary::GetUpVector(SuspState.SuspensionInfo.Rotation));
-		const FVector SuspWorldLocation = UpdatedMesh->GetComponentTransform().TransformPosition(SuspState.SuspensionInfo.Location);
-		const FVector SuspTraceEndLocation = SuspWorldLocation - SuspUpVector * (SuspState.SuspensionInfo.Length + SuspState.SuspensionInfo.MaxDrop);
-		const FVector RadiusUpVector = SuspUpVector * SuspState.SuspensionInfo.CollisionRadius;
+		const FSuspensionInfo& SuspInfo = SuspensionSetup[WheelIndex];
+		const FRotator& SuspRotation = WheelsState.Rotation[WheelIndex];
+
+		const FVector SuspUpVector = SimTransform.TransformVectorNoScale(UKismetMathLibrary::GetUpVector(SuspRotation));
+		const FVector SuspWorldLocation = SimTransform.TransformPosition(SuspInfo.Location);
+		const FVector SuspTraceEndLocation = SuspWorldLocation - SuspUpVector * (SuspInfo.Length + SuspInfo.MaxDrop);
+		const FVector RadiusUpVector = SuspUpVector * SuspInfo.CollisionRadius;
 		
 		// Make trace to touch the ground
 		FHitResult Hit;
 		bool bHit = false;
 		bool bHitValid = false;
+		bool bLineTraceHit = bUseLineTrace;
 
-		// For cylindrical wheels only
-		if (FMath::Abs(DefaultCollisionWidth) > SMALL_NUMBER && !bUseLineTrace)
-		{
-			TArray<FHitResult> Hits;
-		
-#if ENGINE_MINOR_VERSION >= 15
-			bHit = UKismetSystemLibrary::SphereTraceMulti(this, SuspWorldLocation, SuspTraceEndLocation, SuspState.SuspensionInfo.CollisionRadius, SuspensionTraceTypeQuery, bTraceComplex, IgnoredActors, DebugType, Hits, true);
-#else
-			bHit = UKismetSystemLibrary::SphereTraceMulti_NEW(this, SuspWorldLocation, SuspTraceEndLocation, SuspState.SuspensionInfo.CollisionRadius, SuspensionTraceTypeQuery, bTraceComplex, IgnoredActors, DebugType, Hits, true);
-#endif
-			
-			// Process hits and find the best one
-			float BestDistanceSquared = MAX_FLT;
-			for (auto MyHit : Hits)
-			{
-				// Ignore overlap
-				if (!MyHit.bBlockingHit)
-				{
-					continue;
-				}
+		// Wheel barely moved since the last trace over static geometry
+		const bool bContactCacheUsed = bSuspensionContactCache && UseCachedWheelContact(WheelIndex, SuspWorldLocation, SuspUpVector, SuspTraceEndLocation, bUseLineTrace, Hit, bHit);
 
-				FVector HitLocation_SuspSpace = FVector::ZeroVector;
-				
-				// Check that it was penetration hit
-				if (MyHit.bStartPenetrating)
-				{
-					HitLocation_SuspSpace = (MyHit.PenetrationDepth - SuspState.SuspensionInfo.CollisionRadius) * UpdatedMesh->GetComponentTransform().InverseTransformVectorNoScale(MyHit.Normal);
-				}
-				else
-				{
-					// Transform into wheel space
-					HitLocation_SuspSpace = UpdatedMesh->GetComponentTransform().InverseTransformPosition(MyHit.ImpactPoint) - SuspState.SuspensionInfo.Location;
-				}
+		// Use the trace requested on previous tick if it's ready
+		const bool bAsyncTraceUsed = !bContactCacheUsed && !bLandscapeGround && bAsyncSuspensionTraces && ConsumeAsyncSuspensionTrace(WheelIndex, SuspWorldLocation, SuspUpVector, Hit, bHit, bHitValid, bLineTraceHit);
 
-				// Apply reverse wheel rotation
-				HitLocation_SuspSpace = SuspState.SuspensionInfo.Rotation.UnrotateVector(HitLocation_SuspSpace);
+		// Async trace requested on previous tick is already paid, so it's used anyway.
+		// Airborne wheels have no contact to reuse, so they are probed by line trace to be able to land
+		const bool bBudgetStarved = !bContactCacheUsed && !bAsyncTraceUsed && bTraceBudgetUsed;
+		const bool bContactReused = bBudgetStarved && WheelsState.WheelTouchedGround[WheelIndex];
+		const bool bStarvedProbe = bBudgetStarved && !bContactReused;
+		if (bStarvedProbe)
+		{
+			bLineTraceHit = true;
+		}
 
-				// Check that is outside the cylinder
-				if (FMath::Abs(HitLocation_SuspSpace.Y) < (SuspState.SuspensionInfo.CollisionWidth / 2.f))
-				{
-					// Select the nearest one
-					if (HitLocation_SuspSpace.SizeSquared() < BestDistanceSquared)
-					{
-						BestDistanceSquared = HitLocation_SuspSpace.SizeSquared();
+		if (bContactCacheUsed || (bLandscapeGround && !bContactReused))
+		{
+			++NumUntracedWheels;
+		}
 
-						Hit = MyHit;
-						bHitValid = true;
-					}
-				}
+		if (bContactCacheUsed)
+		{
+			bHitValid = bHit;
+		}
+		else if (bContactReused)
+		{
+			bHit = WheelsState.WheelTouchedGround[WheelIndex] && PrvWheelPlaneContact(WheelsState.WheelCollisionLocation[WheelIndex], WheelsState.WheelCollisionNormal[WheelIndex],
+				SuspWorldLocation, SuspUpVector, SuspInfo.Length + SuspInfo.MaxDrop, SuspInfo.CollisionRadius, bUseLineTrace, Hit);
+			bHitValid = bHit;
+		}
+		else if (bLandscapeGround)
+		{
+			bHit = SampleLandscapeGround(SuspWorldLocation, SuspUpVector, SuspTraceEndLocation, SuspInfo.CollisionRadius, bLineTraceHit, Hit);
+			bHitValid = bHit;
+			++NumTraces;
 
-				// Debug hit points
-				if (bShowDebug)
-				{
-					DrawDebugPoint(GetWorld(), UpdatedMesh->GetComponentTransform().TransformPosition(SuspState.SuspensionInfo.Location + SuspState.SuspensionInfo.Rotation.RotateVector(HitLocation_SuspSpace)), 5.f, FColor::Green, false, /*LifeTime*/ 0.f);
-				}
-			}
+			INC_DWORD_STAT(STAT_PrvMovementLandscapeSamples);
 		}
-		else
+		else if (!bAsyncTraceUsed)
 		{
-			if (bUseLineTrace)
+			const uint32 TraceStartCycles = FPlatformTime::Cycles();
+
+			// For cylindrical wheels only
+			if (FMath::Abs(DefaultCollisionWidth) > SMALL_NUMBER && !bLineTraceHit)
 			{
+				TArray<FHitResult> Hits;
+			
 #if ENGINE_MINOR_VERSION >= 15
-				bHit = UKismetSystemLibrary::LineTraceSingle(this, SuspWorldLocation + RadiusUpVector, SuspTraceEndLocation - RadiusUpVector, SuspensionTraceTypeQuery, bTraceComplex, IgnoredActors, DebugType, Hit, true);
+				bHit = UKismetSystemLibrary::SphereTraceMulti(this, SuspWorldLocation, SuspTraceEndLocation, SuspInfo.CollisionRadius, SuspensionTraceTypeQuery, bTraceComplex, IgnoredActors, DebugType, Hits, true);
 #else
-				bHit = UKismetSystemLibrary::LineTraceSingle_NEW(this, SuspWorldLocation + RadiusUpVector, SuspTraceEndLocation - RadiusUpVector,SuspensionTraceTypeQuery, bTraceComplex, IgnoredActors, DebugType, Hit, true);
+				bHit = UKismetSystemLibrary::SphereTraceMulti_NEW(this, SuspWorldLocation, SuspTraceEndLocation, SuspInfo.CollisionRadius, SuspensionTraceTypeQuery, bTraceComplex, IgnoredActors, DebugType, Hits, true);
 #endif
+				
+				// Process hits and find the best one
+				bHitValid = SelectWheelHit(WheelIndex, Hits, Hit);
 			}
 			else
 			{
+				if (bLineTraceHit)
+				{
+#if ENGINE_MINOR_VERSION >= 15
+					bHit = UKismetSystemLibrary::LineTraceSingle(this, SuspWorldLocation + RadiusUpVector, SuspTraceEndLocation - RadiusUpVector, SuspensionTraceTypeQuery, bTraceComplex, IgnoredActors, DebugType, Hit, true);
+#else
+					bHit = UKismetSystemLibrary::LineTraceSingle_NEW(this, SuspWorldLocation + RadiusUpVector, SuspTraceEndLocation - RadiusUpVector,SuspensionTraceTypeQuery, bTraceComplex, IgnoredActors, DebugType, Hit, true);
+#endif
+				}
+				else
+				{
 #if ENGINE_MINOR_VERSION >= 15
-				bHit = UKismetSystemLibrary::SphereTraceSingle(this, SuspWorldLocation, SuspTraceEndLocation, SuspState.SuspensionInfo.CollisionRadius, SuspensionTraceTypeQuery, bTraceComplex, IgnoredActors, DebugType, Hit, true);
+					bHit = UKismetSystemLibrary::SphereTraceSingle(this, SuspWorldLocation, SuspTraceEndLocation, SuspInfo.CollisionRadius, SuspensionTraceTypeQuery, bTraceComplex, IgnoredActors, DebugType, Hit, true);
 #else
-				bHit = UKismetSystemLibrary::SphereTraceSingle_NEW(this, SuspWorldLocation, SuspTraceEndLocation, SuspState.SuspensionInfo.CollisionRadius, SuspensionTraceTypeQuery, bTraceComplex, IgnoredActors, DebugType, Hit, true);
+					bHit = UKismetSystemLibrary::SphereTraceSingle_NEW(this, SuspWorldLocation, SuspTraceEndLocation, SuspInfo.CollisionRadius, SuspensionTraceTypeQuery, bTraceComplex, IgnoredActors, DebugType, Hit, true);
 #endif
+				}
+				
+				bHitValid = bHit;
 			}
-			
-			bHitValid = bHit;
+
+			// Remember how expensive blocking traces are to estimate async gain
+			PrvRegisterSyncTraceCycles(FPlatformTime::Cycles() - TraceStartCycles);
+			++NumTraces;
+		}
+
+		// Request the trace for the next tick
+		if (!bContactCacheUsed && !bBudgetStarved && !bLandscapeGround && bAsyncSuspensionTraces && bSimRequestAsyncTraces)
+		{
+			RequestAsyncSuspensionTrace(WheelIndex, SuspWorldLocation, SuspTraceEndLocation, RadiusUpVector, bUseLineTrace);
+		}
+
+		if (bSuspensionContactCache && !bContactCacheUsed && !bBudgetStarved)
+		{
+			CacheWheelContact(WheelIndex, SuspWorldLocation, SuspUpVector, bLineTraceHit, bHitValid, Hit);
+		}
+
+		if (bHitValid)
+		{
+			++NumHits;
 		}
 		
 		// Conver line hit to "sphere" hit
-		if (bUseLineTrace && bHitValid)
+		if (bLineTraceHit && bHitValid)
 		{
 			Hit.Location = Hit.ImpactPoint + RadiusUpVector;
 			Hit.Distance = (Hit.Location - SuspWorldLocation).Size();
@@ -1293,14 +2073,14 @@ void UPrvVehicleMovementComponent::UpdateSuspension(float DeltaTime)
 		if (bHitValid)
 		{
 			// Transform impact point to actor space
-			const FVector HitActorLocation = UpdatedMesh->GetComponentTransform().InverseTransformPosition(Hit.ImpactPoint);
+			const FVector HitActorLocation = SimTransform.InverseTransformPosition(Hit.ImpactPoint);
 
 			// Check that collision is under suspension
-			if (HitActorLocation.Z >= SuspState.SuspensionInfo.Location.Z)
+			if (HitActorLocation.Z >= SuspInfo.Location.Z)
 			{
 				if (bDebugSuspensionLimits)
 				{
-					UE_LOG(LogPrvVehicle, Warning, TEXT("Susp Hit Forced to Zero: Collision.Z: %f, Suspension.Z: %f"), HitActorLocation.Z, SuspState.SuspensionInfo.Location.Z);
+					UE_LOG(LogPrvVehicle, Warning, TEXT("Susp Hit Forced to Zero: Collision.Z: %f, Suspension.Z: %f"), HitActorLocation.Z, SuspInfo.Location.Z);
 				}
 
 				// Force maximum compression
@@ -1314,147 +2094,72 @@ void UPrvVehicleMovementComponent::UpdateSuspension(float DeltaTime)
 		if (bHitValid)
 		{
 			// Clamp suspension length because MaxDrop distance is for visuals only (non-effective compression)
-			const float NewSuspensionLength = FMath::Clamp(Hit.Distance, 0.f, SuspState.SuspensionInfo.Length);
-
-			const float SpringCompressionRatio = FMath::Clamp((SuspState.SuspensionInfo.Length - NewSuspensionLength) / SuspState.SuspensionInfo.Length, 0.f, 1.f);
-			const float TargetVelocity = 0.f;		// @todo Target velocity can be different for wheeled vehicles
-
-			// Original suspension velocity
-			const float DiscreteSuspensionVelocity = (NewSuspensionLength - SuspState.PreviousLength) / DeltaTime;
-
-			float SuspensionForce = 0.f;
+			const float NewSuspensionLength = FMath::Clamp(Hit.Distance, 0.f, SuspInfo.Length);
 
-			// Compression and decompression have different suspension quality
-			float SuspensionDamping = 0.f;
-			const float SuspensionStiffness = SuspState.SuspensionInfo.Stiffness * StiffnessFactor;
-
-			if (DiscreteSuspensionVelocity < 0)
-			{
-				SuspensionDamping = SuspState.SuspensionInfo.CompressionDamping * CompressionDampingFactor;
-			}
-			else
+			if (TPolicy::bComputeForces)
 			{
-				SuspensionDamping = SuspState.SuspensionInfo.DecompressionDamping * DecompressionDampingFactor;
-			}
-
-			// Check we should correct the damping
-			float SuspensionVelocity = DiscreteSuspensionVelocity;
-			if (bCustomDampingCorrection && FMath::Abs(DampingCorrectionFactor) > SMALL_NUMBER && FMath::Abs(DiscreteSuspensionVelocity) > SMALL_NUMBER)
-			{
-				// Suspension velocity damping (because it works not discrete for DeltaTime)
-				const float suspVel = DiscreteSuspensionVelocity / 100.f;
-				const float k = SuspensionStiffness / 100.f;
-				const float D = SuspensionDamping / 100.f;
-				const float m = UpdatedMesh->GetMass();				// VehicleMass
-				const float b = SuspensionDamping / (2.f * m);		// DampingCoefficient
-				const float a_lin = FMath::Square(b) - (k / m);
-				const float a = FMath::Sqrt(FMath::Max(1.f, a_lin));	// FrictionCoefficient
-				const float A = suspVel / (2.f * a);				// InitialDampingEffect
-				const float B = -A;
-				const float dL_old = suspVel * DeltaTime;
-				const float dL_new = FMath::Exp(-b * DeltaTime) * (A * FMath::Exp(a * DeltaTime) + B * FMath::Exp(-a * DeltaTime));
-				const float Kl = dL_new / dL_old;
-				SuspensionVelocity = suspVel * FMath::Pow(Kl, DampingCorrectionFactor);
-
-				if (bDebugDampingCorrection)
-				{
-					if (a_lin < 1.f)
-					{
-						UE_LOG(LogPrvVehicle, Error, TEXT("a_lin is too small: %f"), a_lin);
-					}
-
-					UE_LOG(LogPrvVehicle, Warning, TEXT("DeltaTime: %f, suspVel: %f, k: %f, m: %f, D: %f, a: %f, b: %f, k/m: %f, A: %f, dL_old: %f, dL_new: %f, suspVelCorrected: %f"),
-						DeltaTime, suspVel, k, m, D, a, b, (k / m), A, dL_old, dL_new, SuspensionVelocity);
-				}
+				// Debug logging requires intermediate values, so it's calculated without cache
+				const float SuspensionForce = bDebugDampingCorrection ?
+					FPrvVehicleSimulation::CalculateSuspensionForce(GetSuspensionSettings(), SuspInfo.Length, SuspInfo.Stiffness, SuspInfo.CompressionDamping, SuspInfo.DecompressionDamping,
+						NewSuspensionLength, WheelsState.PreviousLength[WheelIndex], VehicleMass, ActiveWheelsNum, DeltaTime) :
+					FPrvVehicleSimulation::CalculateSuspensionForce(SuspensionSettings, SuspensionCoefficients[WheelIndex], SuspInfo.Length,
+						NewSuspensionLength, WheelsState.PreviousLength[WheelIndex], ActiveWheelsNum, DeltaTime);
+
+				const FVector SuspensionDirection = (bIsWheeled) ? Hit.ImpactNormal : SuspUpVector;
+				WheelsState.SuspensionForce[WheelIndex] = SuspensionForce * SuspensionDirection;
 			}
 
-			// Adaptive damping correction
-			if (bAdaptiveDampingCorrection)
-			{
-				const float D = SuspensionDamping / 100.f;
-				const float m = UpdatedMesh->GetMass();				// VehicleMass
-
-				const float AdaptiveExp = (1 - FMath::Exp((-D) * ActiveWheelsNum / m * DeltaTime));
-				if (FMath::Abs(AdaptiveExp) > SMALL_NUMBER)
-				{
-					const float AdaptiveSuspensionDamping = AdaptiveExp * m / (ActiveWheelsNum * DeltaTime);
-
-					if (bDebugDampingCorrection)
-					{
-						UE_LOG(LogPrvVehicle, Warning, TEXT("SuspensionDamping: %f, AdaptiveSuspensionDamping: %f, ActiveWheelsNum: %d"),
-							SuspensionDamping, (AdaptiveSuspensionDamping * 100.f), ActiveWheelsNum);
-					}
-
-					SuspensionDamping = AdaptiveSuspensionDamping * 100.f;
-				}
-				else if (bDebugDampingCorrection)
-				{
-					UE_LOG(LogPrvVehicle, Warning, TEXT("SuspensionDamping: %f, AdaptiveExp: 0"), SuspensionDamping);
-				}
-			}
-			
-			// Apply suspension force
-			SuspensionForce = (TargetVelocity - SuspensionVelocity) * SuspensionDamping + SpringCompressionRatio * SuspensionStiffness;
-			
-			if (SuspensionForce < 0.f)
+			WheelsState.WheelCollisionLocation[WheelIndex] = Hit.ImpactPoint;
+			WheelsState.WheelCollisionNormal[WheelIndex] = Hit.ImpactNormal;
+			WheelsState.PreviousLength[WheelIndex] = NewSuspensionLength;
+			WheelsState.WheelTouchedGround[WheelIndex] = true;
+			// Reused contact has no physical material, so the wheel keeps its surface
+			if (!bContactReused)
 			{
-				if (bClampSuspensionForce)
-				{
-					SuspensionForce = 0.f;
-				}
-				else
-				{
-					UE_LOG(LogPrvVehicle, Warning, TEXT("Negative SuspensionForce = %f"), SuspensionForce);
-				}
+				WheelsState.SurfaceType[WheelIndex] = UGameplayStatics::GetSurfaceType(Hit);
 			}
 
-			const FVector SuspensionDirection = (bWheeledVehicle) ? Hit.ImpactNormal : SuspUpVector;
-			SuspState.SuspensionForce = SuspensionForce * SuspensionDirection;
-
-			SuspState.WheelCollisionLocation = Hit.ImpactPoint;
-			SuspState.WheelCollisionNormal = Hit.ImpactNormal;
-			SuspState.PreviousLength = NewSuspensionLength;
-			SuspState.WheelTouchedGround = true;
-			SuspState.SurfaceType = UGameplayStatics::GetSurfaceType(Hit);
-
-			if (SuspState.VisualLength < Hit.Distance)
+			if (WheelsState.VisualLength[WheelIndex] < Hit.Distance)
 			{
-				SuspState.VisualLength = FMath::Lerp(SuspState.VisualLength, Hit.Distance, FMath::Clamp(DeltaTime * DropFactor, 0.f, 1.f));
+				WheelsState.VisualLength[WheelIndex] = FMath::Lerp(WheelsState.VisualLength[WheelIndex], Hit.Distance, FMath::Clamp(DeltaTime * DropFactor, 0.f, 1.f));
 			}
 			else
 			{
-				SuspState.VisualLength = Hit.Distance;
+				WheelsState.VisualLength[WheelIndex] = Hit.Distance;
 			}
 
-			// Current wheel touches ground
-			ActiveFrictionPoints++;
-
-			// Active driving wheels are calculated separately (has sense for cars only)
-			if (!bWheeledVehicle || SuspState.SuspensionInfo.bDrivingWheel)
+			if (TPolicy::bComputeForces)
 			{
-				ActiveDrivenFrictionPoints++;
+				// Current wheel touches ground
+				ActiveFrictionPoints++;
+
+				// Active driving wheels are calculated separately (has sense for cars only)
+				if (!bIsWheeled || SuspInfo.bDrivingWheel)
+				{
+					ActiveDrivenFrictionPoints++;
+				}
 			}
 		}
 		else
 		{
 			// If there is no collision then suspension is relaxed
-			SuspState.SuspensionForce = FVector::ZeroVector;
-			SuspState.WheelCollisionLocation = FVector::ZeroVector;
-			SuspState.WheelCollisionNormal = FVector::UpVector;
-			SuspState.PreviousLength = SuspState.SuspensionInfo.Length;
-			SuspState.VisualLength = FMath::Lerp(SuspState.VisualLength, SuspState.SuspensionInfo.Length + SuspState.SuspensionInfo.MaxDrop, FMath::Clamp(DeltaTime * DropFactor, 0.f, 1.f));		// @todo Make it non-momental
-			SuspState.WheelTouchedGround = false;
-			SuspState.SurfaceType = EPhysicalSurface::SurfaceType_Default;
+			WheelsState.SuspensionForce[WheelIndex] = FVector::ZeroVector;
+			WheelsState.WheelCollisionLocation[WheelIndex] = FVector::ZeroVector;
+			WheelsState.WheelCollisionNormal[WheelIndex] = FVector::UpVector;
+			WheelsState.PreviousLength[WheelIndex] = SuspInfo.Length;
+			WheelsState.VisualLength[WheelIndex] = FMath::Lerp(WheelsState.VisualLength[WheelIndex], SuspInfo.Length + SuspInfo.MaxDrop, FMath::Clamp(DeltaTime * DropFactor, 0.f, 1.f));		// @todo Make it non-momental
+			WheelsState.WheelTouchedGround[WheelIndex] = false;
+			WheelsState.SurfaceType[WheelIndex] = EPhysicalSurface::SurfaceType_Default;
 		}
 
 		// Add suspension force if spring compressed
-		if (ShouldAddForce() && !SuspState.SuspensionForce.IsZero())
+		if (TPolicy::bApplyForces && !WheelsState.SuspensionForce[WheelIndex].IsZero())
 		{
-			UpdatedMesh->AddForceAtLocation(SuspState.SuspensionForce, SuspWorldLocation);
+			AddSimForceAtLocation(WheelsState.SuspensionForce[WheelIndex], SuspWorldLocation);
 		}
 
 		// Push suspension force to environment
-		if (bHit)
+		if (TPolicy::bApplyForces && bHit)
 		{
 			UPrimitiveComponent* PrimitiveComponent = Hit.Component.Get();
 			if (PrimitiveComponent)
@@ -1468,7 +2173,8 @@ void UPrvVehicleMovementComponent::UpdateSuspension(float DeltaTime)
 				// Push the force
 				if (PrimitiveComponent->IsSimulatingPhysics())
 				{
-					PrimitiveComponent->AddForceAtLocation(-SuspState.SuspensionForce, SuspWorldLocation);
+					PrimitiveComponent->AddForceAtLocation(-WheelsState.SuspensionForce[WheelIndex] * SimForceScale, SuspWorldLocation);
+					++NumForces;
 				}
 			}
 		}
@@ -1477,23 +2183,48 @@ void UPrvVehicleMovementComponent::UpdateSuspension(float DeltaTime)
 		if (bShowDebug)
 		{
 			// Suspension force
-			DrawDebugLine(GetWorld(), SuspWorldLocation, SuspWorldLocation + SuspState.SuspensionForce * 0.0001f, FColor::Green, false, /*LifeTime*/ 0.f, /*DepthPriority*/ 0,  /*Thickness*/ 4.f);
+			if (TPolicy::bComputeForces)
+			{
+				DrawDebugLine(GetWorld(), SuspWorldLocation, SuspWorldLocation + WheelsState.SuspensionForce[WheelIndex] * 0.0001f, FColor::Green, false, /*LifeTime*/ 0.f, /*DepthPriority*/ 0,  /*Thickness*/ 4.f);
+			}
 
 			// Suspension length
 			DrawDebugPoint(GetWorld(), SuspWorldLocation, 5.f, FColor(200, 0, 230), false, /*LifeTime*/ 0.f);
-			DrawDebugLine(GetWorld(), SuspWorldLocation, SuspWorldLocation - SuspUpVector * SuspState.PreviousLength, FColor::Blue, false, 0.f, 0, 4.f);
-			DrawDebugLine(GetWorld(), SuspWorldLocation, SuspWorldLocation - SuspUpVector * SuspState.SuspensionInfo.Length, FColor::Red, false, 0.f, 0, 2.f);
+			DrawDebugLine(GetWorld(), SuspWorldLocation, SuspWorldLocation - SuspUpVector * WheelsState.PreviousLength[WheelIndex], FColor::Blue, false, 0.f, 0, 4.f);
+			DrawDebugLine(GetWorld(), SuspWorldLocation, SuspWorldLocation - SuspUpVector * SuspInfo.Length, FColor::Red, false, 0.f, 0, 2.f);
 
 			// Draw wheel
-			if (bHit && SuspState.SuspensionInfo.CollisionWidth != 0.f)
+			if (bHit && SuspInfo.CollisionWidth != 0.f)
 			{
 				FColor WheelColor = bHitValid ? FColor::Cyan : FColor::White;
-				FVector LineOffset = UpdatedMesh->GetComponentTransform().GetRotation().RotateVector(FVector(0.f, SuspState.SuspensionInfo.CollisionWidth / 2.f, 0.f));
-				LineOffset = SuspState.SuspensionInfo.Rotation.RotateVector(LineOffset);
-				DrawDebugCylinder(GetWorld(), Hit.Location - LineOffset, Hit.Location + LineOffset, SuspState.SuspensionInfo.CollisionRadius, 16, WheelColor, false, /*LifeTime*/ 0.f, 100);
+				FVector LineOffset = SimTransform.GetRotation().RotateVector(FVector(0.f, SuspInfo.CollisionWidth / 2.f, 0.f));
+				LineOffset = SuspRotation.RotateVector(LineOffset);
+				DrawDebugCylinder(GetWorld(), Hit.Location - LineOffset, Hit.Location + LineOffset, SuspInfo.CollisionRadius, 16, WheelColor, false, /*LifeTime*/ 0.f, 100);
 			}
 		}
 	}
+
+	UntracedWheels = NumUntracedWheels;
+
+	PRV_INC_ROLE_STAT_BY(GetOwnerRole(), STAT_PrvSuspensionTraces, NumTraces);
+	PRV_INC_ROLE_STAT_BY(GetOwnerRole(), STAT_PrvSuspensionHits, NumHits);
+	PRV_INC_ROLE_STAT_BY(GetOwnerRole(), STAT_PrvForcesApplied, NumForces);
+}
+
+void UPrvVehicleMovementComponent::UpdateSuspension(float DeltaTime)
+{
+	PRV_CYCLE_COUNTER(STAT_PrvMovementUpdateSuspension);
+
+	const bool bUseLineTrace = UseLineTrace();
+
+	if (bWheeledVehicle)
+	{
+		UpdateSuspensionKernel<FPrvSuspensionPhysicsPolicy, true>(DeltaTime, bUseLineTrace);
+	}
+	else
+	{
+		UpdateSuspensionKernel<FPrvSuspensionPhysicsPolicy, false>(DeltaTime, bUseLineTrace);
+	}
 }
 
 void UPrvVehicleMovementComponent::UpdateSuspensionVisualsOnly(float DeltaTime)
@@ -1501,13 +2232,53 @@ void UPrvVehicleMovementComponent::UpdateSuspensionVisualsOnly(float DeltaTime)
 	PRV_CYCLE_COUNTER(STAT_PrvMovementUpdateSuspensionVisualsOnly);
 
 	// Suspension
-	if (bShouldAnimateWheels)
+	if (bShouldAnimateWheels && UseReplicatedWheels())
+	{
+		ApplyReplicatedWheels(DeltaTime);
+	}
+	else if (bShouldAnimateWheels)
 	{
-		TArray<AActor*> IgnoredActors;
-		EDrawDebugTrace::Type DebugType = IsDebug() ? EDrawDebugTrace::ForOneFrame : EDrawDebugTrace::None;
-		
 		// For simulated proxy, suspension use line trace
 		bool bUseLineTrace = UseLineTrace();
+		bool bTraceWheels = true;
+		float SuspensionDeltaTime = DeltaTime;
+		float RenderAlpha = 1.f;
+
+		// Less significant vehicles trace less
+		switch (WheelLod)
+		{
+		case EPrvWheelLod::LineTrace:
+			bUseLineTrace = true;
+			break;
+
+		case EPrvWheelLod::Interleaved:
+		{
+			const int32 TraceInterval = FMath::Max(1, GetDefault<UPrvVehicleSettings>()->InterleavedTraceInterval);
+			WheelLodFrameCounter = (WheelLodFrameCounter + 1) % TraceInterval;
+			WheelLodAccumulatedTime += DeltaTime;
+
+			bUseLineTrace = true;
+			bTraceWheels = (WheelLodFrameCounter == 0);
+			SuspensionDeltaTime = WheelLodAccumulatedTime;
+
+			// Move from currently shown suspension to the new traced one during the interval
+			if (bTraceWheels)
+			{
+				WheelsState.PreviousVisualLength = WheelsState.RenderVisualLength;
+				WheelLodAccumulatedTime = 0.f;
+			}
+
+			RenderAlpha = (float)(WheelLodFrameCounter + 1) / TraceInterval;
+			break;
+		}
+
+		case EPrvWheelLod::Frozen:
+			bTraceWheels = false;
+			break;
+
+		default:
+			break;
+		}
 		
 		if (!bUseLineTrace && bSimplifiedSuspensionByCamera)
 		{
@@ -1526,479 +2297,1630 @@ void UPrvVehicleMovementComponent::UpdateSuspensionVisualsOnly(float DeltaTime)
 				}
 			}
 		}
-		
-		for (auto& SuspState : SuspensionData)
+
+		// Frozen wheels keep the last traced suspension
+		if (bTraceWheels)
 		{
-			const FVector SuspUpVector = UpdatedMesh->GetComponentTransform().TransformVectorNoScale(UKismetMathLibrary::GetUpVector(SuspState.SuspensionInfo.Rotation));
-			const FVector SuspWorldLocation = UpdatedMesh->GetComponentTransform().TransformPosition(SuspState.SuspensionInfo.Location);
-			const FVector SuspTraceEndLocation = SuspWorldLocation - SuspUpVector * (SuspState.SuspensionInfo.Length + SuspState.SuspensionInfo.MaxDrop);
-			const FVector RadiusUpVector = SuspUpVector * SuspState.SuspensionInfo.CollisionRadius;
-			
-			// Make trace to touch the ground
-			FHitResult Hit;
-			bool bHit = false;
-			bool bHitValid = false;
-			
-			// For cylindrical wheels only
-			if (FMath::Abs(DefaultCollisionWidth) > SMALL_NUMBER && !bUseLineTrace)
+			if (bWheeledVehicle)
 			{
-				TArray<FHitResult> Hits;
-				
-#if ENGINE_MINOR_VERSION >= 15
-				bHit = UKismetSystemLibrary::SphereTraceMulti(this, SuspWorldLocation, SuspTraceEndLocation, SuspState.SuspensionInfo.CollisionRadius, SuspensionTraceTypeQuery, bTraceComplex, IgnoredActors, DebugType, Hits, true);
-#else
-				bHit = UKismetSystemLibrary::SphereTraceMulti_NEW(this, SuspWorldLocation, SuspTraceEndLocation, SuspState.SuspensionInfo.CollisionRadius, SuspensionTraceTypeQuery, bTraceComplex, IgnoredActors, DebugType, Hits, true);
-#endif
-				
-				// Process hits and find the best one
-				float BestDistanceSquared = MAX_FLT;
-				for (auto MyHit : Hits)
-				{
-					// Ignore overlap
-					if (!MyHit.bBlockingHit)
-					{
-						continue;
-					}
-
-					FVector HitLocation_SuspSpace = FVector::ZeroVector;
-
-					// Check that it was penetration hit
-					if (MyHit.bStartPenetrating)
-					{
-						HitLocation_SuspSpace = (MyHit.PenetrationDepth - SuspState.SuspensionInfo.CollisionRadius) * UpdatedMesh->GetComponentTransform().InverseTransformVectorNoScale(MyHit.Normal);
-					}
-					else
-					{
-						// Transform into wheel space
-						HitLocation_SuspSpace = UpdatedMesh->GetComponentTransform().InverseTransformPosition(MyHit.ImpactPoint) - SuspState.SuspensionInfo.Location;
-					}
-
-					// Apply reverse wheel rotation
-					HitLocation_SuspSpace = SuspState.SuspensionInfo.Rotation.UnrotateVector(HitLocation_SuspSpace);
-
-					// Check that is outside the cylinder
-					if (FMath::Abs(HitLocation_SuspSpace.Y) < (SuspState.SuspensionInfo.CollisionWidth / 2.f))
-					{
-						// Select the nearest one
-						if (HitLocation_SuspSpace.SizeSquared() < BestDistanceSquared)
-						{
-							BestDistanceSquared = HitLocation_SuspSpace.SizeSquared();
-
-							Hit = MyHit;
-							bHitValid = true;
-						}
-					}
-
-					// Debug hit points
-					if (bShowDebug)
-					{
-						DrawDebugPoint(GetWorld(), UpdatedMesh->GetComponentTransform().TransformPosition(SuspState.SuspensionInfo.Location + SuspState.SuspensionInfo.Rotation.RotateVector(HitLocation_SuspSpace)), 5.f, FColor::Green, false, /*LifeTime*/ 0.f);
-					}
-				}
+				UpdateSuspensionKernel<FPrvSuspensionVisualsPolicy, true>(SuspensionDeltaTime, bUseLineTrace);
 			}
 			else
 			{
-				if (bUseLineTrace)
-				{
-#if ENGINE_MINOR_VERSION >= 15
-					bHit = UKismetSystemLibrary::LineTraceSingle(this, SuspWorldLocation + RadiusUpVector, SuspTraceEndLocation - RadiusUpVector,  SuspensionTraceTypeQuery, bTraceComplex, IgnoredActors, DebugType, Hit, true);
-#else
-					bHit = UKismetSystemLibrary::LineTraceSingle_NEW(this, SuspWorldLocation + RadiusUpVector, SuspTraceEndLocation - RadiusUpVector, SuspensionTraceTypeQuery, bTraceComplex, IgnoredActors, DebugType, Hit, true);
-#endif
-				}
-				else
-				{
-#if ENGINE_MINOR_VERSION >= 15
-					bHit = UKismetSystemLibrary::SphereTraceSingle(this, SuspWorldLocation, SuspTraceEndLocation, SuspState.SuspensionInfo.CollisionRadius, SuspensionTraceTypeQuery, bTraceComplex, IgnoredActors, DebugType, Hit, true);
-#else
-					bHit = UKismetSystemLibrary::SphereTraceSingle_NEW(this, SuspWorldLocation, SuspTraceEndLocation, SuspState.SuspensionInfo.CollisionRadius, SuspensionTraceTypeQuery, bTraceComplex, IgnoredActors, DebugType, Hit, true);
-#endif
-				}
-
-				bHitValid = bHit;
+				UpdateSuspensionKernel<FPrvSuspensionVisualsPolicy, false>(SuspensionDeltaTime, bUseLineTrace);
 			}
-			
-			// Conver line hit to "sphere" hit
-			if (bUseLineTrace && bHitValid)
+		}
+
+		UpdateRenderWheelsState(RenderAlpha);
+	}
+
+	// -- [Car] --
+	if (bWheeledVehicle)
+	{
+		// Update driving wheels for wheeled vehicles
+		for (int32 WheelIndex = 0; WheelIndex < WheelsState.Num(); ++WheelIndex)
+		{
+			if (SuspensionSetup[WheelIndex].bSteeringWheel)
 			{
-				Hit.Location = Hit.ImpactPoint + RadiusUpVector;
-				Hit.Distance = (Hit.Location - SuspWorldLocation).Size();
+				WheelsState.Rotation[WheelIndex].Yaw = FMath::Lerp(WheelsState.Rotation[WheelIndex].Yaw, EffectiveSteeringAngularSpeed, DeltaTime * (SteeringUpRatio + SteeringDownRatio) / 2.f);
 			}
+		}
+	}
+}
 
-			// Additional check that hit is valid (for non-spherical wheel)
-			if (bHitValid)
-			{
-				// Transform impact point to actor space
-				const FVector HitActorLocation = UpdatedMesh->GetComponentTransform().InverseTransformPosition(Hit.ImpactPoint);
+bool UPrvVehicleMovementComponent::SelectWheelHit(int32 WheelIndex, const TArray<FHitResult>& Hits, FHitResult& OutHit)
+{
+	const FSuspensionInfo& SuspInfo = SuspensionSetup[WheelIndex];
+	const FRotator& SuspRotation = WheelsState.Rotation[WheelIndex];
 
-				// Check that collision is under suspension
-				if (HitActorLocation.Z >= SuspState.SuspensionInfo.Location.Z)
-				{
-					if (bDebugSuspensionLimits)
-					{
-						UE_LOG(LogPrvVehicle, Warning, TEXT("Susp Hit Forced to Zero: Collision.Z: %f, Suspension.Z: %f"), HitActorLocation.Z, SuspState.SuspensionInfo.Location.Z);
-					}
+	bool bHitValid = false;
+	float BestDistanceSquared = MAX_FLT;
 
-					// Force maximum compression
-					Hit.ImpactPoint = SuspWorldLocation;
-					Hit.ImpactNormal = SuspUpVector;
-					Hit.Distance = 0.f;
-				}
-			}
+	for (const FHitResult& MyHit : Hits)
+	{
+		// Ignore overlap
+		if (!MyHit.bBlockingHit)
+		{
+			continue;
+		}
 
-			// Process hit results
-			if (bHitValid)
-			{
-				// Clamp suspension length because MaxDrop distance is for visuals only (non-effective compression)
-				const float NewSuspensionLength = FMath::Clamp(Hit.Distance, 0.f, SuspState.SuspensionInfo.Length);
+		FVector HitLocation_SuspSpace = FVector::ZeroVector;
+		
+		// Check that it was penetration hit
+		if (MyHit.bStartPenetrating)
+		{
+			HitLocation_SuspSpace = (MyHit.PenetrationDepth - SuspInfo.CollisionRadius) * SimTransform.InverseTransformVectorNoScale(MyHit.Normal);
+		}
+		else
+		{
+			// Transform into wheel space
+			HitLocation_SuspSpace = SimTransform.InverseTransformPosition(MyHit.ImpactPoint) - SuspInfo.Location;
+		}
 
-				const float SpringCompressionRatio = FMath::Clamp((SuspState.SuspensionInfo.Length - NewSuspensionLength) / SuspState.SuspensionInfo.Length, 0.f, 1.f);
+		// Apply reverse wheel rotation
+		HitLocation_SuspSpace = SuspRotation.UnrotateVector(HitLocation_SuspSpace);
 
-				SuspState.WheelCollisionLocation = Hit.ImpactPoint;
-				SuspState.WheelCollisionNormal = Hit.ImpactNormal;
-				SuspState.PreviousLength = NewSuspensionLength;
-				SuspState.WheelTouchedGround = true;
-				SuspState.SurfaceType = UGameplayStatics::GetSurfaceType(Hit);
+		// Check that is outside the cylinder
+		if (FMath::Abs(HitLocation_SuspSpace.Y) < (SuspInfo.CollisionWidth / 2.f))
+		{
+			// Select the nearest one
+			if (HitLocation_SuspSpace.SizeSquared() < BestDistanceSquared)
+			{
+				BestDistanceSquared = HitLocation_SuspSpace.SizeSquared();
+
+				OutHit = MyHit;
+				bHitValid = true;
+			}
+		}
+
+		// Debug hit points
+		if (bShowDebug)
+		{
+			DrawDebugPoint(GetWorld(), SimTransform.TransformPosition(SuspInfo.Location + SuspRotation.RotateVector(HitLocation_SuspSpace)), 5.f, FColor::Green, false, /*LifeTime*/ 0.f);
+		}
+	}
+
+	return bHitValid;
+}
+
+bool UPrvVehicleMovementComponent::UpdateLandscapeGround()
+{
+	PRV_CYCLE_COUNTER(STAT_PrvMovementUpdateLandscapeGround);
+
+	LandscapeGroundComponents.Reset();
+
+	UWorld* World = GetWorld();
+	if (!World || SuspensionSetup.Num() == 0)
+	{
+		return false;
+	}
+
+	const FBox SuspensionBounds = GetSuspensionBounds().ExpandBy(LandscapeGroundClearance);
+
+	FCollisionQueryParams QueryParams(NAME_PrvSuspensionTrace, false, GetOwner());
+	const ECollisionChannel TraceChannel = UEngineTypes::ConvertToCollisionChannel(SuspensionTraceTypeQuery);
+
+	// One broadphase query for the whole vehicle instead of sweep per wheel
+	TArray<FOverlapResult> Overlaps;
+	World->OverlapMultiByChannel(Overlaps, SimTransform.TransformPosition(SuspensionBounds.GetCenter()), SimTransform.GetRotation(), TraceChannel, FCollisionShape::MakeBox(SuspensionBounds.GetExtent()), QueryParams);
+
+	for (const FOverlapResult& Overlap : Overlaps)
+	{
+		UPrimitiveComponent* OverlapComponent = Overlap.GetComponent();
+		if (!OverlapComponent || OverlapComponent->GetCollisionResponseToChannel(TraceChannel) != ECR_Block)
+		{
+			continue;
+		}
+
+		// Something else is close to wheels, so use regular traces
+		if (!OverlapComponent->IsA(ULandscapeHeightfieldCollisionComponent::StaticClass()))
+		{
+			LandscapeGroundComponents.Reset();
+			return false;
+		}
+
+		LandscapeGroundComponents.AddUnique(OverlapComponent);
+	}
+
+	return LandscapeGroundComponents.Num() > 0;
+}
+
+bool UPrvVehicleMovementComponent::SampleLandscapeGround(const FVector& SuspWorldLocation, const FVector& SuspUpVector, const FVector& SuspTraceEndLocation, float Radius, bool bUseLineTrace, FHitResult& OutHit) const
+{
+	const float TraceLength = (SuspWorldLocation - SuspTraceEndLocation).Size();
+
+#if WITH_PHYSX
+	for (UPrimitiveComponent* LandscapeComponent : LandscapeGroundComponents)
+	{
+		// Sample under suspension, then once more under the contact to follow the slope
+		const ULandscapeHeightfieldCollisionComponent* HeightfieldComponent = CastChecked<ULandscapeHeightfieldCollisionComponent>(LandscapeComponent);
+		FVector PlanePoint, PlaneNormal;
+		UPhysicalMaterial* PhysMaterial = nullptr;
+		if (!PrvSampleLandscapeHeightfield(HeightfieldComponent, SuspWorldLocation, PlanePoint, PlaneNormal, PhysMaterial))
+		{
+			continue;
+		}
+
+		if (!PrvWheelPlaneContact(PlanePoint, PlaneNormal, SuspWorldLocation, SuspUpVector, TraceLength, Radius, bUseLineTrace, OutHit))
+		{
+			return false;
+		}
+
+		if (PrvSampleLandscapeHeightfield(HeightfieldComponent, OutHit.ImpactPoint, PlanePoint, PlaneNormal, PhysMaterial) &&
+			!PrvWheelPlaneContact(PlanePoint, PlaneNormal, SuspWorldLocation, SuspUpVector, TraceLength, Radius, bUseLineTrace, OutHit))
+		{
+			return false;
+		}
+
+		OutHit.bBlockingHit = true;
+		OutHit.Component = LandscapeComponent;
+		OutHit.Actor = LandscapeComponent->GetOwner();
+		OutHit.PhysMaterial = PhysMaterial;
+		return true;
+	}
+#endif // WITH_PHYSX
+
+	// No heightfield data: raycast collision components instead
+	const FVector RadiusUpVector = SuspUpVector * Radius;
+
+	FCollisionQueryParams QueryParams(NAME_PrvSuspensionTrace, bTraceComplex);
+	QueryParams.bReturnPhysicalMaterial = true;
+
+	// Raycast heightfields only, landscape is the only collision around
+	bool bHit = false;
+	for (UPrimitiveComponent* LandscapeComponent : LandscapeGroundComponents)
+	{
+		FHitResult ComponentHit;
+		if (LandscapeComponent->LineTraceComponent(ComponentHit, SuspWorldLocation + RadiusUpVector, SuspTraceEndLocation - RadiusUpVector, QueryParams) &&
+			(!bHit || ComponentHit.Time < OutHit.Time))
+		{
+			OutHit = ComponentHit;
+			bHit = true;
+		}
+	}
+
+	// Line hit is converted by the caller
+	if (!bHit || bUseLineTrace)
+	{
+		return bHit;
+	}
+
+	// Put the wheel sphere onto terrain plane at the ray hit (exact for flat ground, close enough for landscape slopes)
+	const FVector PlanePoint = OutHit.ImpactPoint;
+	const FVector PlaneNormal = OutHit.ImpactNormal;
+	return PrvWheelPlaneContact(PlanePoint, PlaneNormal, SuspWorldLocation, SuspUpVector, TraceLength, Radius, false, OutHit);
+}
+
+FBox UPrvVehicleMovementComponent::GetSuspensionBounds() const
+{
+	FBox SuspensionBounds(ForceInit);
+	for (const FSuspensionInfo& SuspInfo : SuspensionSetup)
+	{
+		const float Extent = SuspInfo.Length + SuspInfo.MaxDrop + SuspInfo.CollisionRadius;
+		SuspensionBounds += SuspInfo.Location + FVector(SuspInfo.CollisionRadius, SuspInfo.CollisionRadius, SuspInfo.CollisionRadius);
+		SuspensionBounds += SuspInfo.Location - FVector(SuspInfo.CollisionRadius, SuspInfo.CollisionRadius, Extent);
+	}
+
+	return SuspensionBounds;
+}
+
+void UPrvVehicleMovementComponent::UpdateContactCacheBlockers()
+{
+	UWorld* World = GetWorld();
+	if (!World || SuspensionSetup.Num() == 0)
+	{
+		return;
+	}
+
+	// Nothing to invalidate
+	bool bAnyCachedContact = false;
+	for (const FPrvWheelContactCache& ContactCache : WheelContactCache)
+	{
+		bAnyCachedContact |= ContactCache.bValid;
+	}
+
+	if (!bAnyCachedContact)
+	{
+		return;
+	}
+
+	FCollisionQueryParams QueryParams(NAME_PrvSuspensionTrace, false, GetOwner());
+	const ECollisionChannel TraceChannel = UEngineTypes::ConvertToCollisionChannel(SuspensionTraceTypeQuery);
+	const FBox SuspensionBounds = GetSuspensionBounds().ExpandBy(ContactCacheMaxDisplacement);
+
+	// One overlap for the whole vehicle is still cheaper than a trace per wheel
+	TArray<FOverlapResult> Overlaps;
+	World->OverlapMultiByChannel(Overlaps, SimTransform.TransformPosition(SuspensionBounds.GetCenter()), SimTransform.GetRotation(), TraceChannel, FCollisionShape::MakeBox(SuspensionBounds.GetExtent()), QueryParams);
+
+	for (const FOverlapResult& Overlap : Overlaps)
+	{
+		const UPrimitiveComponent* OverlapComponent = Overlap.GetComponent();
+		if (OverlapComponent && OverlapComponent->Mobility == EComponentMobility::Movable && OverlapComponent->GetCollisionResponseToChannel(TraceChannel) == ECR_Block)
+		{
+			ContactCacheBlockers.Add(OverlapComponent->Bounds.GetBox());
+		}
+	}
+}
+
+bool UPrvVehicleMovementComponent::UseCachedWheelContact(int32 WheelIndex, const FVector& SuspWorldLocation, const FVector& SuspUpVector, const FVector& SuspTraceEndLocation, bool bUseLineTrace, FHitResult& OutHit, bool& bOutHit)
+{
+	if (!WheelContactCache.IsValidIndex(WheelIndex) || !WheelContactCache[WheelIndex].bValid)
+	{
+		return false;
+	}
+
+	FPrvWheelContactCache& ContactCache = WheelContactCache[WheelIndex];
+
+	// Cached plane is valid for static geometry only
+	const UPrimitiveComponent* HitComponent = ContactCache.Hit.Component.Get();
+	const bool bStaticGround = HitComponent && HitComponent->Mobility == EComponentMobility::Static;
+
+	const bool bInsideEnvelope = bStaticGround &&
+		ContactCache.bLineTrace == bUseLineTrace &&
+		(GetWorld()->GetTimeSeconds() - ContactCache.TraceTime) < ContactCacheTimeout &&
+		FVector::DistSquared(SuspWorldLocation, ContactCache.SuspWorldLocation) <= FMath::Square(ContactCacheMaxDisplacement) &&
+		FVector::DotProduct(SuspUpVector, ContactCache.SuspUpVector) >= FMath::Cos(FMath::DegreesToRadians(ContactCacheMaxRotation));
+
+	// Movable object may have entered the wheel since the trace
+	bool bBlocked = false;
+	if (bInsideEnvelope && ContactCacheBlockers.Num() > 0)
+	{
+		const float Radius = SuspensionSetup[WheelIndex].CollisionRadius;
+		FBox WheelBounds(ForceInit);
+		WheelBounds += SuspWorldLocation;
+		WheelBounds += SuspTraceEndLocation;
+		WheelBounds = WheelBounds.ExpandBy(Radius);
+
+		for (const FBox& BlockerBounds : ContactCacheBlockers)
+		{
+			if (WheelBounds.Intersect(BlockerBounds))
+			{
+				bBlocked = true;
+				break;
+			}
+		}
+	}
+
+	if (!bInsideEnvelope || bBlocked)
+	{
+		ContactCache.bValid = false;
+		return false;
+	}
+
+	OutHit = ContactCache.Hit;
+	bOutHit = PrvWheelPlaneContact(ContactCache.Hit.ImpactPoint, ContactCache.Hit.ImpactNormal, SuspWorldLocation, SuspUpVector,
+		(SuspWorldLocation - SuspTraceEndLocation).Size(), SuspensionSetup[WheelIndex].CollisionRadius, bUseLineTrace, OutHit);
+
+	++ContactCacheHits;
+	INC_DWORD_STAT(STAT_PrvMovementContactCacheHits);
+
+	return true;
+}
+
+void UPrvVehicleMovementComponent::CacheWheelContact(int32 WheelIndex, const FVector& SuspWorldLocation, const FVector& SuspUpVector, bool bLineTrace, bool bHitValid, const FHitResult& Hit)
+{
+	if (!WheelContactCache.IsValidIndex(WheelIndex))
+	{
+		return;
+	}
+
+	++ContactCacheMisses;
+	INC_DWORD_STAT(STAT_PrvMovementContactCacheMisses);
+
+	// Wheels in the air are traced every tick
+	FPrvWheelContactCache& ContactCache = WheelContactCache[WheelIndex];
+	ContactCache.bValid = bHitValid && Hit.Component.IsValid() && Hit.Component->Mobility == EComponentMobility::Static;
+
+	if (ContactCache.bValid)
+	{
+		ContactCache.Hit = Hit;
+		ContactCache.SuspWorldLocation = SuspWorldLocation;
+		ContactCache.SuspUpVector = SuspUpVector;
+		ContactCache.TraceTime = GetWorld()->GetTimeSeconds();
+		ContactCache.bLineTrace = bLineTrace;
+	}
+}
+
+void UPrvVehicleMovementComponent::RequestAsyncSuspensionTrace(int32 WheelIndex, const FVector& SuspWorldLocation, const FVector& SuspTraceEndLocation, const FVector& RadiusUpVector, bool bUseLineTrace)
+{
+	UWorld* World = GetWorld();
+	if (!World || !AsyncSuspensionTraces.IsValidIndex(WheelIndex) || !WheelsState.IsValidIndex(WheelIndex))
+	{
+		return;
+	}
+
+	FSuspensionAsyncTrace& AsyncTrace = AsyncSuspensionTraces[WheelIndex];
+	AsyncTrace.bLineTrace = bUseLineTrace;
+	AsyncTrace.bMultiTrace = FMath::Abs(DefaultCollisionWidth) > SMALL_NUMBER && !bUseLineTrace;
+
+	FCollisionQueryParams QueryParams(NAME_PrvSuspensionTrace, bTraceComplex, GetOwner());
+	QueryParams.bTraceAsyncScene = true;
+	QueryParams.bReturnPhysicalMaterial = true;
+
+	const ECollisionChannel TraceChannel = UEngineTypes::ConvertToCollisionChannel(SuspensionTraceTypeQuery);
+
+	if (AsyncTrace.bLineTrace)
+	{
+		AsyncTrace.Handle = World->AsyncLineTraceByChannel(EAsyncTraceType::Single, SuspWorldLocation + RadiusUpVector, SuspTraceEndLocation - RadiusUpVector, TraceChannel, QueryParams);
+	}
+	else
+	{
+		const FCollisionShape WheelShape = FCollisionShape::MakeSphere(SuspensionSetup[WheelIndex].CollisionRadius);
+		const EAsyncTraceType TraceType = AsyncTrace.bMultiTrace ? EAsyncTraceType::Multi : EAsyncTraceType::Single;
+		AsyncTrace.Handle = World->AsyncSweepByChannel(TraceType, SuspWorldLocation, SuspTraceEndLocation, TraceChannel, WheelShape, QueryParams);
+	}
+
+	INC_DWORD_STAT(STAT_PrvMovementAsyncTraces);
+	PRV_INC_ROLE_STAT_BY(GetOwnerRole(), STAT_PrvSuspensionTraces, 1);
+	INC_FLOAT_STAT_BY(STAT_PrvMovementAsyncTracesOffloadedTime, GPrvAverageSyncTraceMs);
+}
+
+bool UPrvVehicleMovementComponent::ConsumeAsyncSuspensionTrace(int32 WheelIndex, const FVector& SuspWorldLocation, const FVector& SuspUpVector, FHitResult& OutHit, bool& bOutHit, bool& bOutHitValid, bool& bOutLineTrace)
+{
+	UWorld* World = GetWorld();
+	if (!World || !AsyncSuspensionTraces.IsValidIndex(WheelIndex))
+	{
+		return false;
+	}
+
+	FSuspensionAsyncTrace& AsyncTrace = AsyncSuspensionTraces[WheelIndex];
+	if (!AsyncTrace.Handle.IsValid())
+	{
+		return false;
+	}
+
+	// Check the trace is already done (it shouldn't be on the first tick)
+	FTraceDatum TraceDatum;
+	const bool bTraceReady = World->QueryTraceData(AsyncTrace.Handle, TraceDatum);
+	AsyncTrace.Handle = FTraceHandle();
+
+	if (!bTraceReady)
+	{
+		return false;
+	}
+
+	const FSuspensionInfo& SuspInfo = SuspensionSetup[WheelIndex];
+
+	bOutLineTrace = AsyncTrace.bLineTrace;
+	bOutHit = false;
+	bOutHitValid = false;
+
+	if (AsyncTrace.bMultiTrace)
+	{
+		bOutHit = TraceDatum.OutHits.Num() > 0;
+		bOutHitValid = SelectWheelHit(WheelIndex, TraceDatum.OutHits, OutHit);
+	}
+	else
+	{
+		for (const FHitResult& MyHit : TraceDatum.OutHits)
+		{
+			if (MyHit.bBlockingHit)
+			{
+				OutHit = MyHit;
+				bOutHit = true;
+				bOutHitValid = true;
+				break;
+			}
+		}
+	}
+
+	// Penetration hits have no valid impact point, so use them as is
+	if (!bOutHitValid || OutHit.bStartPenetrating)
+	{
+		return true;
+	}
+
+	// Hit was made one tick ago: move contact plane into current suspension transform
+	const FVector PlanePoint = OutHit.ImpactPoint;
+	const FVector PlaneNormal = OutHit.ImpactNormal;
+	bOutHitValid = PrvWheelPlaneContact(PlanePoint, PlaneNormal, SuspWorldLocation, SuspUpVector,
+		SuspInfo.Length + SuspInfo.MaxDrop, SuspInfo.CollisionRadius, bOutLineTrace, OutHit);
+
+	return true;
+}
+
+void UPrvVehicleMovementComponent::BenchmarkSuspension(int32 Iterations)
+{
+	if (!UpdatedMesh || WheelsState.Num() == 0 || Iterations <= 0)
+	{
+		return;
+	}
+
+	// Benchmark shouldn't affect simulation state
+	const FPrvWheelsState SavedWheelsState = WheelsState;
+	const int32 SavedActiveFrictionPoints = ActiveFrictionPoints;
+	const int32 SavedActiveDrivenFrictionPoints = ActiveDrivenFrictionPoints;
+	const bool bSavedAsyncSuspensionTraces = bAsyncSuspensionTraces;
+	const bool bSavedSuspensionContactCache = bSuspensionContactCache;
+	const bool bSavedTraceBudgetStarved = bTraceBudgetStarved;
+	const int32 SavedUntracedWheels = UntracedWheels;
+	const bool bSavedShowDebug = bShowDebug;
+	bAsyncSuspensionTraces = false;
+	bSuspensionContactCache = false;
+	bTraceBudgetStarved = false;
+	bShowDebug = false;
+	SimTransform = UpdatedMesh->GetComponentTransform();
+
+	const float DeltaTime = 1.f / 60.f;
+	const bool bUseLineTrace = UseLineTrace();
 
-				if (SuspState.VisualLength < Hit.Distance)
+	const double VisualsStartTime = FPlatformTime::Seconds();
+	for (int32 i = 0; i < Iterations; ++i)
+	{
+		if (bWheeledVehicle)
+		{
+			UpdateSuspensionKernel<FPrvSuspensionVisualsPolicy, true>(DeltaTime, bUseLineTrace);
+		}
+		else
+		{
+			UpdateSuspensionKernel<FPrvSuspensionVisualsPolicy, false>(DeltaTime, bUseLineTrace);
+		}
+	}
+	const double VisualsTime = FPlatformTime::Seconds() - VisualsStartTime;
+
+	const double PhysicsStartTime = FPlatformTime::Seconds();
+	for (int32 i = 0; i < Iterations; ++i)
+	{
+		if (bWheeledVehicle)
+		{
+			UpdateSuspensionKernel<FPrvSuspensionDryRunPolicy, true>(DeltaTime, bUseLineTrace);
+		}
+		else
+		{
+			UpdateSuspensionKernel<FPrvSuspensionDryRunPolicy, false>(DeltaTime, bUseLineTrace);
+		}
+	}
+	const double PhysicsTime = FPlatformTime::Seconds() - PhysicsStartTime;
+
+#if PRV_BENCHMARK_LEGACY_SUSPENSION
+	// Separate physics and visuals suspension updates before the shared kernel: per-wheel mesh transform reads,
+	// damping corrections evaluated every tick without cached coefficients (forces are not applied)
+	auto LegacyUpdateSuspension = [this, DeltaTime, bUseLineTrace](bool bComputeForces)
+	{
+		const int32 ActiveWheelsNum = ActiveFrictionPoints;
+		if (bComputeForces)
+		{
+			ActiveFrictionPoints = 0;
+			ActiveDrivenFrictionPoints = 0;
+		}
+
+		TArray<AActor*> IgnoredActors;
+		const EDrawDebugTrace::Type DebugType = EDrawDebugTrace::None;
+
+		for (int32 WheelIndex = 0; WheelIndex < WheelsState.Num(); ++WheelIndex)
+		{
+			const FSuspensionInfo& SuspInfo = SuspensionSetup[WheelIndex];
+			const FRotator& SuspRotation = WheelsState.Rotation[WheelIndex];
+
+			const FVector SuspUpVector = UpdatedMesh->GetComponentTransform().TransformVectorNoScale(UKismetMathLibrary::GetUpVector(SuspRotation));
+			const FVector SuspWorldLocation = UpdatedMesh->GetComponentTransform().TransformPosition(SuspInfo.Location);
+			const FVector SuspTraceEndLocation = SuspWorldLocation - SuspUpVector * (SuspInfo.Length + SuspInfo.MaxDrop);
+			const FVector RadiusUpVector = SuspUpVector * SuspInfo.CollisionRadius;
+
+			FHitResult Hit;
+			bool bHit = false;
+			bool bHitValid = false;
+
+			if (FMath::Abs(DefaultCollisionWidth) > SMALL_NUMBER && !bUseLineTrace)
+			{
+				TArray<FHitResult> Hits;
+
+#if ENGINE_MINOR_VERSION >= 15
+				bHit = UKismetSystemLibrary::SphereTraceMulti(this, SuspWorldLocation, SuspTraceEndLocation, SuspInfo.CollisionRadius, SuspensionTraceTypeQuery, bTraceComplex, IgnoredActors, DebugType, Hits, true);
+#else
+				bHit = UKismetSystemLibrary::SphereTraceMulti_NEW(this, SuspWorldLocation, SuspTraceEndLocation, SuspInfo.CollisionRadius, SuspensionTraceTypeQuery, bTraceComplex, IgnoredActors, DebugType, Hits, true);
+#endif
+
+				float BestDistanceSquared = MAX_FLT;
+				for (auto MyHit : Hits)
+				{
+					if (!MyHit.bBlockingHit)
+					{
+						continue;
+					}
+
+					FVector HitLocation_SuspSpace = FVector::ZeroVector;
+					if (MyHit.bStartPenetrating)
+					{
+						HitLocation_SuspSpace = (MyHit.PenetrationDepth - SuspInfo.CollisionRadius) * UpdatedMesh->GetComponentTransform().InverseTransformVectorNoScale(MyHit.Normal);
+					}
+					else
+					{
+						HitLocation_SuspSpace = UpdatedMesh->GetComponentTransform().InverseTransformPosition(MyHit.ImpactPoint) - SuspInfo.Location;
+					}
+
+					HitLocation_SuspSpace = SuspRotation.UnrotateVector(HitLocation_SuspSpace);
+
+					if (FMath::Abs(HitLocation_SuspSpace.Y) < (SuspInfo.CollisionWidth / 2.f) && HitLocation_SuspSpace.SizeSquared() < BestDistanceSquared)
+					{
+						BestDistanceSquared = HitLocation_SuspSpace.SizeSquared();
+						Hit = MyHit;
+						bHitValid = true;
+					}
+				}
+			}
+			else
+			{
+				if (bUseLineTrace)
 				{
-					SuspState.VisualLength = FMath::Lerp(SuspState.VisualLength, Hit.Distance, FMath::Clamp(DeltaTime * DropFactor, 0.f, 1.f));
+#if ENGINE_MINOR_VERSION >= 15
+					bHit = UKismetSystemLibrary::LineTraceSingle(this, SuspWorldLocation + RadiusUpVector, SuspTraceEndLocation - RadiusUpVector, SuspensionTraceTypeQuery, bTraceComplex, IgnoredActors, DebugType, Hit, true);
+#else
+					bHit = UKismetSystemLibrary::LineTraceSingle_NEW(this, SuspWorldLocation + RadiusUpVector, SuspTraceEndLocation - RadiusUpVector, SuspensionTraceTypeQuery, bTraceComplex, IgnoredActors, DebugType, Hit, true);
+#endif
 				}
 				else
 				{
-					SuspState.VisualLength = Hit.Distance;
+#if ENGINE_MINOR_VERSION >= 15
+					bHit = UKismetSystemLibrary::SphereTraceSingle(this, SuspWorldLocation, SuspTraceEndLocation, SuspInfo.CollisionRadius, SuspensionTraceTypeQuery, bTraceComplex, IgnoredActors, DebugType, Hit, true);
+#else
+					bHit = UKismetSystemLibrary::SphereTraceSingle_NEW(this, SuspWorldLocation, SuspTraceEndLocation, SuspInfo.CollisionRadius, SuspensionTraceTypeQuery, bTraceComplex, IgnoredActors, DebugType, Hit, true);
+#endif
+				}
+
+				bHitValid = bHit;
+			}
+
+			if (bUseLineTrace && bHitValid)
+			{
+				Hit.Location = Hit.ImpactPoint + RadiusUpVector;
+				Hit.Distance = (Hit.Location - SuspWorldLocation).Size();
+			}
+
+			if (bHitValid && UpdatedMesh->GetComponentTransform().InverseTransformPosition(Hit.ImpactPoint).Z >= SuspInfo.Location.Z)
+			{
+				Hit.ImpactPoint = SuspWorldLocation;
+				Hit.ImpactNormal = SuspUpVector;
+				Hit.Distance = 0.f;
+			}
+
+			if (bHitValid)
+			{
+				const float NewSuspensionLength = FMath::Clamp(Hit.Distance, 0.f, SuspInfo.Length);
+
+				if (bComputeForces)
+				{
+					const float SpringCompressionRatio = FMath::Clamp((SuspInfo.Length - NewSuspensionLength) / SuspInfo.Length, 0.f, 1.f);
+					const float DiscreteSuspensionVelocity = (NewSuspensionLength - WheelsState.PreviousLength[WheelIndex]) / DeltaTime;
+					const float SuspensionStiffness = SuspInfo.Stiffness * StiffnessFactor;
+					float SuspensionDamping = (DiscreteSuspensionVelocity < 0) ? SuspInfo.CompressionDamping * CompressionDampingFactor : SuspInfo.DecompressionDamping * DecompressionDampingFactor;
+
+					float SuspensionVelocity = DiscreteSuspensionVelocity;
+					if (bCustomDampingCorrection && FMath::Abs(DampingCorrectionFactor) > SMALL_NUMBER && FMath::Abs(DiscreteSuspensionVelocity) > SMALL_NUMBER)
+					{
+						const float suspVel = DiscreteSuspensionVelocity / 100.f;
+						const float k = SuspensionStiffness / 100.f;
+						const float m = UpdatedMesh->GetMass();
+						const float b = SuspensionDamping / (2.f * m);
+						const float a = FMath::Sqrt(FMath::Max(1.f, FMath::Square(b) - (k / m)));
+						const float A = suspVel / (2.f * a);
+						const float dL_old = suspVel * DeltaTime;
+						const float dL_new = FMath::Exp(-b * DeltaTime) * (A * FMath::Exp(a * DeltaTime) - A * FMath::Exp(-a * DeltaTime));
+						SuspensionVelocity = suspVel * FMath::Pow(dL_new / dL_old, DampingCorrectionFactor);
+					}
+
+					if (bAdaptiveDampingCorrection)
+					{
+						const float D = SuspensionDamping / 100.f;
+						const float m = UpdatedMesh->GetMass();
+						const float AdaptiveExp = (1 - FMath::Exp((-D) * ActiveWheelsNum / m * DeltaTime));
+						if (FMath::Abs(AdaptiveExp) > SMALL_NUMBER)
+						{
+							SuspensionDamping = AdaptiveExp * m / (ActiveWheelsNum * DeltaTime) * 100.f;
+						}
+					}
+
+					float SuspensionForce = -SuspensionVelocity * SuspensionDamping + SpringCompressionRatio * SuspensionStiffness;
+					if (SuspensionForce < 0.f && bClampSuspensionForce)
+					{
+						SuspensionForce = 0.f;
+					}
+
+					WheelsState.SuspensionForce[WheelIndex] = SuspensionForce * (bWheeledVehicle ? Hit.ImpactNormal : SuspUpVector);
 				}
+
+				WheelsState.WheelCollisionLocation[WheelIndex] = Hit.ImpactPoint;
+				WheelsState.WheelCollisionNormal[WheelIndex] = Hit.ImpactNormal;
+				WheelsState.PreviousLength[WheelIndex] = NewSuspensionLength;
+				WheelsState.WheelTouchedGround[WheelIndex] = true;
+				WheelsState.SurfaceType[WheelIndex] = UGameplayStatics::GetSurfaceType(Hit);
+				WheelsState.VisualLength[WheelIndex] = (WheelsState.VisualLength[WheelIndex] < Hit.Distance) ?
+					FMath::Lerp(WheelsState.VisualLength[WheelIndex], Hit.Distance, FMath::Clamp(DeltaTime * DropFactor, 0.f, 1.f)) : Hit.Distance;
+
+				if (bComputeForces)
+				{
+					ActiveFrictionPoints++;
+					if (!bWheeledVehicle || SuspInfo.bDrivingWheel)
+					{
+						ActiveDrivenFrictionPoints++;
+					}
+				}
+			}
+			else
+			{
+				WheelsState.SuspensionForce[WheelIndex] = FVector::ZeroVector;
+				WheelsState.WheelCollisionLocation[WheelIndex] = FVector::ZeroVector;
+				WheelsState.WheelCollisionNormal[WheelIndex] = FVector::UpVector;
+				WheelsState.PreviousLength[WheelIndex] = SuspInfo.Length;
+				WheelsState.VisualLength[WheelIndex] = FMath::Lerp(WheelsState.VisualLength[WheelIndex], SuspInfo.Length + SuspInfo.MaxDrop, FMath::Clamp(DeltaTime * DropFactor, 0.f, 1.f));
+				WheelsState.WheelTouchedGround[WheelIndex] = false;
+				WheelsState.SurfaceType[WheelIndex] = EPhysicalSurface::SurfaceType_Default;
+			}
+		}
+	};
+
+	const double LegacyVisualsStartTime = FPlatformTime::Seconds();
+	for (int32 i = 0; i < Iterations; ++i)
+	{
+		LegacyUpdateSuspension(false);
+	}
+	const double LegacyVisualsTime = FPlatformTime::Seconds() - LegacyVisualsStartTime;
+
+	const double LegacyPhysicsStartTime = FPlatformTime::Seconds();
+	for (int32 i = 0; i < Iterations; ++i)
+	{
+		LegacyUpdateSuspension(true);
+	}
+	const double LegacyPhysicsTime = FPlatformTime::Seconds() - LegacyPhysicsStartTime;
+#endif // PRV_BENCHMARK_LEGACY_SUSPENSION
+
+	WheelsState = SavedWheelsState;
+	ActiveFrictionPoints = SavedActiveFrictionPoints;
+	ActiveDrivenFrictionPoints = SavedActiveDrivenFrictionPoints;
+	bAsyncSuspensionTraces = bSavedAsyncSuspensionTraces;
+	bSuspensionContactCache = bSavedSuspensionContactCache;
+	bTraceBudgetStarved = bSavedTraceBudgetStarved;
+	UntracedWheels = SavedUntracedWheels;
+	bShowDebug = bSavedShowDebug;
+
+	UE_LOG(LogPrvVehicle, Log, TEXT("Suspension benchmark (%s, %d wheels, %d iterations): visuals only %.3f us, physics %.3f us per tick"),
+		*GetOwner()->GetName(), WheelsState.Num(), Iterations, VisualsTime * 1000000.0 / Iterations, PhysicsTime * 1000000.0 / Iterations);
+
+#if PRV_BENCHMARK_LEGACY_SUSPENSION
+	UE_LOG(LogPrvVehicle, Log, TEXT("Suspension benchmark (%s, legacy): visuals only %.3f us (x%.2f), physics %.3f us (x%.2f) per tick"),
+		*GetOwner()->GetName(), LegacyVisualsTime * 1000000.0 / Iterations, (VisualsTime > 0.0) ? (LegacyVisualsTime / VisualsTime) : 0.0,
+		LegacyPhysicsTime * 1000000.0 / Iterations, (PhysicsTime > 0.0) ? (LegacyPhysicsTime / PhysicsTime) : 0.0);
+#endif
+}
+
+static void PrvBenchmarkSuspension(const TArray<FString>& Args, UWorld* World)
+{
+	const int32 Iterations = (Args.Num() > 0) ? FCString::Atoi(*Args[0]) : 1000;
+
+	for (TObjectIterator<UPrvVehicleMovementComponent> It; It; ++It)
+	{
+		if (It->GetWorld() == World && !It->IsTemplate())
+		{
+			It->BenchmarkSuspension(Iterations);
+		}
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs PrvBenchmarkSuspensionCommand(
+	TEXT("PrvVehicle.BenchmarkSuspension"),
+	TEXT("Measures visuals-only and physics suspension kernels for every vehicle in the world (and legacy paths if built with PRV_BENCHMARK_LEGACY_SUSPENSION). Usage: PrvVehicle.BenchmarkSuspension [Iterations]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&PrvBenchmarkSuspension));
+
+static void PrvDumpContactCacheStats(const TArray<FString>& Args, UWorld* World)
+{
+	for (TObjectIterator<UPrvVehicleMovementComponent> It; It; ++It)
+	{
+		if (It->GetWorld() == World && !It->IsTemplate())
+		{
+			UE_LOG(LogPrvVehicle, Log, TEXT("Contact cache (%s): %s, hit rate %.1f%%"),
+				*It->GetOwner()->GetName(), It->bSuspensionContactCache ? TEXT("enabled") : TEXT("disabled"), It->GetContactCacheHitRate() * 100.f);
+		}
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs PrvDumpContactCacheStatsCommand(
+	TEXT("PrvVehicle.ContactCacheStats"),
+	TEXT("Logs suspension contact cache hit rate for every vehicle in the world"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&PrvDumpContactCacheStats));
+
+static void PrvDumpTraceBudgetStats(const TArray<FString>& Args, UWorld* World)
+{
+	for (TObjectIterator<UPrvVehicleMovementComponent> It; It; ++It)
+	{
+		if (It->GetWorld() == World && !It->IsTemplate())
+		{
+			UE_LOG(LogPrvVehicle, Log, TEXT("Trace budget (%s): starved %.1f%% of frames"),
+				*It->GetOwner()->GetName(), It->GetTraceBudgetStarvedRate() * 100.f);
+		}
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs PrvDumpTraceBudgetStatsCommand(
+	TEXT("PrvVehicle.TraceBudgetStats"),
+	TEXT("Logs how often every vehicle in the world was starved by suspension trace budget (see PrvVehicle.SuspensionTraceBudget)"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&PrvDumpTraceBudgetStats));
+
+void UPrvVehicleMovementComponent::UpdateFriction(float DeltaTime)
+{
+	PRV_CYCLE_COUNTER(STAT_PrvMovementUpdateFriction);
+
+	// Rebuilt by PreSimulate on game thread
+	check(!bSimulationCacheDirty);
+
+	const FPrvFrictionSettings& FrictionSettings = CachedFrictionSettings;
+
+	FPrvFrictionBodyState BodyState;
+	BodyState.Rotation = SimTransform.GetRotation();
+	BodyState.Mass = UpdatedMesh->GetMass();
+	BodyState.GravityZ = UPhysicsSettings::Get()->DefaultGravityZ;
+	BodyState.NumWheels = WheelsState.Num();
+	BodyState.ActiveFrictionPoints = ActiveFrictionPoints;
+	BodyState.ActiveDrivenFrictionPoints = ActiveDrivenFrictionPoints;
+	BodyState.bReverseGear = bReverseGear;
+
+	// Reset tracks friction
+	FPrvTrackDrive LeftTrackDrive = MakeTrackDrive(LeftTrack);
+	FPrvTrackDrive RightTrackDrive = MakeTrackDrive(RightTrack);
+
+	// Process suspension
+	for (int32 WheelIndex = 0; WheelIndex < WheelsState.Num(); ++WheelIndex)
+	{
+		const FSuspensionInfo& SuspInfo = SuspensionSetup[WheelIndex];
+
+		if (WheelsState.WheelTouchedGround[WheelIndex])
+		{
+			// Cache current track info
+			FPrvTrackDrive& WheelTrack = (SuspInfo.bRightTrack) ? RightTrackDrive : LeftTrackDrive;
+
+			FPrvWheelFrictionInput WheelInput;
+			WheelInput.WheelDirection = WheelsState.Rotation[WheelIndex].RotateVector(SimTransform.GetRotation().GetForwardVector());
+			WheelInput.WheelCollisionNormal = WheelsState.WheelCollisionNormal[WheelIndex];
+			WheelInput.PreviousWheelCollisionVelocity = WheelsState.PreviousWheelCollisionVelocity[WheelIndex];
+			WheelInput.SuspensionForce = WheelsState.SuspensionForce[WheelIndex];
+			WheelInput.bDrivenWheel = !bWheeledVehicle || SuspInfo.bDrivingWheel;
+
+			// Get Velocity at location
+			if (bUseCustomVelocityCalculations)
+			{
+				const FVector PlaneLocalVelocity = GetOwner()->GetTransform().InverseTransformVectorNoScale(UpdatedMesh->GetPhysicsLinearVelocity());
+				const FVector PlaneAngularVelocity = GetOwner()->GetTransform().InverseTransformVectorNoScale(UpdatedMesh->GetPhysicsAngularVelocity());
+				const FVector LocalCOM = GetOwner()->GetTransform().InverseTransformPosition(UpdatedMesh->GetCenterOfMass());
+				const FVector LocalCollisionLocation = GetOwner()->GetTransform().InverseTransformPosition(WheelsState.WheelCollisionLocation[WheelIndex]);
+				const FVector LocalPointVelocity = PlaneLocalVelocity + FVector::CrossProduct(FMath::DegreesToRadians(PlaneAngularVelocity), (LocalCollisionLocation - LocalCOM));
+				WheelInput.WheelPointVelocity = GetOwner()->GetTransform().TransformVectorNoScale(LocalPointVelocity);
 			}
 			else
 			{
-				// If there is no collision then suspension is relaxed
-				SuspState.SuspensionForce = FVector::ZeroVector;
-				SuspState.WheelCollisionLocation = FVector::ZeroVector;
-				SuspState.WheelCollisionNormal = FVector::UpVector;
-				SuspState.PreviousLength = SuspState.SuspensionInfo.Length;
-				SuspState.VisualLength = FMath::Lerp(SuspState.VisualLength, SuspState.SuspensionInfo.Length + SuspState.SuspensionInfo.MaxDrop, FMath::Clamp(DeltaTime * DropFactor, 0.f, 1.f));
-				SuspState.WheelTouchedGround = false;
-				SuspState.SurfaceType = EPhysicalSurface::SurfaceType_Default;
+				WheelInput.WheelPointVelocity = UpdatedMesh->GetPhysicsLinearVelocityAtPoint(WheelsState.WheelCollisionLocation[WheelIndex]);
+			}
+
+			// Consider velocity predicted by fixed substeps
+			WheelInput.WheelPointVelocity += SimLinearVelocityOffset;
+
+			const FPrvWheelFrictionResult Friction = FPrvVehicleSimulation::CalculateWheelFriction(FrictionSettings, BodyState, WheelTrack, WheelInput, DeltaTime);
+
+			WheelsState.WheelLoad[WheelIndex] = Friction.WheelLoad;
+
+			// Cache last velocity
+			WheelsState.PreviousWheelCollisionVelocity[WheelIndex] = Friction.WheelCollisionVelocity;
+
+			bUseKineticFriction = Friction.bUseKineticFriction;
+
+			// Apply force to mesh
+			if (ShouldAddForce())
+			{
+				AddSimForceAtLocation(Friction.ApplicationForce, WheelsState.WheelCollisionLocation[WheelIndex]);
 			}
 
-			// @todo Possible push some suspension force to environment
-
+			/////////////////////////////////////////////////////////////////////////
 			// Debug
+
 			if (bShowDebug)
 			{
-				// Suspension length
-				DrawDebugPoint(GetWorld(), SuspWorldLocation, 5.f, FColor(200, 0, 230), false, /*LifeTime*/ 0.f);
-				DrawDebugLine(GetWorld(), SuspWorldLocation, SuspWorldLocation - SuspUpVector * SuspState.PreviousLength, FColor::Blue, false, 0.f, 0, 4.f);
-				DrawDebugLine(GetWorld(), SuspWorldLocation, SuspWorldLocation - SuspUpVector * SuspState.SuspensionInfo.Length, FColor::Red, false, 0.f, 0, 2.f);
+				const FVector& WheelCollisionLocation = WheelsState.WheelCollisionLocation[WheelIndex];
 
-				// Draw wheel
-				if (bHit && SuspState.SuspensionInfo.CollisionWidth != 0.f)
+				// Friction type
+				if (bUseKineticFriction)
+				{
+					DrawDebugString(GetWorld(), WheelCollisionLocation, TEXT("Kinetic"), nullptr, FColor::Blue, 0.f);
+				}
+				else
 				{
-					FColor WheelColor = bHitValid ? FColor::Cyan : FColor::White;
-					FVector LineOffset = UpdatedMesh->GetComponentTransform().GetRotation().RotateVector(FVector(0.f, SuspState.SuspensionInfo.CollisionWidth / 2.f, 0.f));
-					LineOffset = SuspState.SuspensionInfo.Rotation.RotateVector(LineOffset);
-					DrawDebugCylinder(GetWorld(), Hit.Location - LineOffset, Hit.Location + LineOffset, SuspState.SuspensionInfo.CollisionRadius, 16, WheelColor, false, /*LifeTime*/ 0.f, 100);
+					DrawDebugString(GetWorld(), WheelCollisionLocation, TEXT("Static"), nullptr, FColor::Red, 0.f);
 				}
+
+				// Force application
+				DrawDebugLine(GetWorld(), WheelCollisionLocation, WheelCollisionLocation + Friction.ApplicationForce * 0.0001f, FColor::Cyan, false, 0.f, 0, 10.f);
+
+				// Wheel velocity vectors
+				DrawDebugLine(GetWorld(), WheelCollisionLocation, WheelCollisionLocation + Friction.WheelCollisionVelocity, FColor::Yellow, false, 0.f, 0, 8.f);
+				DrawDebugLine(GetWorld(), WheelCollisionLocation, WheelCollisionLocation + Friction.RelativeWheelVelocity, FColor::Blue, false, 0.f, 0, 8.f);
 			}
 		}
+		else 
+		{
+			// Reset wheel load
+			WheelsState.WheelLoad[WheelIndex] = 0.f;
+		}
 	}
 
-	// -- [Car] --
-	if (bWheeledVehicle)
+	// Tracks friction
+	LeftTrack.AngularSpeed = LeftTrackDrive.AngularSpeed;
+	LeftTrack.KineticFrictionTorque = LeftTrackDrive.KineticFrictionTorque;
+	LeftTrack.RollingFrictionTorque = LeftTrackDrive.RollingFrictionTorque;
+
+	RightTrack.AngularSpeed = RightTrackDrive.AngularSpeed;
+	RightTrack.KineticFrictionTorque = RightTrackDrive.KineticFrictionTorque;
+	RightTrack.RollingFrictionTorque = RightTrackDrive.RollingFrictionTorque;
+}
+
+FPrvTrackDrive UPrvVehicleMovementComponent::MakeTrackDrive(const FTrackInfo& Track) const
+{
+	FPrvTrackDrive TrackDrive;
+	TrackDrive.LinearSpeed = Track.LinearSpeed;
+	TrackDrive.AngularSpeed = Track.AngularSpeed;
+	TrackDrive.TorqueTransfer = Track.TorqueTransfer;
+	TrackDrive.BrakeRatio = Track.BrakeRatio;
+	TrackDrive.DriveForce = Track.DriveForce;
+
+	return TrackDrive;
+}
+
+FPrvSuspensionSettings UPrvVehicleMovementComponent::GetSuspensionSettings() const
+{
+	FPrvSuspensionSettings Settings;
+	Settings.StiffnessFactor = StiffnessFactor;
+	Settings.CompressionDampingFactor = CompressionDampingFactor;
+	Settings.DecompressionDampingFactor = DecompressionDampingFactor;
+	Settings.bCustomDampingCorrection = bCustomDampingCorrection;
+	Settings.DampingCorrectionFactor = DampingCorrectionFactor;
+	Settings.bAdaptiveDampingCorrection = bAdaptiveDampingCorrection;
+	Settings.bClampSuspensionForce = bClampSuspensionForce;
+	Settings.bDebugDampingCorrection = bDebugDampingCorrection;
+
+	return Settings;
+}
+
+FPrvFrictionSettings UPrvVehicleMovementComponent::GetFrictionSettings() const
+{
+	FPrvFrictionSettings Settings;
+	Settings.StaticFrictionCoefficientEllipse = StaticFrictionCoefficientEllipse;
+	Settings.KineticFrictionCoefficientEllipse = KineticFrictionCoefficientEllipse;
+	Settings.KineticFrictionTorqueCoefficient = KineticFrictionTorqueCoefficient;
+	Settings.RollingFrictionCoefficient = RollingFrictionCoefficient;
+	Settings.LinearSpeedPower = LinearSpeedPower;
+	Settings.RollingVelocityCoefficientSquared = RollingVelocityCoefficientSquared;
+	Settings.RollingVelocityFactor = FMath::Square(RollingVelocityCoefficientSquared);
+	Settings.SprocketRadius = SprocketRadius;
+	Settings.SprocketMass = SprocketMass;
+	Settings.TrackMass = TrackMass;
+	Settings.bScaleForceToActiveFrictionPoints = bScaleForceToActiveFrictionPoints;
+
+	return Settings;
+}
+
+void UPrvVehicleMovementComponent::UpdateLinearVelocity(float DeltaTime)
+{
+	PRV_CYCLE_COUNTER(STAT_PrvMovementUpdateLinearVelocity);
+
+	if (ShouldAddForce() && bCustomLinearDamping)
 	{
-		// Update driving wheels for wheeled vehicles
-		for (auto& SuspState : SuspensionData)
+		const FVector LocalLinearVelocity = UpdatedMesh->GetComponentTransform().InverseTransformVectorNoScale(GetBodyLinearVelocity());
+		const FVector SignVector = FVector(FMath::Sign(LocalLinearVelocity.X), FMath::Sign(LocalLinearVelocity.Y), FMath::Sign(LocalLinearVelocity.Z));
+		FVector NewLinearVelocity = LocalLinearVelocity - DeltaTime * (SignVector * DryFrictionLinearDamping + FluidFrictionLinearDamping * LocalLinearVelocity);
+
+		// Clamp to zero vector in per-component basis
+		NewLinearVelocity.X = SignVector.X * FMath::Max(0.f, SignVector.X * NewLinearVelocity.X);
+		NewLinearVelocity.Y = SignVector.Y * FMath::Max(0.f, SignVector.Y * NewLinearVelocity.Y);
+		NewLinearVelocity.Z = SignVector.Z * FMath::Max(0.f, SignVector.Z * NewLinearVelocity.Z);
+
+		SetBodyLinearVelocity(UpdatedMesh->GetComponentTransform().TransformVectorNoScale(NewLinearVelocity));
+
+		if (bDebugCustomDamping)
 		{
-			if (SuspState.SuspensionInfo.bSteeringWheel)
-			{
-				SuspState.SuspensionInfo.Rotation.Yaw = FMath::Lerp(SuspState.SuspensionInfo.Rotation.Yaw, EffectiveSteeringAngularSpeed, DeltaTime * (SteeringUpRatio + SteeringDownRatio) / 2.f);
-			}
+			UE_LOG(LogPrvVehicle, Error, TEXT("Linear damping WAS: %s, NOW: %s"), *LocalLinearVelocity.ToString(), *NewLinearVelocity.ToString());
 		}
 	}
 }
 
-void UPrvVehicleMovementComponent::UpdateFriction(float DeltaTime)
+void UPrvVehicleMovementComponent::UpdateAngularVelocity(float DeltaTime)
 {
-	PRV_CYCLE_COUNTER(STAT_PrvMovementUpdateFriction);
+	PRV_CYCLE_COUNTER(STAT_PrvMovementUpdateAngularVelocity);
 
-	// Reset tracks friction
-	RightTrack.KineticFrictionTorque = 0.f;
-	RightTrack.RollingFrictionTorque = 0.f;
-	LeftTrack.KineticFrictionTorque = 0.f;
-	LeftTrack.RollingFrictionTorque = 0.f;
-	
-	float MinimumWheelAngularSpeedLeft = BIG_NUMBER;
-	float MinimumWheelAngularSpeedRight = BIG_NUMBER;
+	if (ShouldAddForce() && bCustomAngularDamping)
+	{
+		const FVector LocalAngularVelocity = UpdatedMesh->GetComponentTransform().InverseTransformVectorNoScale(GetBodyAngularVelocity());
+		const FVector SignVector = FVector(FMath::Sign(LocalAngularVelocity.X), FMath::Sign(LocalAngularVelocity.Y), FMath::Sign(LocalAngularVelocity.Z));
+		FVector NewAngularVelocity = LocalAngularVelocity - DeltaTime * (SignVector * DryFrictionAngularDamping + FluidFrictionAngularDamping * LocalAngularVelocity);
 
-	// Process suspension
-	for (auto& SuspState : SuspensionData)
+		// Clamp to zero vector in per-component basis
+		NewAngularVelocity.X = SignVector.X * FMath::Max(0.f, SignVector.X * NewAngularVelocity.X);
+		NewAngularVelocity.Y = SignVector.Y * FMath::Max(0.f, SignVector.Y * NewAngularVelocity.Y);
+		NewAngularVelocity.Z = SignVector.Z * FMath::Max(0.f, SignVector.Z * NewAngularVelocity.Z);
+
+		SetBodyAngularVelocity(UpdatedMesh->GetComponentTransform().TransformVectorNoScale(NewAngularVelocity));
+
+		if (bDebugCustomDamping)
+		{
+			UE_LOG(LogPrvVehicle, Error, TEXT("Angular damping WAS: %s, NOW: %s"), *LocalAngularVelocity.ToString(), *NewAngularVelocity.ToString());
+		}
+	}
+}
+
+void UPrvVehicleMovementComponent::AnimateWheels(float DeltaTime)
+{
+	PRV_CYCLE_COUNTER(STAT_PrvMovementAnimateWheels);
+
+	for (int32 WheelIndex = 0; WheelIndex < WheelsState.Num(); ++WheelIndex)
+	{
+		const FSuspensionInfo& SuspInfo = SuspensionSetup[WheelIndex];
+		const float EffectiveAngularSpeed = (SuspInfo.bRightTrack) ? RightTrackEffectiveAngularSpeed : LeftTrackEffectiveAngularSpeed;
+
+		WheelsState.RotationAngle[WheelIndex] -= FMath::RadiansToDegrees(EffectiveAngularSpeed) * DeltaTime * (SprocketRadius / VisualCollisionRadius);
+		WheelsState.RotationAngle[WheelIndex] = FRotator::NormalizeAxis(WheelsState.RotationAngle[WheelIndex]);
+		WheelsState.SteeringAngle[WheelIndex] = WheelsState.Rotation[WheelIndex].Yaw;
+	}
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Network
+
+/** Unpack input quantized as 3222 2222 1111 1111 (see QuantizeInput) */
+static void PrvDecodeInput(uint16 InQuantizeInput, int32& OutThrottle, int32& OutSteering, bool& bOutHandbrake)
+{
+	OutThrottle = (int8)(InQuantizeInput & 0xFF);
+	OutSteering = ((int8)(((InQuantizeInput >> 8) & 0x7F) << 1)) / 2;
+	bOutHandbrake = ((InQuantizeInput >> 15) & 1) != 0;
+}
+
+/** Input axis change is significant if it's bigger than deadband or the axis reaches its zero or full value */
+static bool PrvIsInputAxisChanged(int32 OldValue, int32 NewValue, int32 MaxValue, float Deadband)
+{
+	if (OldValue == NewValue)
+	{
+		return false;
+	}
+
+	return (NewValue == 0) || (FMath::Abs(NewValue) >= MaxValue) || (FMath::Abs(NewValue - OldValue) > Deadband * MaxValue);
+}
+
+bool FPrvInputPacket::NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
+{
+	Ar << Sequence;
+
+	uint8 EpochBits = Epoch % MaxEpochs;
+	Ar.SerializeBits(&EpochBits, 2);
+
+	if (Ar.IsLoading())
+	{
+		Epoch = EpochBits;
+	}
+
+	// Packet always has at least one input
+	uint8 NumInputsBits = FMath::Clamp<int32>(NumInputs - 1, 0, MaxInputs - 1);
+	Ar.SerializeBits(&NumInputsBits, 2);
+
+	if (Ar.IsLoading())
+	{
+		NumInputs = NumInputsBits + 1;
+	}
+
+	for (int32 i = 0; i < NumInputs; ++i)
+	{
+		Ar << Inputs[i];
+	}
+
+	bOutSuccess = true;
+	return true;
+}
+
+void UPrvVehicleMovementComponent::UpdateInputStream(uint16 NewQuantizeInput)
+{
+	const float WorldTime = GetWorld()->GetTimeSeconds();
+
+	if (InputHistoryNum == 0)
+	{
+		InputStatsStartTime = WorldTime;
+	}
+
+	// Queue the input if it's changed enough since the last queued one
+	bool bInputChanged = (InputHistoryNum == 0);
+	if (!bInputChanged)
+	{
+		int32 OldThrottle, OldSteering, NewThrottle, NewSteering;
+		bool bOldHandbrake, bNewHandbrake;
+		PrvDecodeInput(InputHistory[0], OldThrottle, OldSteering, bOldHandbrake);
+		PrvDecodeInput(NewQuantizeInput, NewThrottle, NewSteering, bNewHandbrake);
+
+		bInputChanged = (bOldHandbrake != bNewHandbrake) ||
+			PrvIsInputAxisChanged(OldThrottle, NewThrottle, 127, InputDeadband) ||
+			PrvIsInputAxisChanged(OldSteering, NewSteering, 63, InputDeadband);
+	}
+
+	if (bInputChanged)
 	{
-		if (SuspState.WheelTouchedGround)
+		for (int32 i = FPrvInputPacket::MaxInputs - 1; i > 0; --i)
 		{
-			// Cache current track info
-			FTrackInfo* WheelTrack = (SuspState.SuspensionInfo.bRightTrack) ? &RightTrack : &LeftTrack;
-			float& MinimumWheelAngularSpeed = (SuspState.SuspensionInfo.bRightTrack) ? MinimumWheelAngularSpeedLeft : MinimumWheelAngularSpeedRight;
+			InputHistory[i] = InputHistory[i - 1];
+		}
 
-			/////////////////////////////////////////////////////////////////////////
-			// Drive force
+		InputHistory[0] = NewQuantizeInput;
+		InputHistoryNum = FMath::Min(InputHistoryNum + 1, FPrvInputPacket::MaxInputs);
 
-			// Calculate wheel load
-			SuspState.WheelLoad = UKismetMathLibrary::ProjectVectorOnToVector(SuspState.SuspensionForce, SuspState.WheelCollisionNormal).Size();
+		QuantizeInput = NewQuantizeInput;
+		++InputSequence;
+		InputSequenceStartTime = WorldTime;
+		bInputPending = true;
+	}
 
-			// Wheel forward vector
-			const FVector WheelDirection = SuspState.SuspensionInfo.Rotation.RotateVector(UpdatedMesh->GetForwardVector());
+	// Unchanged input is resent from time to time in case the last packet was lost
+	const float TimeSinceLastSend = WorldTime - LastInputSendTime;
+	const bool bKeepAlive = (InputKeepAliveInterval > 0.f) && (TimeSinceLastSend >= InputKeepAliveInterval);
+	const bool bSendAllowed = (MaxInputSendRate <= 0.f) || (TimeSinceLastSend >= 1.f / MaxInputSendRate);
 
-			// Get Velocity at location
-			FVector WorldPointVelocity = FVector::ZeroVector;
-			if (bUseCustomVelocityCalculations)
-			{
-				const FVector PlaneLocalVelocity = GetOwner()->GetTransform().InverseTransformVectorNoScale(UpdatedMesh->GetPhysicsLinearVelocity());
-				const FVector PlaneAngularVelocity = GetOwner()->GetTransform().InverseTransformVectorNoScale(UpdatedMesh->GetPhysicsAngularVelocity());
-				const FVector LocalCOM = GetOwner()->GetTransform().InverseTransformPosition(UpdatedMesh->GetCenterOfMass());
-				const FVector LocalCollisionLocation = GetOwner()->GetTransform().InverseTransformPosition(SuspState.WheelCollisionLocation);
-				const FVector LocalPointVelocity = PlaneLocalVelocity + FVector::CrossProduct(FMath::DegreesToRadians(PlaneAngularVelocity), (LocalCollisionLocation - LocalCOM));
-				WorldPointVelocity = GetOwner()->GetTransform().TransformVectorNoScale(LocalPointVelocity);
-			}
-			else
-			{
-				WorldPointVelocity = UpdatedMesh->GetPhysicsLinearVelocityAtPoint(SuspState.WheelCollisionLocation);
-			}
+	if ((bInputPending || bKeepAlive) && bSendAllowed)
+	{
+		FPrvInputPacket Packet;
+		Packet.Sequence = InputSequence;
+		Packet.Epoch = InputEpoch;
+		Packet.NumInputs = FMath::Clamp(InputRedundancy, 1, InputHistoryNum);
+		FMemory::Memcpy(Packet.Inputs, InputHistory, sizeof(Packet.Inputs));
 
-			// Calculate wheel velocity relative to track (with simple Kalman filter)
-			const FVector WheelCollisionVelocity = (WorldPointVelocity + SuspState.PreviousWheelCollisionVelocity) / 2.f;
+		ServerUpdateInput(Packet);
 
-			// Cache last velocity
-			SuspState.PreviousWheelCollisionVelocity = WheelCollisionVelocity;
+		bInputPending = false;
+		LastInputSendTime = WorldTime;
 
-			// Apply linear friction
-			FVector WheelVelocity = FVector::ZeroVector - WheelCollisionVelocity;
+		const int32 PacketBytes = FMath::DivideAndRoundUp(Packet.GetNumBits(), 8);
+		++InputPackets;
+		InputBytes += PacketBytes;
 
-			// Add driving force
-			if (!bWheeledVehicle || SuspState.SuspensionInfo.bDrivingWheel)
-			{
-				WheelVelocity += (WheelDirection * WheelTrack->LinearSpeed);
-			}
+		INC_DWORD_STAT(STAT_PrvInputPacketsSent);
+		INC_DWORD_STAT_BY(STAT_PrvInputBytesSent, PacketBytes);
+	}
+}
+
+void UPrvVehicleMovementComponent::ApplyQuantizedInput(uint16 InQuantizeInput)
+{
+	int32 QThrottleInput, QSteeringInput;
+	bool bQHandbrakeInput;
+	PrvDecodeInput(InQuantizeInput, QThrottleInput, QSteeringInput, bQHandbrakeInput);
+
+	SetThrottleInput(QThrottleInput / 127.f);
+	SetSteeringInput(QSteeringInput / 63.f);
+	bRawHandbrakeInput = bQHandbrakeInput;
+
+	LastUserSteeringInput = QSteeringInput;
+}
+
+void UPrvVehicleMovementComponent::ResetInputStream()
+{
+	// [client] Server takes the next epoch as a new stream even if old packets are still in flight
+	InputEpoch = (InputEpoch + 1) % FPrvInputPacket::MaxEpochs;
+	InputSequence = 0;
+	InputHistoryNum = 0;
+	FMemory::Memzero(InputHistory);
+	bInputPending = false;
+	LastAckedSequence = 0;
+	LastAckedTimeSinceInput = -1.f;
+	PredictionHistory.Reset();
+
+	// [server] Previous driver epoch means nothing for the new one
+	LastAppliedInputSequence = 0;
+	bAcceptAnyInputEpoch = true;
+}
+
+bool UPrvVehicleMovementComponent::ServerUpdateInput_Validate(const FPrvInputPacket& InPacket)
+{
+	return InPacket.NumInputs > 0 && InPacket.NumInputs <= FPrvInputPacket::MaxInputs;
+}
+
+void UPrvVehicleMovementComponent::ServerUpdateInput_Implementation(const FPrvInputPacket& InPacket)
+{
+	if (InputPackets == 0)
+	{
+		InputStatsStartTime = GetWorld()->GetTimeSeconds();
+	}
+
+	++InputPackets;
+	InputBytes += FMath::DivideAndRoundUp(InPacket.GetNumBits(), 8);
+	INC_DWORD_STAT(STAT_PrvInputPacketsReceived);
+
+	// Newer epoch restarts the stream, packets of older epochs are outdated (epochs wrap around)
+	if (InPacket.Epoch != LastAppliedInputEpoch || bAcceptAnyInputEpoch)
+	{
+		const int32 EpochDelta = (InPacket.Epoch - LastAppliedInputEpoch + FPrvInputPacket::MaxEpochs) % FPrvInputPacket::MaxEpochs;
+		if (!bAcceptAnyInputEpoch && EpochDelta > FPrvInputPacket::MaxEpochs / 2)
+		{
+			++InputPacketsDropped;
+			INC_DWORD_STAT(STAT_PrvInputPacketsDropped);
+			return;
+		}
+
+		LastAppliedInputEpoch = InPacket.Epoch;
+		LastAppliedInputSequence = 0;
+		bAcceptAnyInputEpoch = false;
+	}
+
+	// Apply inputs not applied yet from the oldest to the newest (sequence numbers wrap around)
+	bool bInputApplied = false;
+	for (int32 i = InPacket.NumInputs - 1; i >= 0; --i)
+	{
+		const uint16 Sequence = InPacket.Sequence - i;
+		if ((int16)(Sequence - LastAppliedInputSequence) > 0)
+		{
+			ApplyQuantizedInput(InPacket.Inputs[i]);
+			LastAppliedInputSequence = Sequence;
+			LastAppliedInputTime = GetWorld()->GetTimeSeconds();
+			bInputApplied = true;
+		}
+	}
+
+	// Resent newest input (keep-alive) is expected, only outdated packets are dropped
+	if (!bInputApplied)
+	{
+		if (InPacket.Sequence == LastAppliedInputSequence)
+		{
+			++InputPacketsKeepAlive;
+			INC_DWORD_STAT(STAT_PrvInputPacketsKeepAlive);
+		}
+		else
+		{
+			++InputPacketsDropped;
+			INC_DWORD_STAT(STAT_PrvInputPacketsDropped);
+		}
+	}
+}
+
+float UPrvVehicleMovementComponent::GetInputPacketsPerSecond() const
+{
+	const float StatsTime = GetWorld() ? GetWorld()->GetTimeSeconds() - InputStatsStartTime : 0.f;
+	return (StatsTime > 0.f) ? InputPackets / StatsTime : 0.f;
+}
+
+float UPrvVehicleMovementComponent::GetInputBytesPerSecond() const
+{
+	const float StatsTime = GetWorld() ? GetWorld()->GetTimeSeconds() - InputStatsStartTime : 0.f;
+	return (StatsTime > 0.f) ? InputBytes / StatsTime : 0.f;
+}
+
+static void PrvDumpInputStats(const TArray<FString>& Args, UWorld* World)
+{
+	for (TObjectIterator<UPrvVehicleMovementComponent> It; It; ++It)
+	{
+		if (It->GetWorld() == World && !It->IsTemplate())
+		{
+			UE_LOG(LogPrvVehicle, Log, TEXT("Input stream (%s): %.1f packets/s, %.1f bytes/s, %u dropped, %u keep-alive"),
+				*It->GetOwner()->GetName(), It->GetInputPacketsPerSecond(), It->GetInputBytesPerSecond(), It->GetInputPacketsDropped(), It->GetInputPacketsKeepAlive());
+		}
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs PrvDumpInputStatsCommand(
+	TEXT("PrvVehicle.InputStats"),
+	TEXT("Logs input packets rate and traffic for every vehicle in the world"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&PrvDumpInputStats));
+
+
+//////////////////////////////////////////////////////////////////////////
+// Wheels replication
+
+/** Replicated suspension lengths are smoothed between net updates */
+static const float PrvReplicatedWheelsInterpSpeed = 20.f;
+
+bool FPrvReplicatedWheels::NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
+{
+	uint8 LengthBitsValue = FMath::Clamp<int32>(LengthBits, 1, 8) - 1;
+	Ar.SerializeBits(&LengthBitsValue, 3);
+
+	uint32 NumWheels = FMath::Min<int32>(Lengths.Num(), MaxWheels);
+	Ar.SerializeInt(NumWheels, MaxWheels + 1);
+
+	if (Ar.IsLoading())
+	{
+		LengthBits = LengthBitsValue + 1;
+		Lengths.SetNumZeroed(NumWheels);
+		Grounded.SetNumZeroed(NumWheels);
+		SurfaceTypes.SetNumZeroed(NumWheels);
+	}
+
+	// Length, grounded flag and surface type (grounded wheels only)
+	for (uint32 WheelIndex = 0; WheelIndex < NumWheels; ++WheelIndex)
+	{
+		uint8 Length = Lengths[WheelIndex];
+		Ar.SerializeBits(&Length, LengthBits);
+
+		uint8 bGrounded = Grounded[WheelIndex] ? 1 : 0;
+		Ar.SerializeBits(&bGrounded, 1);
+
+		uint8 SurfaceType = bGrounded ? SurfaceTypes[WheelIndex] : 0;
+		if (bGrounded)
+		{
+			Ar.SerializeBits(&SurfaceType, 6);
+		}
+
+		if (Ar.IsLoading())
+		{
+			Lengths[WheelIndex] = Length;
+			Grounded[WheelIndex] = (bGrounded != 0);
+			SurfaceTypes[WheelIndex] = SurfaceType;
+		}
+	}
+
+	bOutSuccess = !Ar.IsError();
+	return true;
+}
+
+void UPrvVehicleMovementComponent::UpdateReplicatedWheels()
+{
+	const int32 LengthBits = FMath::Clamp(WheelStateLengthBits, 1, 8);
+	const float MaxQuantizedLength = (float)((1 << LengthBits) - 1);
+	const int32 NumWheels = FMath::Min<int32>(WheelsState.Num(), FPrvReplicatedWheels::MaxWheels);
+
+	ReplicatedWheels.LengthBits = LengthBits;
+	ReplicatedWheels.Lengths.SetNumZeroed(NumWheels);
+	ReplicatedWheels.Grounded.SetNumZeroed(NumWheels);
+	ReplicatedWheels.SurfaceTypes.SetNumZeroed(NumWheels);
+
+	for (int32 WheelIndex = 0; WheelIndex < NumWheels; ++WheelIndex)
+	{
+		const FSuspensionInfo& SuspInfo = SuspensionSetup[WheelIndex];
+		const float MaxLength = FMath::Max(SuspInfo.Length + SuspInfo.MaxDrop, KINDA_SMALL_NUMBER);
+		const float LengthRatio = FMath::Clamp(WheelsState.VisualLength[WheelIndex] / MaxLength, 0.f, 1.f);
 
-			const FVector RelativeWheelVelocity = UKismetMathLibrary::ProjectVectorOnToPlane(WheelVelocity, SuspState.WheelCollisionNormal);
+		ReplicatedWheels.Lengths[WheelIndex] = (uint8)FMath::RoundToInt(LengthRatio * MaxQuantizedLength);
+		ReplicatedWheels.Grounded[WheelIndex] = WheelsState.WheelTouchedGround[WheelIndex];
+		ReplicatedWheels.SurfaceTypes[WheelIndex] = (uint8)WheelsState.SurfaceType[WheelIndex].GetValue();
+	}
+}
+
+bool UPrvVehicleMovementComponent::UseReplicatedWheels() const
+{
+	return bReplicateWheelState && GetOwner()->Role == ROLE_SimulatedProxy && ReplicatedWheels.Lengths.Num() == WheelsState.Num();
+}
+
+void UPrvVehicleMovementComponent::ApplyReplicatedWheels(float DeltaTime)
+{
+	const float MaxQuantizedLength = (float)((1 << FMath::Clamp<int32>(ReplicatedWheels.LengthBits, 1, 8)) - 1);
+	const FTransform BodyTransform = UpdatedMesh->GetComponentTransform();
+
+	for (int32 WheelIndex = 0; WheelIndex < WheelsState.Num(); ++WheelIndex)
+	{
+		const FSuspensionInfo& SuspInfo = SuspensionSetup[WheelIndex];
+		const float TargetLength = ReplicatedWheels.Lengths[WheelIndex] / MaxQuantizedLength * (SuspInfo.Length + SuspInfo.MaxDrop);
+
+		WheelsState.VisualLength[WheelIndex] = FMath::FInterpTo(WheelsState.VisualLength[WheelIndex], TargetLength, DeltaTime, PrvReplicatedWheelsInterpSpeed);
+		WheelsState.WheelTouchedGround[WheelIndex] = ReplicatedWheels.Grounded[WheelIndex];
+		WheelsState.SurfaceType[WheelIndex] = (EPhysicalSurface)ReplicatedWheels.SurfaceTypes[WheelIndex];
+
+		// Contact is restored under the wheel for dust effects
+		const FVector SuspUpVector = BodyTransform.TransformVectorNoScale(UKismetMathLibrary::GetUpVector(WheelsState.Rotation[WheelIndex]));
+		const FVector SuspWorldLocation = BodyTransform.TransformPosition(SuspInfo.Location);
+		WheelsState.WheelCollisionLocation[WheelIndex] = SuspWorldLocation - SuspUpVector * (WheelsState.VisualLength[WheelIndex] + SuspInfo.CollisionRadius);
+		WheelsState.WheelCollisionNormal[WheelIndex] = SuspUpVector;
+	}
+
+	UpdateRenderWheelsState(1.f);
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Client prediction
+
+bool UPrvVehicleMovementComponent::IsClientPredictionActive() const
+{
+	const AActor* Owner = GetOwner();
+	return bClientPrediction && Owner && Owner->Role == ROLE_AutonomousProxy && !bFakeAutonomousProxy;
+}
+
+void UPrvVehicleMovementComponent::RecordPredictionHistory()
+{
+	if (!UpdatedMesh || PredictionHistorySize <= 0 || InputHistoryNum == 0)
+	{
+		return;
+	}
+
+	if (PredictionHistory.Num() != PredictionHistorySize)
+	{
+		PredictionHistory.Reset();
+		PredictionHistory.SetNum(PredictionHistorySize);
+		PredictionHistoryHead = 0;
+	}
+
+	const FTransform BodyTransform = UpdatedMesh->GetComponentTransform();
+
+	// Error that is being blended out was already reconciled
+	FPrvPredictionHistoryEntry& Entry = PredictionHistory[PredictionHistoryHead];
+	Entry.Sequence = InputSequence;
+	Entry.TimeSinceInput = GetWorld()->GetTimeSeconds() - InputSequenceStartTime;
+	Entry.Location = BodyTransform.GetLocation() + PendingCorrectionLocation;
+	Entry.Rotation = PendingCorrectionRotation * BodyTransform.GetRotation();
+	Entry.LinearVelocity = UpdatedMesh->GetPhysicsLinearVelocity();
+	Entry.AngularVelocity = UpdatedMesh->GetPhysicsAngularVelocity();
+	Entry.LeftTrackAngularSpeed = LeftTrack.AngularSpeed;
+	Entry.RightTrackAngularSpeed = RightTrack.AngularSpeed;
 
-			// Get friction coefficients
-			const float MuStatic = CalculateFrictionCoefficient(RelativeWheelVelocity, WheelDirection, StaticFrictionCoefficientEllipse);
-			const float MuKinetic = CalculateFrictionCoefficient(RelativeWheelVelocity, WheelDirection, KineticFrictionCoefficientEllipse);
+	PredictionHistoryHead = (PredictionHistoryHead + 1) % PredictionHistory.Num();
+}
+
+void UPrvVehicleMovementComponent::ApplyPredictionCorrection(float DeltaTime)
+{
+	PRV_CYCLE_COUNTER(STAT_PrvMovementNetworkCorrection);
 
-			// Mass and friction forces
-			const float VehicleMass = UpdatedMesh->GetMass();
-			const FVector FrictionXVector = UKismetMathLibrary::ProjectVectorOnToPlane(UpdatedMesh->GetForwardVector(), SuspState.WheelCollisionNormal).GetSafeNormal();
-			const FVector FrictionYVector = UKismetMathLibrary::ProjectVectorOnToPlane(UpdatedMesh->GetRightVector(), SuspState.WheelCollisionNormal).GetSafeNormal();
+	if (PendingCorrectionTime <= 0.f || !UpdatedMesh)
+	{
+		return;
+	}
 
-			// Current wheel force contbution
-			FVector WheelBalancedForce = FVector::ZeroVector;
-			if (ActiveFrictionPoints != 0)
-			{
-				const FVector GravityDirection = -FVector::UpVector;
-				const FVector GravityBasedFriction = UKismetMathLibrary::ProjectVectorOnToPlane(GravityDirection * UPhysicsSettings::Get()->DefaultGravityZ * VehicleMass / ActiveFrictionPoints, UpdatedMesh->GetUpVector());
-				WheelBalancedForce = RelativeWheelVelocity * VehicleMass / DeltaTime / ActiveFrictionPoints + GravityBasedFriction;
-			}
+	FBodyInstance* BI = UpdatedMesh->GetBodyInstance();
+	if (!BI || !BI->IsInstanceSimulatingPhysics())
+	{
+		return;
+	}
 
-			// @temp For non-driving wheels X friction is disabled
-			float LongitudeFrictionFactor = 1.f;
-			if (bWheeledVehicle && !SuspState.SuspensionInfo.bDrivingWheel)
-			{
-				LongitudeFrictionFactor = 0.f;
-			}
+	// Move the part of error proportional to the passed time
+	const float Alpha = FMath::Clamp(DeltaTime / PendingCorrectionTime, 0.f, 1.f);
+	const FVector DeltaLocation = PendingCorrectionLocation * Alpha;
+	const FQuat DeltaRotation = FQuat::Slerp(FQuat::Identity, PendingCorrectionRotation, Alpha);
 
-			// Full friction forces
-			const FVector FullStaticFrictionForce =
-			UKismetMathLibrary::ProjectVectorOnToVector(WheelBalancedForce, FrictionXVector) * StaticFrictionCoefficientEllipse.X  * LongitudeFrictionFactor * FMath::Sign(WheelTrack->BrakeRatio) +
-				UKismetMathLibrary::ProjectVectorOnToVector(WheelBalancedForce, FrictionYVector) * StaticFrictionCoefficientEllipse.Y;
-			const FVector FullKineticFrictionForce =
-				UKismetMathLibrary::ProjectVectorOnToVector(WheelBalancedForce, FrictionXVector) * KineticFrictionCoefficientEllipse.X * LongitudeFrictionFactor +
-				UKismetMathLibrary::ProjectVectorOnToVector(WheelBalancedForce, FrictionYVector) * KineticFrictionCoefficientEllipse.Y;
+	const FTransform BodyTransform = UpdatedMesh->GetComponentTransform();
+	BI->SetBodyTransform(FTransform(DeltaRotation * BodyTransform.GetRotation(), BodyTransform.GetLocation() + DeltaLocation), ETeleportType::TeleportPhysics);
 
-			// Drive Force from transmission torque
-			FVector TransmissionDriveForce = UKismetMathLibrary::ProjectVectorOnToPlane(WheelTrack->DriveForce, SuspState.WheelCollisionNormal);
-			
-			if (bScaleForceToActiveFrictionPoints && ActiveDrivenFrictionPoints != 0 && SuspensionData.Num() != 0)
-			{
-				const float Ratio = static_cast<float>(SuspensionData.Num()) / static_cast<float>(ActiveDrivenFrictionPoints);
-				TransmissionDriveForce *= Ratio;
-			}
+	PendingCorrectionLocation -= DeltaLocation;
+	PendingCorrectionRotation = DeltaRotation.Inverse() * PendingCorrectionRotation;
+	PendingCorrectionTime -= DeltaTime;
+}
 
-			// Full drive forces
-			const FVector FullStaticDriveForce = TransmissionDriveForce * StaticFrictionCoefficientEllipse.X * LongitudeFrictionFactor;
-			const FVector FullKineticDriveForce = TransmissionDriveForce * KineticFrictionCoefficientEllipse.X * LongitudeFrictionFactor;
+void UPrvVehicleMovementComponent::SendServerState()
+{
+	const AActor* Owner = GetOwner();
+	if (!UpdatedMesh || !Owner || Owner->GetRemoteRole() != ROLE_AutonomousProxy || LastAppliedInputSequence == 0)
+	{
+		return;
+	}
 
-			// Full forces
-			const FVector FullStaticForce = FullStaticDriveForce + FullStaticFrictionForce;
-			const FVector FullKineticForce = FullKineticDriveForce + FullKineticFrictionForce;
+	const float WorldTime = GetWorld()->GetTimeSeconds();
+	if (WorldTime - LastServerStateSendTime < 1.f / FMath::Max(ServerStateSendRate, 1.f))
+	{
+		return;
+	}
 
-			// We want to apply higher friction if forces are bellow static friction limit
-			bUseKineticFriction = FullStaticDriveForce.Size() >= (SuspState.WheelLoad * MuStatic);
-			const FVector FullKineticFrictionNormalizedForce = bUseKineticFriction ? FullKineticFrictionForce.GetSafeNormal() : FVector::ZeroVector;
-			const FVector ApplicationForce = bUseKineticFriction
-				? FullKineticForce.GetClampedToMaxSize(SuspState.WheelLoad * MuKinetic)
-				: FullStaticForce.GetClampedToMaxSize(SuspState.WheelLoad * MuStatic);
-			
-			if (bUseKineticFriction == false)
-			{
-				const float WorldPointForwardVectorSpeed = FVector::DotProduct(WorldPointVelocity,  UpdatedMesh->GetForwardVector());
-				const float CurrentAngularSpeed = WorldPointForwardVectorSpeed / SprocketRadius;
-				MinimumWheelAngularSpeed = FMath::Min(MinimumWheelAngularSpeed, CurrentAngularSpeed);
-				WheelTrack->AngularSpeed = MinimumWheelAngularSpeed;
-			}
-			
-			// Apply force to mesh
-			if (ShouldAddForce())
-			{
-				UpdatedMesh->AddForceAtLocation(ApplicationForce, SuspState.WheelCollisionLocation);
-			}
+	const FTransform BodyTransform = UpdatedMesh->GetComponentTransform();
 
-			/////////////////////////////////////////////////////////////////////////
-			// Friction torque
+	FPrvServerState State;
+	State.Sequence = LastAppliedInputSequence;
+	State.TimeSinceInput = WorldTime - LastAppliedInputTime;
+	State.Location = BodyTransform.GetLocation();
+	State.Rotation = BodyTransform.GetRotation();
+	State.LinearVelocity = UpdatedMesh->GetPhysicsLinearVelocity();
+	State.AngularVelocity = UpdatedMesh->GetPhysicsAngularVelocity();
+	State.LeftTrackAngularSpeed = LeftTrack.AngularSpeed;
+	State.RightTrackAngularSpeed = RightTrack.AngularSpeed;
 
-			// Friction should work agains real movement
-			float FrictionDirectionMultiplier = FMath::Sign(WheelTrack->AngularSpeed) * FMath::Sign(WheelTrack->TorqueTransfer) * ((bReverseGear) ? (-1.f) : 1.f);
-			if (FMath::Abs(FrictionDirectionMultiplier) < SMALL_NUMBER) FrictionDirectionMultiplier = 1.f;
+	ClientAckState(State);
+	LastServerStateSendTime = WorldTime;
+}
 
-			// How much of friction force would effect transmission
-			const FVector TransmissionFrictionForce = bUseKineticFriction ? UKismetMathLibrary::ProjectVectorOnToVector(ApplicationForce, FullKineticFrictionNormalizedForce) * (-1.f) * (TrackMass + SprocketMass) / VehicleMass * FrictionDirectionMultiplier : FVector::ZeroVector;
-			const FVector WorldFrictionForce = UpdatedMesh->GetComponentTransform().InverseTransformVectorNoScale(TransmissionFrictionForce);
-			const float TrackKineticFrictionTorque = UKismetMathLibrary::ProjectVectorOnToVector(WorldFrictionForce, FVector::ForwardVector).X * SprocketRadius;
+void UPrvVehicleMovementComponent::ClientAckState_Implementation(const FPrvServerState& InState)
+{
+	if (!IsClientPredictionActive() || !UpdatedMesh)
+	{
+		return;
+	}
 
-			WheelTrack->KineticFrictionTorque += (TrackKineticFrictionTorque * KineticFrictionTorqueCoefficient);
+	// Unreliable acks can be duplicated or reordered: the older one would apply error to already corrected history
+	// (server sends states for the same input till the next one arrives, so they are ordered by time since input too)
+	const int16 SequenceDelta = (int16)(InState.Sequence - LastAckedSequence);
+	if (SequenceDelta < 0 || (SequenceDelta == 0 && InState.TimeSinceInput <= LastAckedTimeSinceInput))
+	{
+		return;
+	}
 
-			/////////////////////////////////////////////////////////////////////////
-			// Rolling friction torque
+	LastAckedSequence = InState.Sequence;
+	LastAckedTimeSinceInput = InState.TimeSinceInput;
 
-			// @todo Make this a force instead of torque!
-			const float ReverseVelocitySign = (-1.f) * FMath::Sign(WheelTrack->LinearSpeed);
-			const float TrackRollingFrictionTorque = SuspState.WheelLoad * RollingFrictionCoefficient * ReverseVelocitySign +
-			SuspState.WheelLoad * FMath::Pow(WheelTrack->LinearSpeed, LinearSpeedPower) * FMath::Pow(RollingVelocityCoefficientSquared, 2.f) * ReverseVelocitySign;
+	// Find predicted state for the same input and the same time since it was applied
+	int32 BestIndex = INDEX_NONE;
+	float BestTimeError = 0.1f;
+	for (int32 Index = 0; Index < PredictionHistory.Num(); ++Index)
+	{
+		const FPrvPredictionHistoryEntry& Entry = PredictionHistory[Index];
+		const float TimeError = FMath::Abs(Entry.TimeSinceInput - InState.TimeSinceInput);
+		if (Entry.Sequence == InState.Sequence && TimeError < BestTimeError)
+		{
+			BestIndex = Index;
+			BestTimeError = TimeError;
+		}
+	}
 
-			// Add torque to track
-			WheelTrack->RollingFrictionTorque += TrackRollingFrictionTorque;
+	// Input is too old or not predicted yet
+	if (BestIndex == INDEX_NONE)
+	{
+		return;
+	}
 
-			/////////////////////////////////////////////////////////////////////////
-			// Debug
+	const FPrvPredictionHistoryEntry& Predicted = PredictionHistory[BestIndex];
+	const FVector ErrorLocation = InState.Location - Predicted.Location;
+	const FQuat ErrorRotation = InState.Rotation * Predicted.Rotation.Inverse();
 
-			if (bShowDebug)
-			{
-				// Friction type
-				if (bUseKineticFriction)
-				{
-					DrawDebugString(GetWorld(), SuspState.WheelCollisionLocation, TEXT("Kinetic"), nullptr, FColor::Blue, 0.f);
-				}
-				else
-				{
-					DrawDebugString(GetWorld(), SuspState.WheelCollisionLocation, TEXT("Static"), nullptr, FColor::Red, 0.f);
-				}
+	if (ErrorLocation.SizeSquared() < FMath::Square(PredictionTolerance) && ErrorRotation.AngularDistance(FQuat::Identity) < KINDA_SMALL_NUMBER * 100.f)
+	{
+		return;
+	}
 
-				// Force application
-				DrawDebugLine(GetWorld(), SuspState.WheelCollisionLocation, SuspState.WheelCollisionLocation + ApplicationForce * 0.0001f, FColor::Cyan, false, 0.f, 0, 10.f);
+	const FVector ErrorLinearVelocity = InState.LinearVelocity - Predicted.LinearVelocity;
+	const FVector ErrorAngularVelocity = InState.AngularVelocity - Predicted.AngularVelocity;
+	const float ErrorLeftTrackAngularSpeed = InState.LeftTrackAngularSpeed - Predicted.LeftTrackAngularSpeed;
+	const float ErrorRightTrackAngularSpeed = InState.RightTrackAngularSpeed - Predicted.RightTrackAngularSpeed;
 
-				// Wheel velocity vectors
-				DrawDebugLine(GetWorld(), SuspState.WheelCollisionLocation, SuspState.WheelCollisionLocation + WheelCollisionVelocity, FColor::Yellow, false, 0.f, 0, 8.f);
-				DrawDebugLine(GetWorld(), SuspState.WheelCollisionLocation, SuspState.WheelCollisionLocation + RelativeWheelVelocity, FColor::Blue, false, 0.f, 0, 8.f);
-			}
-		}
-		else 
+	// Unacknowledged inputs are replayed by carrying the error through all newer predicted states:
+	// the vehicle pipeline is expected to produce the same changes on top of corrected state
+	for (int32 Offset = 0; Offset < PredictionHistory.Num(); ++Offset)
+	{
+		const int32 Index = (BestIndex + Offset) % PredictionHistory.Num();
+		if (Offset > 0 && Index == PredictionHistoryHead)
 		{
-			// Reset wheel load
-			SuspState.WheelLoad = 0.f;
+			break;
 		}
+
+		FPrvPredictionHistoryEntry& Entry = PredictionHistory[Index];
+		Entry.Location += ErrorLocation;
+		Entry.Rotation = ErrorRotation * Entry.Rotation;
+		Entry.LinearVelocity += ErrorLinearVelocity;
+		Entry.AngularVelocity += ErrorAngularVelocity;
+		Entry.LeftTrackAngularSpeed += ErrorLeftTrackAngularSpeed;
+		Entry.RightTrackAngularSpeed += ErrorRightTrackAngularSpeed;
 	}
+
+	// Velocities are corrected at once, position is blended out if the error is small
+	UpdatedMesh->SetPhysicsLinearVelocity(UpdatedMesh->GetPhysicsLinearVelocity() + ErrorLinearVelocity);
+	UpdatedMesh->SetPhysicsAngularVelocity(UpdatedMesh->GetPhysicsAngularVelocity() + ErrorAngularVelocity);
+	LeftTrack.AngularSpeed += ErrorLeftTrackAngularSpeed;
+	RightTrack.AngularSpeed += ErrorRightTrackAngularSpeed;
+
+	PendingCorrectionLocation += ErrorLocation;
+	PendingCorrectionRotation = ErrorRotation * PendingCorrectionRotation;
+	PendingCorrectionTime = (PendingCorrectionLocation.SizeSquared() > FMath::Square(PredictionSnapDistance)) ? KINDA_SMALL_NUMBER : PredictionCorrectionTime;
+
+	INC_DWORD_STAT(STAT_PrvPredictionCorrections);
 }
 
-float UPrvVehicleMovementComponent::CalculateFrictionCoefficient(FVector DirectionVelocity, FVector ForwardVector, FVector2D FrictionEllipse)
-{
-	// dot(A,B)
-	const float DirectionDotProduct = FVector::DotProduct(DirectionVelocity.GetSafeNormal(), ForwardVector);
 
-	FVector2D MuVector;
-	// x = r1 * dot(A,B)
-	MuVector.X = FrictionEllipse.X * DirectionDotProduct;
-	// y = r2 * sqrt(1 - dot(A,B)^2 )
-	MuVector.Y = FrictionEllipse.Y * FMath::Sqrt(1.f - FMath::Square(DirectionDotProduct));
+//////////////////////////////////////////////////////////////////////////
+// Snapshot interpolation
 
-	return MuVector.Size();
+bool UPrvVehicleMovementComponent::IsSnapshotInterpolationActive() const
+{
+	const AActor* Owner = GetOwner();
+	return bSnapshotInterpolation && Owner && (Owner->Role == ROLE_SimulatedProxy || (Owner->Role == ROLE_AutonomousProxy && bFakeAutonomousProxy));
 }
 
-void UPrvVehicleMovementComponent::UpdateLinearVelocity(float DeltaTime)
+void UPrvVehicleMovementComponent::AddSnapshot(const FRigidBodyState& NewState)
 {
-	if (ShouldAddForce() && bCustomLinearDamping)
+	FPrvStateSnapshot Snapshot;
+	Snapshot.Time = GetWorld()->GetTimeSeconds();
+	Snapshot.Location = NewState.Position;
+	Snapshot.Rotation = NewState.Quaternion;
+	Snapshot.LinearVelocity = NewState.LinVel;
+	Snapshot.AngularVelocity = NewState.AngVel;
+
+	// Several states received in one frame: the last one wins
+	if (Snapshots.Num() > 0 && Snapshots.Last().Time >= Snapshot.Time)
 	{
-		const FVector LocalLinearVelocity = UpdatedMesh->GetComponentTransform().InverseTransformVectorNoScale(UpdatedMesh->GetPhysicsLinearVelocity());
-		const FVector SignVector = FVector(FMath::Sign(LocalLinearVelocity.X), FMath::Sign(LocalLinearVelocity.Y), FMath::Sign(LocalLinearVelocity.Z));
-		FVector NewLinearVelocity = LocalLinearVelocity - DeltaTime * (SignVector * DryFrictionLinearDamping + FluidFrictionLinearDamping * LocalLinearVelocity);
-
-		// Clamp to zero vector in per-component basis
-		NewLinearVelocity.X = SignVector.X * FMath::Max(0.f, SignVector.X * NewLinearVelocity.X);
-		NewLinearVelocity.Y = SignVector.Y * FMath::Max(0.f, SignVector.Y * NewLinearVelocity.Y);
-		NewLinearVelocity.Z = SignVector.Z * FMath::Max(0.f, SignVector.Z * NewLinearVelocity.Z);
+		Snapshots.Last() = Snapshot;
+		return;
+	}
 
-		UpdatedMesh->SetPhysicsLinearVelocity(UpdatedMesh->GetComponentTransform().TransformVectorNoScale(NewLinearVelocity));
+	Snapshots.Add(Snapshot);
 
-		if (bDebugCustomDamping)
-		{
-			UE_LOG(LogPrvVehicle, Error, TEXT("Linear damping WAS: %s, NOW: %s"), *LocalLinearVelocity.ToString(), *NewLinearVelocity.ToString());
-		}
+	if (Snapshots.Num() > FMath::Max(SnapshotBufferSize, 2))
+	{
+		Snapshots.RemoveAt(0, Snapshots.Num() - FMath::Max(SnapshotBufferSize, 2), false);
 	}
 }
 
-void UPrvVehicleMovementComponent::UpdateAngularVelocity(float DeltaTime)
+void UPrvVehicleMovementComponent::UpdateSnapshotInterpolation()
 {
-	if (ShouldAddForce() && bCustomAngularDamping)
+	PRV_CYCLE_COUNTER(STAT_PrvMovementNetworkCorrection);
+
+	if (Snapshots.Num() == 0 || !UpdatedMesh)
 	{
-		const FVector LocalAngularVelocity = UpdatedMesh->GetComponentTransform().InverseTransformVectorNoScale(UpdatedMesh->GetPhysicsAngularVelocity());
-		const FVector SignVector = FVector(FMath::Sign(LocalAngularVelocity.X), FMath::Sign(LocalAngularVelocity.Y), FMath::Sign(LocalAngularVelocity.Z));
-		FVector NewAngularVelocity = LocalAngularVelocity - DeltaTime * (SignVector * DryFrictionAngularDamping + FluidFrictionAngularDamping * LocalAngularVelocity);
+		return;
+	}
 
-		// Clamp to zero vector in per-component basis
-		NewAngularVelocity.X = SignVector.X * FMath::Max(0.f, SignVector.X * NewAngularVelocity.X);
-		NewAngularVelocity.Y = SignVector.Y * FMath::Max(0.f, SignVector.Y * NewAngularVelocity.Y);
-		NewAngularVelocity.Z = SignVector.Z * FMath::Max(0.f, SignVector.Z * NewAngularVelocity.Z);
+	FBodyInstance* BI = UpdatedMesh->GetBodyInstance();
+	if (!BI || !BI->IsInstanceSimulatingPhysics())
+	{
+		return;
+	}
 
-		UpdatedMesh->SetPhysicsAngularVelocity(UpdatedMesh->GetComponentTransform().TransformVectorNoScale(NewAngularVelocity));
+	const float RenderTime = GetWorld()->GetTimeSeconds() - InterpolationDelay;
 
-		if (bDebugCustomDamping)
-		{
-			UE_LOG(LogPrvVehicle, Error, TEXT("Angular damping WAS: %s, NOW: %s"), *LocalAngularVelocity.ToString(), *NewAngularVelocity.ToString());
-		}
+	// Keep only one state older than render time
+	while (Snapshots.Num() > 2 && Snapshots[1].Time <= RenderTime)
+	{
+		Snapshots.RemoveAt(0, 1, false);
 	}
-}
 
-void UPrvVehicleMovementComponent::AnimateWheels(float DeltaTime)
-{
-	for (auto& SuspState : SuspensionData)
+	const FPrvStateSnapshot& From = Snapshots[0];
+
+	FVector Location;
+	FQuat Rotation;
+	FVector LinearVelocity;
+	FVector AngularVelocity;
+
+	if (RenderTime <= From.Time)
+	{
+		// Render time is before the oldest state (buffer is just filled)
+		Location = From.Location;
+		Rotation = From.Rotation;
+		LinearVelocity = From.LinearVelocity;
+		AngularVelocity = From.AngularVelocity;
+	}
+	else if (Snapshots.Num() > 1 && RenderTime <= Snapshots[1].Time)
 	{
-		const float EffectiveAngularSpeed = (SuspState.SuspensionInfo.bRightTrack) ? RightTrackEffectiveAngularSpeed : LeftTrackEffectiveAngularSpeed;
+		// Hermite interpolation with replicated velocities as tangents
+		const FPrvStateSnapshot& To = Snapshots[1];
+		const float Interval = FMath::Max(To.Time - From.Time, KINDA_SMALL_NUMBER);
+		const float Alpha = FMath::Clamp((RenderTime - From.Time) / Interval, 0.f, 1.f);
+
+		Location = FMath::CubicInterp(From.Location, From.LinearVelocity * Interval, To.Location, To.LinearVelocity * Interval, Alpha);
+		Rotation = FQuat::Slerp(From.Rotation, To.Rotation, Alpha);
+		LinearVelocity = FMath::Lerp(From.LinearVelocity, To.LinearVelocity, Alpha);
+		AngularVelocity = FMath::Lerp(From.AngularVelocity, To.AngularVelocity, Alpha);
+	}
+	else
+	{
+		// Buffer runs dry: extrapolate the newest state for limited time
+		const FPrvStateSnapshot& Newest = Snapshots.Last();
+		const float ExtrapolationTime = FMath::Clamp(RenderTime - Newest.Time, 0.f, MaxExtrapolationTime);
+
+		Location = Newest.Location + Newest.LinearVelocity * ExtrapolationTime;
+		Rotation = Newest.Rotation;
+		LinearVelocity = Newest.LinearVelocity;
+		AngularVelocity = Newest.AngularVelocity;
+
+		const FVector AngularVelocityRad = FMath::DegreesToRadians(Newest.AngularVelocity);
+		const float AngularSpeed = AngularVelocityRad.Size();
+		if (AngularSpeed > SMALL_NUMBER)
+		{
+			Rotation = (FQuat(AngularVelocityRad / AngularSpeed, AngularSpeed * ExtrapolationTime) * Newest.Rotation).GetNormalized();
+		}
 
-		SuspState.RotationAngle -= FMath::RadiansToDegrees(EffectiveAngularSpeed) * DeltaTime * (SprocketRadius / VisualCollisionRadius);
-		SuspState.RotationAngle = FRotator::NormalizeAxis(SuspState.RotationAngle);
-		SuspState.SteeringAngle = SuspState.SuspensionInfo.Rotation.Yaw;
+		++SnapshotStarvedFrames;
+		INC_DWORD_STAT(STAT_PrvSnapshotStarved);
 	}
-}
 
+	// How far local physics drifted from replicated path since the last frame
+	const float Correction = FVector::Dist(UpdatedMesh->GetComponentLocation(), Location);
+	SnapshotCorrectionSum += Correction;
+	SnapshotCorrectionMax = FMath::Max(SnapshotCorrectionMax, Correction);
+	++SnapshotFrames;
+	INC_FLOAT_STAT_BY(STAT_PrvSnapshotCorrection, Correction);
 
-//////////////////////////////////////////////////////////////////////////
-// Network
+	BI->SetBodyTransform(FTransform(Rotation, Location), ETeleportType::TeleportPhysics);
+	BI->SetLinearVelocity(LinearVelocity, false);
+	BI->SetAngularVelocity(AngularVelocity, false);
+}
 
-bool UPrvVehicleMovementComponent::ServerUpdateState_Validate(uint16 InQuantizeInput)
+float UPrvVehicleMovementComponent::GetAverageSnapshotCorrection() const
 {
-	return true;
+	return (SnapshotFrames > 0) ? SnapshotCorrectionSum / SnapshotFrames : 0.f;
 }
 
-void UPrvVehicleMovementComponent::ServerUpdateState_Implementation(uint16 InQuantizeInput)
+static void PrvDumpSnapshotStats(const TArray<FString>& Args, UWorld* World)
 {
-	const int32 QThrottleInput = (int8)(InQuantizeInput & 0xFF);
-	const int32 QSteeringInput = ((int8)(((InQuantizeInput >> 8) & 0x7F) << 1)) / 2;
-	const int32 QHandbrakeInput = (InQuantizeInput >> 15) & 1;
+	for (TObjectIterator<UPrvVehicleMovementComponent> It; It; ++It)
+	{
+		if (It->GetWorld() == World && !It->IsTemplate() && It->IsSnapshotInterpolationActive())
+		{
+			UE_LOG(LogPrvVehicle, Log, TEXT("Snapshots (%s): correction avg %.2f cm, max %.2f cm, %u starved frames"),
+				*It->GetOwner()->GetName(), It->GetAverageSnapshotCorrection(), It->GetMaxSnapshotCorrection(), It->GetSnapshotStarvedFrames());
+		}
+	}
+}
 
-	SetThrottleInput(QThrottleInput / 127.f);
-	SetSteeringInput(QSteeringInput / 63.f);
-	bRawHandbrakeInput = QHandbrakeInput;
+static FAutoConsoleCommandWithWorldAndArgs PrvDumpSnapshotStatsCommand(
+	TEXT("PrvVehicle.SnapshotStats"),
+	TEXT("Logs snapshot interpolation correction and buffer starvation for every simulated vehicle in the world"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&PrvDumpSnapshotStats));
 
-	LastUserSteeringInput = QSteeringInput;
-}
 
 //////////////////////////////////////////////////////////////////////////
 // Custom physics handling
@@ -2037,6 +3959,8 @@ bool UPrvVehicleMovementComponent::ConditionalApplyRigidBodyState(FRigidBodyStat
 
 bool UPrvVehicleMovementComponent::ApplyRigidBodyState(const FRigidBodyState& NewState, const FRigidBodyErrorCorrection& ErrorCorrection, FVector& OutDeltaPos, FName BoneName)
 {
+	PRV_CYCLE_COUNTER(STAT_PrvMovementNetworkCorrection);
+
 	// See UPrimitiveComponent::ApplyRigidBodyState
 	
 	if (UpdatedMesh == nullptr)
@@ -2214,6 +4138,11 @@ int32 UPrvVehicleMovementComponent::GetLastUserSteeringInput() const
 	return LastUserSteeringInput;
 }
 
+void UPrvVehicleMovementComponent::InvalidateSimulationCache()
+{
+	bSimulationCacheDirty = true;
+}
+
 /////////////////////////////////////////////////////////////////////////
 // Animation control
 
@@ -2242,6 +4171,83 @@ float UPrvVehicleMovementComponent::GetThrottle() const
 	return ThrottleInput;
 }
 
+bool UPrvVehicleMovementComponent::GetPublishedState(FPrvVehicleStateSnapshot& OutState) const
+{
+	return PublishedState.Read(OutState);
+}
+
+void UPrvVehicleMovementComponent::PublishState()
+{
+	FPrvVehicleStateSnapshot State;
+	State.NumWheels = FMath::Min<int32>(WheelsState.Num(), FPrvVehicleStateSnapshot::MaxWheels);
+
+	for (int32 WheelIndex = 0; WheelIndex < State.NumWheels; ++WheelIndex)
+	{
+		const FSuspensionInfo& WheelSetup = SuspensionSetup[WheelIndex];
+
+		FVector WheelOffset = WheelSetup.WheelBoneOffset + WheelSetup.VisualOffset;
+		if (WheelSetup.bAnimateBoneOffset)
+		{
+			WheelOffset.Z += WheelSetup.Length - WheelsState.RenderVisualLength[WheelIndex];
+		}
+
+		State.WheelOffset[WheelIndex] = WheelOffset;
+		State.RotationAngle[WheelIndex] = WheelsState.RotationAngle[WheelIndex];
+		State.SteeringAngle[WheelIndex] = WheelsState.SteeringAngle[WheelIndex];
+		State.bAnimateRotation[WheelIndex] = WheelSetup.bAnimateBoneRotation;
+	}
+
+	State.EngineRPM = EngineRPM;
+	State.LeftTrackSpeed = LeftTrack.LinearSpeed;
+	State.RightTrackSpeed = RightTrack.LinearSpeed;
+	State.Time = GetWorld() ? GetWorld()->GetTimeSeconds() : 0.f;
+	State.bSleeping = bIsSleeping;
+
+	PublishedState.Write(State);
+}
+
+void UPrvVehicleMovementComponent::RecordTelemetry(float DeltaTime)
+{
+	if (!FleetManager.IsValid())
+	{
+		return;
+	}
+
+	FPrvTelemetryRecord Record;
+	Record.VehicleId = TelemetryVehicleId;
+	Record.Frame = (uint32)GFrameCounter;
+	Record.Time = GetWorld()->GetTimeSeconds();
+	Record.DeltaTime = DeltaTime;
+
+	Record.RawThrottleInput = RawThrottleInput;
+	Record.RawSteeringInput = RawSteeringInput;
+	Record.QuantizeInput = QuantizeInput;
+	Record.bRawHandbrakeInput = bRawHandbrakeInput ? 1 : 0;
+
+	Record.CurrentGear = CurrentGear;
+	Record.EngineRPM = EngineRPM;
+	Record.LeftTrackSpeed = LeftTrack.LinearSpeed;
+	Record.RightTrackSpeed = RightTrack.LinearSpeed;
+	Record.LeftBrakeRatio = LeftTrack.BrakeRatio;
+	Record.RightBrakeRatio = RightTrack.BrakeRatio;
+
+	const int32 NumWheels = FMath::Min<int32>(WheelsState.Num(), FPrvTelemetryRecord::MaxWheels);
+	Record.NumWheels = (uint8)NumWheels;
+
+	for (int32 WheelIndex = 0; WheelIndex < NumWheels; ++WheelIndex)
+	{
+		Record.WheelLength[WheelIndex] = WheelsState.PreviousLength[WheelIndex];
+		Record.WheelLoad[WheelIndex] = WheelsState.WheelLoad[WheelIndex];
+
+		if (WheelsState.WheelTouchedGround[WheelIndex])
+		{
+			Record.WheelContactMask |= (1u << WheelIndex);
+		}
+	}
+
+	FleetManager->RecordTelemetry(Record);
+}
+
 float UPrvVehicleMovementComponent::GetEngineRotationSpeed() const
 {
 	return EngineRPM;
@@ -2282,6 +4288,17 @@ float UPrvVehicleMovementComponent::GetAngularVelocityRight() const
 	return RightTrack.AngularSpeed;
 }
 
+float UPrvVehicleMovementComponent::GetContactCacheHitRate() const
+{
+	const uint32 ContactsNum = ContactCacheHits + ContactCacheMisses;
+	return (ContactsNum > 0) ? (float)ContactCacheHits / ContactsNum : 0.f;
+}
+
+float UPrvVehicleMovementComponent::GetTraceBudgetStarvedRate() const
+{
+	return (TraceBudgetFrames > 0) ? (float)TraceBudgetStarvedFrames / TraceBudgetFrames : 0.f;
+}
+
 float UPrvVehicleMovementComponent::GetBrakeRatioLeft() const
 {
 	return LeftTrack.BrakeRatio;
@@ -2350,7 +4367,37 @@ FGearInfo UPrvVehicleMovementComponent::GetCurrentGearInfo() const
 
 void UPrvVehicleMovementComponent::GetSuspensionData(TArray<FSuspensionState>& OutSuspensionData) const
 {
-	OutSuspensionData = SuspensionData;
+	OutSuspensionData.Reset(WheelsState.Num());
+
+	for (int32 WheelIndex = 0; WheelIndex < WheelsState.Num(); ++WheelIndex)
+	{
+		OutSuspensionData.Add(GetSuspensionState(WheelIndex));
+	}
+}
+
+FSuspensionState UPrvVehicleMovementComponent::GetSuspensionState(int32 WheelIndex) const
+{
+	FSuspensionState SuspState;
+
+	if (WheelsState.IsValidIndex(WheelIndex))
+	{
+		SuspState.SuspensionInfo = SuspensionSetup[WheelIndex];
+		SuspState.SuspensionInfo.Rotation = WheelsState.Rotation[WheelIndex];
+		SuspState.PreviousLength = WheelsState.PreviousLength[WheelIndex];
+		SuspState.VisualLength = WheelsState.RenderVisualLength[WheelIndex];
+		SuspState.RotationAngle = WheelsState.RotationAngle[WheelIndex];
+		SuspState.SteeringAngle = WheelsState.SteeringAngle[WheelIndex];
+		SuspState.SuspensionForce = WheelsState.SuspensionForce[WheelIndex];
+		SuspState.WheelCollisionLocation = WheelsState.WheelCollisionLocation[WheelIndex];
+		SuspState.WheelCollisionNormal = WheelsState.WheelCollisionNormal[WheelIndex];
+		SuspState.PreviousWheelCollisionVelocity = WheelsState.PreviousWheelCollisionVelocity[WheelIndex];
+		SuspState.WheelLoad = WheelsState.WheelLoad[WheelIndex];
+		SuspState.WheelTouchedGround = WheelsState.WheelTouchedGround[WheelIndex];
+		SuspState.SurfaceType = WheelsState.SurfaceType[WheelIndex];
+		SuspState.DustPSC = WheelDustComponents.IsValidIndex(WheelIndex) ? WheelDustComponents[WheelIndex] : nullptr;
+	}
+
+	return SuspState;
 }
 
 
@@ -2361,87 +4408,102 @@ void UPrvVehicleMovementComponent::UpdateWheelEffects(float DeltaTime)
 {
 	PRV_CYCLE_COUNTER(STAT_PrvMovementUpdateWheelEffects);
 
+	// Pooled effects belong to fleet manager, so owner-only visibility is decided for the vehicle
+	const APawn* PawnOwner = Cast<APawn>(GetOwner());
+	if ((GPrvVehicleShowDustEffectForOwnerOnly != 0) && !(PawnOwner && PawnOwner->IsLocallyControlled()))
+	{
+		for (UParticleSystemComponent*& DustPSC : WheelDustComponents)
+		{
+			if (DustPSC)
+			{
+				ReleaseWheelEffect(DustPSC);
+				DustPSC = nullptr;
+			}
+		}
+
+		return;
+	}
+
 	if ((GPrvVehicleShowDustEffect != 0) && DustEffect && UpdatedMesh && UpdatedMesh->IsValidLowLevel())
 	{
 		const float CurrentSpeed = UpdatedMesh->GetComponentVelocity().Size();
-		const FRotator MeshRotation = UpdatedMesh->GetComponentRotation();
+		const FTransform MeshTransform = UpdatedMesh->GetComponentTransform();
 
 		// Process suspension
-		for (auto& SuspState : SuspensionData)
+		for (int32 WheelIndex = 0; WheelIndex < WheelsState.Num(); ++WheelIndex)
 		{
-			if (SuspState.SuspensionInfo.bSpawnDust)
+			if (SuspensionSetup[WheelIndex].bSpawnDust)
 			{
+				UParticleSystemComponent*& DustPSC = WheelDustComponents[WheelIndex];
+
 				auto SurfaceType = ForceSurfaceType;
 				if (SurfaceType == EPhysicalSurface::SurfaceType_Default)
 				{
-					SurfaceType = SuspState.SurfaceType;
+					SurfaceType = WheelsState.SurfaceType[WheelIndex];
 				}
 
 				// Get vfx corresponding the surface
 				UParticleSystem* WheelFX = DustEffect->GetDustFX(SurfaceType, CurrentSpeed);
 
 				// Check current one is active
-				const bool bIsVfxActive = SuspState.DustPSC != nullptr && !SuspState.DustPSC->bWasDeactivated && !SuspState.DustPSC->bWasCompleted;
+				const bool bIsVfxActive = DustPSC != nullptr && !DustPSC->bWasDeactivated && !DustPSC->bWasCompleted;
+				bool bActivateVfx = false;
 
 				// Check wheel is touched ground (don't spawn effect if wheels are not animated)
-				if (SuspState.WheelTouchedGround && bShouldAnimateWheels)
+				if (WheelsState.WheelTouchedGround[WheelIndex] && bShouldAnimateWheels)
 				{
-					UParticleSystem* CurrentFX = SuspState.DustPSC != nullptr ? SuspState.DustPSC->Template : nullptr;
+					UParticleSystem* CurrentFX = DustPSC != nullptr ? DustPSC->Template : nullptr;
 
 					// Check we need to spawn dust or change the effect
 					if (WheelFX != nullptr && (CurrentFX != WheelFX || !bIsVfxActive))
 					{
-						if (SuspState.DustPSC == nullptr || !SuspState.DustPSC->bWasDeactivated)
-						{
-							if (SuspState.DustPSC != nullptr)
-							{
-								SuspState.DustPSC->SetActive(false);
-								SuspState.DustPSC->bAutoDestroy = true;
-							}
-
-							SuspState.DustPSC = SpawnNewWheelEffect();
-						}
-
-						// Update effect location
-						if (bUseMeshRotationForEffect)
-						{
-							SuspState.DustPSC->SetWorldRotation(MeshRotation);
-						}
-						else
+						if (DustPSC == nullptr || !DustPSC->bWasDeactivated)
 						{
-							SuspState.DustPSC->SetRelativeRotation(SuspState.WheelCollisionNormal.Rotation());
+							ReleaseWheelEffect(DustPSC);
+							DustPSC = AcquireWheelEffect(WheelFX);
 						}
 
-						SuspState.DustPSC->SetWorldLocation(SuspState.WheelCollisionLocation);
-
-						// Reactivate effect
-						SuspState.DustPSC->SetTemplate(WheelFX);
-						SuspState.DustPSC->ActivateSystem();
-						SuspState.DustPSC->SetOnlyOwnerSee(GPrvVehicleShowDustEffectForOwnerOnly != 0);
+						bActivateVfx = true;
 					}
 					// Deactivate if no suitable VFX is found for surface type
 					else if (WheelFX == nullptr && bIsVfxActive)
 					{
-						SuspState.DustPSC->SetActive(false);
+						DustPSC->SetActive(false);
 					}
 				}
 				// Deactivate particles on ground untouch
 				else if (bIsVfxActive)
 				{
-					SuspState.DustPSC->SetActive(false);
+					DustPSC->SetActive(false);
 				}
 
-				// Update effect location
-				if (bUseMeshRotationForEffect)
+				// Inactive effects are left where they are
+				if (DustPSC == nullptr || !(bActivateVfx || DustPSC->IsActive()))
 				{
-					SuspState.DustPSC->SetWorldRotation(MeshRotation);
+					continue;
 				}
-				else
+
+				// Effect is attached to the mesh, so it's moved only when the contact shifts relative to the body.
+				// Location and rotation are set by one call to update component transform once
+				const FVector NewLocation = MeshTransform.InverseTransformPosition(WheelsState.WheelCollisionLocation[WheelIndex]);
+				const FRotator NewRotation = bUseMeshRotationForEffect ? FRotator::ZeroRotator : WheelsState.WheelCollisionNormal[WheelIndex].Rotation();
+
+				if (bActivateVfx ||
+					!DustPSC->RelativeLocation.Equals(NewLocation, GPrvVehicleDustEffectLocationTolerance) ||
+					!DustPSC->RelativeRotation.Equals(NewRotation, GPrvVehicleDustEffectRotationTolerance))
 				{
-					SuspState.DustPSC->SetRelativeRotation(SuspState.WheelCollisionNormal.Rotation());
+					DustPSC->SetRelativeLocationAndRotation(NewLocation, NewRotation);
 				}
 
-				SuspState.DustPSC->SetWorldLocation(SuspState.WheelCollisionLocation);
+				// Reactivate effect (recycled one can have the template already)
+				if (bActivateVfx)
+				{
+					if (DustPSC->Template != WheelFX)
+					{
+						DustPSC->SetTemplate(WheelFX);
+					}
+					DustPSC->ActivateSystem();
+				}
 			}
 		}
 	}
@@ -2459,6 +4521,47 @@ UParticleSystemComponent* UPrvVehicleMovementComponent::SpawnNewWheelEffect(FNam
 	return DustPSC;
 }
 
+APrvVehicleFleetManager* UPrvVehicleMovementComponent::GetWheelEffectPool() const
+{
+	// Don't spawn manager while the world is torn down
+	if (!GetDefault<UPrvVehicleSettings>()->bPoolWheelEffects || !GetWorld() || GetWorld()->bIsTearingDown)
+	{
+		return nullptr;
+	}
+
+	return FleetManager.IsValid() ? FleetManager.Get() : APrvVehicleFleetManager::Get(GetWorld());
+}
+
+UParticleSystemComponent* UPrvVehicleMovementComponent::AcquireWheelEffect(UParticleSystem* Template)
+{
+	APrvVehicleFleetManager* Pool = GetWheelEffectPool();
+	if (Pool == nullptr)
+	{
+		return SpawnNewWheelEffect();
+	}
+
+	return Pool->AcquireWheelEffect(Template, UpdatedMesh, NAME_None, FVector::ZeroVector);
+}
+
+void UPrvVehicleMovementComponent::ReleaseWheelEffect(UParticleSystemComponent* Effect)
+{
+	if (Effect == nullptr)
+	{
+		return;
+	}
+
+	// Pooled effect is owned by the pool it was taken from
+	APrvVehicleFleetManager* Pool = Cast<APrvVehicleFleetManager>(Effect->GetOwner());
+	if (Pool == nullptr)
+	{
+		Effect->SetActive(false);
+		Effect->bAutoDestroy = true;
+		return;
+	}
+
+	Pool->ReleaseWheelEffect(Effect);
+}
+
 
 //////////////////////////////////////////////////////////////////////////
 // Debug
@@ -2499,6 +4602,41 @@ bool UPrvVehicleMovementComponent::ShouldAddForce()
 	return bPhysicsIsSimulated && ((OwnerRole == ROLE_Authority) || (OwnerRole == ROLE_AutonomousProxy && !bFakeAutonomousProxy));
 }
 
+int32 UPrvVehicleMovementComponent::GetSuspensionTraceCost() const
+{
+	// Fixed timestep substeps reuse the grant, so one trace per wheel is counted
+	if (!UpdatedMesh || !IsActive() || UseReplicatedWheels() || (!bShouldAnimateWheels && GetOwnerRole() == ROLE_SimulatedProxy))
+	{
+		return 0;
+	}
+
+	// Sleeping vehicles skip suspension till they get input
+	if (bIsSleeping && !HasInput())
+	{
+		return 0;
+	}
+
+	switch (WheelLod)
+	{
+	case EPrvWheelLod::Frozen:
+		return 0;
+
+	case EPrvWheelLod::Interleaved:
+		// Frame counter is advanced by the suspension update that follows
+		if ((WheelLodFrameCounter + 1) % FMath::Max(1, GetDefault<UPrvVehicleSettings>()->InterleavedTraceInterval) != 0)
+		{
+			return 0;
+		}
+		break;
+
+	default:
+		break;
+	}
+
+	// Wheels served by contact cache or landscape sampling last frame are expected to stay untraced
+	return FMath::Max(WheelsState.Num() - UntracedWheels, 0);
+}
+
 bool UPrvVehicleMovementComponent::UseLineTrace()
 {
 	ENetRole OwnerRole = GetOwner()->Role;
@@ -2546,6 +4684,9 @@ void UPrvVehicleMovementComponent::GetLifetimeReplicatedProps(TArray< FLifetimeP
 	DOREPLIFETIME(UPrvVehicleMovementComponent, bIsSleeping);
 	DOREPLIFETIME(UPrvVehicleMovementComponent, bIsMovementEnabled);
 
+	// Wheels replication is enabled per vehicle in PreReplication
+	DOREPLIFETIME_CONDITION(UPrvVehicleMovementComponent, ReplicatedWheels, COND_SimulatedOnly);
+
 	if (bFakeAutonomousProxy)
 	{
 		DOREPLIFETIME(UPrvVehicleMovementComponent, EngineRPM);
@@ -2563,3 +4704,10 @@ void UPrvVehicleMovementComponent::GetLifetimeReplicatedProps(TArray< FLifetimeP
 		DOREPLIFETIME_CONDITION(UPrvVehicleMovementComponent, RightTrackEffectiveAngularSpeed, COND_SimulatedOnly);
 	}
 }
+
+void UPrvVehicleMovementComponent::PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker)
+{
+	Super::PreReplication(ChangedPropertyTracker);
+
+	DOREPLIFETIME_ACTIVE_OVERRIDE(UPrvVehicleMovementComponent, ReplicatedWheels, bReplicateWheelState);
+}
@@ -0,0 +1,29 @@
+// Copyright 2016 Pushkin Studio. All Rights Reserved.
+
+#include "PrvPlugin.h"
+
+UPrvVehicleSettings::UPrvVehicleSettings(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	CategoryName = TEXT("Plugins");
+	SectionName = TEXT("PsRealVehicle");
+
+	bEnableWheelSignificance = false;
+
+	MaxFullTierVehicles = 4;
+	MaxLineTraceTierVehicles = 8;
+	MaxInterleavedTierVehicles = 16;
+
+	FullTierMaxDistance = 5000.f;
+	LineTraceTierMaxDistance = 15000.f;
+	InterleavedTierMaxDistance = 30000.f;
+
+	InterleavedTraceInterval = 4;
+
+	NotRenderedSignificanceScale = 0.1f;
+	RecentlyRenderedTolerance = 0.2f;
+
+	bPoolWheelEffects = true;
+	WheelEffectPoolSize = 64;
+	WheelEffectPoolPrewarm = 16;
+}
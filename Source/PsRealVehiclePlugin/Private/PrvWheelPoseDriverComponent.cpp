@@ -0,0 +1,382 @@
+// Copyright 2016 Pushkin Studio. All Rights Reserved.
+
+#include "PrvPlugin.h"
+
+#include "Classes/PrvVehicle.h"
+#include "Classes/PrvVehicleMovementComponent.h"
+
+#include "Animation/AnimInstance.h"
+#include "Containers/Ticker.h"
+#include "RenderCore.h"
+
+DECLARE_CYCLE_STAT(TEXT("Update Wheel Pose"), STAT_PrvUpdateWheelPose, STATGROUP_MovementPhysics);
+
+UPrvWheelPoseDriverComponent::UPrvWheelPoseDriverComponent(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = true;
+
+	// Wheels state and mesh reference pose are ready (both are ticked pre physics, vehicles can be ticked by fleet manager too)
+	PrimaryComponentTick.TickGroup = TG_PostPhysics;
+
+	bSkipWhenNotRendered = true;
+
+	VehicleMovement = nullptr;
+	Mesh = nullptr;
+}
+
+void UPrvWheelPoseDriverComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Nothing to show on dedicated server
+	if (IsRunningDedicatedServer())
+	{
+		SetComponentTickEnabled(false);
+		return;
+	}
+
+	InitWheelBones();
+}
+
+void UPrvWheelPoseDriverComponent::InitWheelBones()
+{
+	WheelBones.Reset();
+
+	APrvVehicle* Vehicle = Cast<APrvVehicle>(GetOwner());
+	VehicleMovement = Vehicle ? Vehicle->GetVehicleMovementComponent() : nullptr;
+	Mesh = Vehicle ? Vehicle->GetMesh() : nullptr;
+
+	if (!VehicleMovement || !Mesh || !Mesh->SkeletalMesh)
+	{
+		UE_LOG(LogPrvVehicle, Warning, TEXT("%s: wheel pose driver requires PrvVehicle with skeletal mesh"), *GetPathName());
+		return;
+	}
+
+	if (Mesh->GetAnimInstance())
+	{
+		UE_LOG(LogPrvVehicle, Warning, TEXT("%s: mesh has anim instance, wheel pose driver overrides its wheel bones"), *GetPathName());
+	}
+
+	// Driver writes the bones in place after mesh update
+	Mesh->SetComponentSpaceTransformsDoubleBuffering(false);
+
+	const FReferenceSkeleton& RefSkeleton = Mesh->SkeletalMesh->RefSkeleton;
+	const TArray<FTransform>& RefBonePose = RefSkeleton.GetRefBonePose();
+
+	for (int32 WheelIndex = 0; WheelIndex < VehicleMovement->SuspensionSetup.Num(); ++WheelIndex)
+	{
+		const FSuspensionInfo& WheelSetup = VehicleMovement->SuspensionSetup[WheelIndex];
+
+		FWheelBones Wheel;
+		Wheel.WheelIndex = WheelIndex;
+		Wheel.WheelBoneIndex = RefSkeleton.FindBoneIndex(WheelSetup.BoneName);
+		Wheel.SuspBoneIndex = RefSkeleton.FindBoneIndex(WheelSetup.GetSuspensionBoneName());
+
+		if (Wheel.WheelBoneIndex == INDEX_NONE)
+		{
+			continue;
+		}
+
+		// Reference pose is kept in component space, so the pose is written the same way every frame
+		Wheel.WheelRefTransform = FTransform::Identity;
+		for (int32 BoneIndex = Wheel.WheelBoneIndex; BoneIndex != INDEX_NONE; BoneIndex = RefSkeleton.GetParentIndex(BoneIndex))
+		{
+			Wheel.WheelRefTransform = Wheel.WheelRefTransform * RefBonePose[BoneIndex];
+		}
+
+		WheelBones.Add(Wheel);
+	}
+
+	WheelBones.Sort([](const FWheelBones& A, const FWheelBones& B) { return A.WheelBoneIndex < B.WheelBoneIndex; });
+
+	// Vehicle and mesh are updated before
+	AddTickPrerequisiteComponent(VehicleMovement);
+	AddTickPrerequisiteComponent(Mesh);
+}
+
+void UPrvWheelPoseDriverComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction *ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (Mesh && bSkipWhenNotRendered && !Mesh->bRecentlyRendered)
+	{
+		return;
+	}
+
+	UpdateWheelPose();
+}
+
+void UPrvWheelPoseDriverComponent::UpdateWheelPose()
+{
+	PRV_CYCLE_COUNTER(STAT_PrvUpdateWheelPose);
+
+	FPrvVehicleStateSnapshot VehicleState;
+	if (WheelBones.Num() == 0 || !Mesh || !VehicleMovement || !VehicleMovement->GetPublishedState(VehicleState))
+	{
+		return;
+	}
+
+	TArray<FTransform>& ComponentSpaceTransforms = Mesh->GetEditableComponentSpaceTransforms();
+
+	for (const FWheelBones& Wheel : WheelBones)
+	{
+		if (Wheel.WheelIndex >= VehicleState.NumWheels || Wheel.WheelBoneIndex >= ComponentSpaceTransforms.Num())
+		{
+			continue;
+		}
+
+		// Same as FAnimNode_PrvWheelHandler: offset first, then rotation
+		FTransform NewBoneTM = Wheel.WheelRefTransform;
+		NewBoneTM.AddToTranslation(VehicleState.WheelOffset[Wheel.WheelIndex]);
+
+		if (Wheel.SuspBoneIndex != INDEX_NONE && Wheel.SuspBoneIndex < ComponentSpaceTransforms.Num())
+		{
+			ComponentSpaceTransforms[Wheel.SuspBoneIndex] = NewBoneTM;
+		}
+
+		if (VehicleState.bAnimateRotation[Wheel.WheelIndex])
+		{
+			const FRotator RotOffset(VehicleState.RotationAngle[Wheel.WheelIndex] + Wheel.WheelIndex * 250.f, VehicleState.SteeringAngle[Wheel.WheelIndex], 0.f);
+			NewBoneTM.SetRotation(FQuat(RotOffset) * NewBoneTM.GetRotation());
+		}
+
+		ComponentSpaceTransforms[Wheel.WheelBoneIndex] = NewBoneTM;
+	}
+
+	// Send new bones to render thread and move attached components
+	Mesh->MarkRenderDynamicDataDirty();
+	Mesh->UpdateChildTransforms();
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Benchmark
+
+/**
+ * Spawns N copies of an anim blueprint vehicle in front of the camera and measures real frames (game and render thread)
+ * with no wheel animation, with anim blueprint and with pose driver, so skinning, render data updates and
+ * recently rendered gating are all included
+ */
+class FPrvWheelPoseBenchmark
+{
+public:
+	enum class EPhase : uint8
+	{
+		Baseline,
+		AnimBlueprint,
+		PoseDriver,
+		Num
+	};
+
+	FPrvWheelPoseBenchmark(UWorld* InWorld, int32 InFrames)
+		: World(InWorld)
+		, Frames(InFrames)
+		, Phase(EPhase::Baseline)
+		, PhaseFrame(0)
+		, LastFrameTime(0.0)
+	{
+		FMemory::Memzero(FrameTime);
+		FMemory::Memzero(GameThreadTime);
+		FMemory::Memzero(RenderThreadTime);
+	}
+
+	~FPrvWheelPoseBenchmark()
+	{
+		if (TickerHandle.IsValid())
+		{
+			FTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+		}
+	}
+
+	bool Start(int32 NumVehicles)
+	{
+		// Anim blueprint vehicle is used as template
+		APrvVehicle* Template = nullptr;
+		for (TObjectIterator<APrvVehicle> It; It && !Template; ++It)
+		{
+			if (It->GetWorld() == World.Get() && !It->IsTemplate() && It->GetMesh() && It->GetMesh()->GetAnimInstance())
+			{
+				Template = *It;
+			}
+		}
+
+		if (!Template)
+		{
+			UE_LOG(LogPrvVehicle, Warning, TEXT("Wheel pose benchmark: no vehicle with anim blueprint in the world"));
+			return false;
+		}
+
+		AnimClass = Template->GetMesh()->GetAnimInstance()->GetClass();
+
+		FVector ViewLocation = Template->GetActorLocation();
+		FRotator ViewRotation = FRotator::ZeroRotator;
+		if (APlayerController* PC = World->GetFirstPlayerController())
+		{
+			PC->GetPlayerViewPoint(ViewLocation, ViewRotation);
+		}
+		ViewRotation.Pitch = 0.f;
+		ViewRotation.Roll = 0.f;
+
+		// Grid in front of the camera, so vehicles are rendered
+		const float Spacing = FMath::Max(Template->GetComponentsBoundingBox().GetSize().Size2D(), 100.f);
+		const int32 Columns = FMath::CeilToInt(FMath::Sqrt((float)NumVehicles));
+
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		for (int32 VehicleIndex = 0; VehicleIndex < NumVehicles; ++VehicleIndex)
+		{
+			const FVector Offset((VehicleIndex / Columns + 2) * Spacing, (VehicleIndex % Columns - Columns / 2) * Spacing, 0.f);
+			APrvVehicle* Vehicle = World->SpawnActor<APrvVehicle>(Template->GetClass(), ViewLocation + ViewRotation.RotateVector(Offset), ViewRotation, SpawnParams);
+			if (Vehicle)
+			{
+				Vehicles.Add(Vehicle);
+			}
+		}
+
+		BeginPhase(EPhase::Baseline);
+
+		TickerHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FPrvWheelPoseBenchmark::Tick));
+		UE_LOG(LogPrvVehicle, Log, TEXT("Wheel pose benchmark: spawned %d vehicles of %s, measuring %d frames per phase"), Vehicles.Num(), *Template->GetClass()->GetName(), Frames);
+		return true;
+	}
+
+	bool IsRunning() const
+	{
+		return TickerHandle.IsValid();
+	}
+
+private:
+	/** Configure wheel animation of spawned vehicles for the phase */
+	void BeginPhase(EPhase NewPhase)
+	{
+		Phase = NewPhase;
+		PhaseFrame = 0;
+
+		for (TWeakObjectPtr<APrvVehicle>& Vehicle : Vehicles)
+		{
+			USkeletalMeshComponent* VehicleMesh = Vehicle.IsValid() ? Vehicle->GetMesh() : nullptr;
+			if (!VehicleMesh)
+			{
+				continue;
+			}
+
+			VehicleMesh->SetAnimInstanceClass((Phase == EPhase::AnimBlueprint) ? AnimClass : nullptr);
+
+			if (Phase == EPhase::PoseDriver && !Vehicle->FindComponentByClass<UPrvWheelPoseDriverComponent>())
+			{
+				UPrvWheelPoseDriverComponent* Driver = NewObject<UPrvWheelPoseDriverComponent>(Vehicle.Get());
+				Driver->RegisterComponent();
+				Driver->InitWheelBones();
+			}
+		}
+	}
+
+	bool Tick(float DeltaTime)
+	{
+		if (!World.IsValid())
+		{
+			Finish();
+			return false;
+		}
+
+		// Skip a few frames after phase switch (anim instances init, render state recreation)
+		static const int32 WarmupFrames = 10;
+
+		const double Now = FPlatformTime::Seconds();
+		const int32 PhaseIndex = (int32)Phase;
+		if (PhaseFrame > WarmupFrames)
+		{
+			FrameTime[PhaseIndex] += Now - LastFrameTime;
+			GameThreadTime[PhaseIndex] += FPlatformTime::ToMilliseconds(GGameThreadTime);
+			RenderThreadTime[PhaseIndex] += FPlatformTime::ToMilliseconds(GRenderThreadTime);
+		}
+		LastFrameTime = Now;
+
+		if (++PhaseFrame <= WarmupFrames + Frames)
+		{
+			return true;
+		}
+
+		if (Phase != EPhase::PoseDriver)
+		{
+			BeginPhase((EPhase)(PhaseIndex + 1));
+			return true;
+		}
+
+		Report();
+		Finish();
+		return false;
+	}
+
+	void Report() const
+	{
+		static const TCHAR* PhaseNames[] = { TEXT("no wheel animation"), TEXT("anim blueprint"), TEXT("pose driver") };
+
+		for (int32 PhaseIndex = 0; PhaseIndex < (int32)EPhase::Num; ++PhaseIndex)
+		{
+			const double FrameMs = FrameTime[PhaseIndex] * 1000.0 / Frames;
+			const double GameMs = GameThreadTime[PhaseIndex] / Frames;
+			const double RenderMs = RenderThreadTime[PhaseIndex] / Frames;
+
+			UE_LOG(LogPrvVehicle, Log, TEXT("Wheel pose benchmark (%d vehicles, %s): frame %.3f ms, game thread %.3f ms (%+.3f), render thread %.3f ms (%+.3f)"),
+				Vehicles.Num(), PhaseNames[PhaseIndex], FrameMs, GameMs, GameMs - GameThreadTime[0] / Frames, RenderMs, RenderMs - RenderThreadTime[0] / Frames);
+		}
+	}
+
+	void Finish()
+	{
+		for (TWeakObjectPtr<APrvVehicle>& Vehicle : Vehicles)
+		{
+			if (Vehicle.IsValid())
+			{
+				Vehicle->Destroy();
+			}
+		}
+
+		Vehicles.Reset();
+		TickerHandle.Reset();
+	}
+
+	TWeakObjectPtr<UWorld> World;
+	TArray<TWeakObjectPtr<APrvVehicle>> Vehicles;
+	TSubclassOf<UAnimInstance> AnimClass;
+	FDelegateHandle TickerHandle;
+
+	int32 Frames;
+	EPhase Phase;
+	int32 PhaseFrame;
+	double LastFrameTime;
+
+	/** Accumulated per phase: frame time [sec], thread times [ms] */
+	double FrameTime[(int32)EPhase::Num];
+	double GameThreadTime[(int32)EPhase::Num];
+	double RenderThreadTime[(int32)EPhase::Num];
+};
+
+static TUniquePtr<FPrvWheelPoseBenchmark> GPrvWheelPoseBenchmark;
+
+static void PrvBenchmarkWheelPose(const TArray<FString>& Args, UWorld* World)
+{
+	const int32 NumVehicles = (Args.Num() > 0) ? FMath::Max(1, FCString::Atoi(*Args[0])) : 200;
+	const int32 Frames = (Args.Num() > 1) ? FMath::Max(1, FCString::Atoi(*Args[1])) : 300;
+
+	if (GPrvWheelPoseBenchmark.IsValid() && GPrvWheelPoseBenchmark->IsRunning())
+	{
+		UE_LOG(LogPrvVehicle, Warning, TEXT("Wheel pose benchmark is already running"));
+		return;
+	}
+
+	GPrvWheelPoseBenchmark = MakeUnique<FPrvWheelPoseBenchmark>(World, Frames);
+	if (!GPrvWheelPoseBenchmark->Start(NumVehicles))
+	{
+		GPrvWheelPoseBenchmark.Reset();
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs PrvBenchmarkWheelPoseCommand(
+	TEXT("PrvVehicle.BenchmarkWheelPose"),
+	TEXT("Spawns N copies of anim blueprint vehicle in view and measures frame, game and render thread time without wheel animation, with anim blueprint and with pose driver. Usage: PrvVehicle.BenchmarkWheelPose [NumVehicles] [Frames]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&PrvBenchmarkWheelPose));
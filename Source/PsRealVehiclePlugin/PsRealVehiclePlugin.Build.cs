@@ -20,14 +20,19 @@ namespace UnrealBuildTool.Rules
 					"Core",
 					"CoreUObject",
 					"Engine",
+					"PsRealVehicleCore",
 					// ... add other public dependencies that you statically link with here ...
 				});
 
             PrivateDependencyModuleNames.AddRange(
                 new string[]
 				{
-					"AnimGraphRuntime"
+					"AnimGraphRuntime",
+					"Landscape"
 				});
+
+			// Landscape heightfield is sampled directly
+			AddEngineThirdPartyPrivateStaticDependencies(Target, "PhysX", "APEX");
 		}
 	}
 }
\ No newline at end of file